@@ -1,10 +1,22 @@
 #pragma once
 
+#include "rs-interval/allocator.hpp"
 #include "rs-interval/arithmetic.hpp"
 #include "rs-interval/category-base-class.hpp"
+#include "rs-interval/concurrent-map.hpp"
+#include "rs-interval/counter.hpp"
+#include "rs-interval/flat-map.hpp"
+#include "rs-interval/flat-set.hpp"
+#include "rs-interval/frozen-map.hpp"
+#include "rs-interval/frozen-set.hpp"
 #include "rs-interval/interval-base-class.hpp"
 #include "rs-interval/interval.hpp"
 #include "rs-interval/map.hpp"
+#include "rs-interval/multi-map.hpp"
+#include "rs-interval/persistent-map.hpp"
+#include "rs-interval/persistent-set.hpp"
+#include "rs-interval/segment-tree.hpp"
 #include "rs-interval/set.hpp"
+#include "rs-interval/sharded-set.hpp"
 #include "rs-interval/types.hpp"
 #include "rs-interval/version.hpp"
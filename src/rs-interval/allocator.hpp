@@ -0,0 +1,449 @@
+#pragma once
+
+#include "rs-interval/flat-set.hpp"
+#include "rs-interval/frozen-set.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set-algorithms.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    RS_INTERVAL_ENUM(Fit, unsigned char, 0,
+        first,  // The lowest gap that is large enough
+        best,   // The smallest gap that is large enough, lowest first
+    )
+
+    // Interval allocator
+
+    template <Primitive T>
+    requires Integral<T>
+    class IntervalAllocator {
+
+    public:
+
+        using interval_type = Interval<T>;
+        using value_type = T;
+
+        static constexpr auto category = interval_category<T>;
+
+        IntervalAllocator() = default;
+        explicit IntervalAllocator(const IntervalSet<T>& set) { build(set.begin(), set.end()); }
+        explicit IntervalAllocator(const FlatIntervalSet<T>& set) { build(set.begin(), set.end()); }
+
+        bool empty() const noexcept { return root_ == npos; }
+        std::size_t size() const noexcept { return by_size_.size(); }
+        Interval<T> largest_gap() const;
+        Interval<T> first_fit(std::size_t n) const;
+        Interval<T> best_fit(std::size_t n) const;
+        Interval<T> allocate(std::size_t n, Fit fit = Fit::first);
+        void clear() noexcept;
+        void insert(const interval_type& in);
+        void erase(const interval_type& in);
+        IntervalSet<T> to_set() const;
+
+    private:
+
+        // The gaps are held in a treap ordered by address and heap ordered
+        // by a random priority. Each node records the size of the largest
+        // gap in its subtree, which lets a first fit search descend to the
+        // lowest gap that is large enough without visiting the others. The
+        // size index orders the same gaps by size, for best fit searches.
+        // Nodes released by erasure are reused before the array is grown.
+
+        struct node {
+            Interval<T> key;
+            std::size_t size = 0;
+            std::size_t max = 0;
+            std::uint_fast32_t priority = 0;
+            std::size_t left = npos;
+            std::size_t right = npos;
+        };
+
+        std::vector<node> nodes_;
+        std::vector<std::size_t> unused_;
+        std::set<std::pair<std::size_t, T>> by_size_;
+        std::size_t root_ = npos;
+        std::minstd_rand rng_;
+
+        template <typename ForwardIterator> void build(ForwardIterator i, ForwardIterator j);
+        std::size_t make_node(const Interval<T>& in);
+        void release(std::size_t n);
+        void pull(std::size_t n);
+        std::size_t merge(std::size_t a, std::size_t b);
+        template <typename Predicate> std::pair<std::size_t, std::size_t> split(std::size_t n, Predicate below);
+        std::size_t leftmost(std::size_t n) const noexcept;
+        std::size_t rightmost(std::size_t n) const noexcept;
+        void collect(std::size_t n, std::vector<Interval<T>>& out) const;
+
+        static std::size_t extent(const Interval<T>& in) noexcept;
+
+    };
+
+        template <Primitive T>
+        requires Integral<T>
+        Interval<T> IntervalAllocator<T>::largest_gap() const {
+            return empty() ? Interval<T>() : first_fit(nodes_[root_].max);
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        Interval<T> IntervalAllocator<T>::first_fit(std::size_t n) const {
+
+            if (empty() || nodes_[root_].max < n) {
+                return {};
+            }
+
+            // Every subtree on the way down is known to contain a large
+            // enough gap; prefer the left subtree whenever it has one
+
+            auto k = root_;
+
+            for (;;) {
+                auto& x = nodes_[k];
+                if (x.left != npos && nodes_[x.left].max >= n) {
+                    k = x.left;
+                } else if (x.size >= n) {
+                    return x.key;
+                } else {
+                    k = x.right;
+                }
+            }
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        Interval<T> IntervalAllocator<T>::best_fit(std::size_t n) const {
+
+            auto it = by_size_.lower_bound({n, std::numeric_limits<T>::lowest()});
+
+            if (it == by_size_.end()) {
+                return {};
+            }
+
+            auto k = root_;
+
+            for (;;) {
+                auto& x = nodes_[k];
+                auto m = x.key.match(it->second);
+                if (m == Match::ok) {
+                    return x.key;
+                }
+                k = m == Match::low ? x.left : x.right;
+            }
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        Interval<T> IntervalAllocator<T>::allocate(std::size_t n, Fit fit) {
+
+            if (n == 0) {
+                return {};
+            }
+
+            auto gap = fit == Fit::best ? best_fit(n) : first_fit(n);
+
+            if (gap.empty()) {
+                return {};
+            }
+
+            // The block is taken from the bottom of the gap. The gap holds at
+            // least n values, so the upper end of the block can be found in
+            // unsigned arithmetic without overflow.
+
+            using U = std::make_unsigned_t<T>;
+            auto lo = Detail::inclusive_lower(gap);
+            auto hi = static_cast<T>(static_cast<U>(static_cast<U>(lo) + static_cast<U>(n - 1)));
+            Interval<T> block(lo, hi);
+            erase(block);
+
+            return block;
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        void IntervalAllocator<T>::clear() noexcept {
+            nodes_.clear();
+            unused_.clear();
+            by_size_.clear();
+            root_ = npos;
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        void IntervalAllocator<T>::insert(const interval_type& in) {
+
+            if (in.empty()) {
+                return;
+            }
+
+            // Separate the gaps that touch or overlap the new one, and
+            // replace them with a single node for their envelope
+
+            auto [lower, rest] = split(root_, [&in] (const Interval<T>& x) { return in.order(x) == Order::b_below_a; });
+            auto [middle, upper] = split(rest, [&in] (const Interval<T>& x) { return in.order(x) > Order::a_below_b; });
+            auto add = in;
+
+            if (middle != npos) {
+                add = add.envelope(nodes_[leftmost(middle)].key).envelope(nodes_[rightmost(middle)].key);
+                release(middle);
+            }
+
+            root_ = merge(merge(lower, make_node(add)), upper);
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        void IntervalAllocator<T>::erase(const interval_type& in) {
+
+            if (in.empty()) {
+                return;
+            }
+
+            // Separate the gaps that overlap the erased interval; only the
+            // first and last of them can survive in part. The remainders are
+            // checked against the inclusive bounds first, because an
+            // unbounded gap has no remainder beyond the limits of the type.
+
+            auto [lower, rest] = split(root_, [&in] (const Interval<T>& x) { return in.order(x) >= Order::b_touches_a; });
+            auto [middle, upper] = split(rest, [&in] (const Interval<T>& x) { return in.order(x) > Order::a_touches_b; });
+
+            if (middle != npos) {
+
+                auto& first = nodes_[leftmost(middle)].key;
+                auto& last = nodes_[rightmost(middle)].key;
+                Interval<T> low_part, high_part;
+
+                if (Detail::inclusive_lower(first) < Detail::inclusive_lower(in)) {
+                    low_part = Detail::lower_remainder(first, in);
+                }
+
+                if (Detail::inclusive_upper(in) < Detail::inclusive_upper(last)) {
+                    high_part = Detail::upper_remainder(last, in);
+                }
+
+                release(middle);
+
+                if (! low_part.empty()) {
+                    lower = merge(lower, make_node(low_part));
+                }
+
+                if (! high_part.empty()) {
+                    upper = merge(make_node(high_part), upper);
+                }
+
+            }
+
+            root_ = merge(lower, upper);
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        IntervalSet<T> IntervalAllocator<T>::to_set() const {
+            std::vector<Interval<T>> gaps;
+            gaps.reserve(size());
+            collect(root_, gaps);
+            return IntervalSet<T>(gaps.begin(), gaps.end());
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        template <typename ForwardIterator>
+        void IntervalAllocator<T>::build(ForwardIterator i, ForwardIterator j) {
+
+            // The set's intervals are already sorted and disjoint, so the
+            // treap can be built in linear time, using the right spine as a
+            // stack
+
+            std::vector<std::size_t> spine;
+
+            for (; i != j; ++i) {
+
+                auto n = make_node(*i);
+                auto last = npos;
+
+                while (! spine.empty() && nodes_[spine.back()].priority < nodes_[n].priority) {
+                    last = spine.back();
+                    pull(last);
+                    spine.pop_back();
+                }
+
+                nodes_[n].left = last;
+
+                if (! spine.empty()) {
+                    nodes_[spine.back()].right = n;
+                }
+
+                spine.push_back(n);
+
+            }
+
+            for (auto k = spine.rbegin(); k != spine.rend(); ++k) {
+                pull(*k);
+            }
+
+            root_ = spine.empty() ? npos : spine.front();
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        std::size_t IntervalAllocator<T>::make_node(const Interval<T>& in) {
+
+            std::size_t n;
+
+            if (unused_.empty()) {
+                n = nodes_.size();
+                nodes_.emplace_back();
+            } else {
+                n = unused_.back();
+                unused_.pop_back();
+            }
+
+            auto& x = nodes_[n];
+            x.key = in;
+            x.size = x.max = extent(in);
+            x.priority = rng_();
+            x.left = x.right = npos;
+            by_size_.insert({x.size, Detail::inclusive_lower(in)});
+
+            return n;
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        void IntervalAllocator<T>::release(std::size_t n) {
+            if (n != npos) {
+                auto& x = nodes_[n];
+                release(x.left);
+                release(x.right);
+                by_size_.erase({x.size, Detail::inclusive_lower(x.key)});
+                unused_.push_back(n);
+            }
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        void IntervalAllocator<T>::pull(std::size_t n) {
+            auto& x = nodes_[n];
+            x.max = x.size;
+            for (auto c: {x.left, x.right}) {
+                if (c != npos) {
+                    x.max = std::max(x.max, nodes_[c].max);
+                }
+            }
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        std::size_t IntervalAllocator<T>::merge(std::size_t a, std::size_t b) {
+
+            // Every gap in the first tree lies below every gap in the second
+
+            if (a == npos) {
+                return b;
+            } else if (b == npos) {
+                return a;
+            } else if (nodes_[a].priority > nodes_[b].priority) {
+                nodes_[a].right = merge(nodes_[a].right, b);
+                pull(a);
+                return a;
+            } else {
+                nodes_[b].left = merge(a, nodes_[b].left);
+                pull(b);
+                return b;
+            }
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        template <typename Predicate>
+        std::pair<std::size_t, std::size_t> IntervalAllocator<T>::split(std::size_t n, Predicate below) {
+
+            // Split into the gaps for which the predicate is true and the
+            // rest; the predicate must be true for a prefix of the gaps
+
+            if (n == npos) {
+                return {npos, npos};
+            }
+
+            if (below(nodes_[n].key)) {
+                auto [l, r] = split(nodes_[n].right, below);
+                nodes_[n].right = l;
+                pull(n);
+                return {n, r};
+            } else {
+                auto [l, r] = split(nodes_[n].left, below);
+                nodes_[n].left = r;
+                pull(n);
+                return {l, n};
+            }
+
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        std::size_t IntervalAllocator<T>::leftmost(std::size_t n) const noexcept {
+            while (nodes_[n].left != npos) {
+                n = nodes_[n].left;
+            }
+            return n;
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        std::size_t IntervalAllocator<T>::rightmost(std::size_t n) const noexcept {
+            while (nodes_[n].right != npos) {
+                n = nodes_[n].right;
+            }
+            return n;
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        void IntervalAllocator<T>::collect(std::size_t n, std::vector<Interval<T>>& out) const {
+            if (n != npos) {
+                collect(nodes_[n].left, out);
+                out.push_back(nodes_[n].key);
+                collect(nodes_[n].right, out);
+            }
+        }
+
+        template <Primitive T>
+        requires Integral<T>
+        std::size_t IntervalAllocator<T>::extent(const Interval<T>& in) noexcept {
+
+            // The number of values in the gap, with unbounded ends taken as
+            // the limits of the type; this saturates at npos if the gap
+            // covers every value of a type as wide as std::size_t
+
+            if (in.empty()) {
+                return 0;
+            }
+
+            using U = std::make_unsigned_t<T>;
+            auto lo = static_cast<U>(Detail::inclusive_lower(in));
+            auto hi = static_cast<U>(Detail::inclusive_upper(in));
+            auto d = static_cast<std::size_t>(static_cast<U>(hi - lo));
+
+            return d == npos ? npos : d + 1;
+
+        }
+
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "rs-interval/flat-map.hpp"
+#include "rs-interval/frozen-map.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/types.hpp"
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Snapshots use the frozen map where the key type allows it
+
+        template <IntervalCompatible K, std::regular T>
+        struct ConcurrentSnapshot {
+            using type = FlatIntervalMap<K, T>;
+        };
+
+        template <Primitive K, std::regular T>
+        struct ConcurrentSnapshot<K, T> {
+            using type = FrozenIntervalMap<K, T>;
+        };
+
+    }
+
+    // Concurrent interval map
+
+    template <IntervalCompatible K, std::regular T>
+    class ConcurrentIntervalMap {
+
+    public:
+
+        class reader;
+
+        using key_type = K;
+        using mapped_type = T;
+        using interval_type = Interval<K>;
+        using value_type = std::pair<Interval<K>, T>;
+        using snapshot_type = typename Detail::ConcurrentSnapshot<K, T>::type;
+
+        static constexpr auto category = interval_category<K>;
+
+        ConcurrentIntervalMap(): ConcurrentIntervalMap(IntervalMap<K, T>()) {}
+        explicit ConcurrentIntervalMap(const T& defval): ConcurrentIntervalMap(IntervalMap<K, T>(defval)) {}
+        explicit ConcurrentIntervalMap(const IntervalMap<K, T>& map);
+        ConcurrentIntervalMap(const ConcurrentIntervalMap&) = delete;
+        ConcurrentIntervalMap(ConcurrentIntervalMap&&) = delete;
+        ~ConcurrentIntervalMap() = default;
+        ConcurrentIntervalMap& operator=(const ConcurrentIntervalMap&) = delete;
+        ConcurrentIntervalMap& operator=(ConcurrentIntervalMap&&) = delete;
+
+        // These load the shared snapshot pointer on every call, which
+        // touches its reference count; use a reader for repeated lookups
+        // from many threads
+
+        T operator[](const K& key) const { return (*snapshot())[key]; }
+
+        bool contains(const K& key) const { return snapshot()->contains(key); }
+        std::optional<value_type> find(const K& key) const { return find_in(*snapshot(), key); }
+        std::shared_ptr<const snapshot_type> snapshot() const { return current_.load(std::memory_order_acquire); }
+        std::uint64_t version() const noexcept { return version_.load(std::memory_order_acquire); }
+        void insert(const interval_type& in, const T& t);
+        void erase(const interval_type& in);
+        void publish();
+        template <std::invocable<IntervalMap<K, T>&> F> void update(F f);
+
+    private:
+
+        // Readers only ever load the current snapshot, which is immutable.
+        // Writers serialize on the mutex, apply their changes to the master
+        // copy, and publish a new snapshot by replacing the pointer. The
+        // version number changes after every publication, so that a reader
+        // holding a snapshot can tell whether it is still current without
+        // touching the shared pointer's reference count.
+
+        std::atomic<std::shared_ptr<const snapshot_type>> current_;
+        std::atomic<std::uint64_t> version_ = 0;
+        std::mutex mutex_;
+        IntervalMap<K, T> master_;
+
+        void do_publish();
+
+        static std::optional<value_type> find_in(const snapshot_type& snap, const K& key);
+
+    };
+
+        template <IntervalCompatible K, std::regular T>
+        class ConcurrentIntervalMap<K, T>::reader {
+
+        public:
+
+            explicit reader(const ConcurrentIntervalMap& map): map_(&map) {}
+
+            T operator[](const K& key) { return snapshot()[key]; }
+
+            bool contains(const K& key) { return snapshot().contains(key); }
+            std::optional<value_type> find(const K& key) { return find_in(snapshot(), key); }
+            const snapshot_type& snapshot();
+
+        private:
+
+            const ConcurrentIntervalMap* map_;
+            std::shared_ptr<const snapshot_type> current_;
+            std::uint64_t version_ = 0;
+
+        };
+
+        template <IntervalCompatible K, std::regular T>
+        const typename ConcurrentIntervalMap<K, T>::snapshot_type& ConcurrentIntervalMap<K, T>::reader::snapshot() {
+
+            // The snapshot is reloaded only when a new one has been published,
+            // so a lookup usually reads nothing shared but the version number
+
+            auto v = map_->version();
+
+            if (! current_ || v != version_) {
+                current_ = map_->snapshot();
+                version_ = v;
+            }
+
+            return *current_;
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        ConcurrentIntervalMap<K, T>::ConcurrentIntervalMap(const IntervalMap<K, T>& map): master_(map) {
+            do_publish();
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void ConcurrentIntervalMap<K, T>::insert(const interval_type& in, const T& t) {
+            std::lock_guard lock(mutex_);
+            master_.insert(in, t);
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void ConcurrentIntervalMap<K, T>::erase(const interval_type& in) {
+            std::lock_guard lock(mutex_);
+            master_.erase(in);
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void ConcurrentIntervalMap<K, T>::publish() {
+            std::lock_guard lock(mutex_);
+            do_publish();
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        template <std::invocable<IntervalMap<K, T>&> F>
+        void ConcurrentIntervalMap<K, T>::update(F f) {
+            std::lock_guard lock(mutex_);
+            std::invoke(f, master_);
+            do_publish();
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void ConcurrentIntervalMap<K, T>::do_publish() {
+
+            // The snapshot is stored before the version is advanced, so a
+            // reader that sees the new version also sees the new snapshot
+
+            current_.store(std::make_shared<const snapshot_type>(master_), std::memory_order_release);
+            version_.fetch_add(1, std::memory_order_release);
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::optional<typename ConcurrentIntervalMap<K, T>::value_type>
+        ConcurrentIntervalMap<K, T>::find_in(const snapshot_type& snap, const K& key) {
+
+            // The entry is copied out, because the snapshot may be released
+            // as soon as the caller's reference to it is dropped
+
+            auto it = snap.find(key);
+
+            if (it == snap.end()) {
+                return {};
+            } else {
+                return *it;
+            }
+
+        }
+
+}
@@ -0,0 +1,338 @@
+#pragma once
+
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set-algorithms.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    // Interval counter
+
+    template <IntervalCompatible T>
+    class IntervalCounter {
+
+    public:
+
+        using interval_type = Interval<T>;
+        using value_type = T;
+
+        static constexpr auto category = interval_category<T>;
+
+        IntervalCounter() = default;
+
+        std::ptrdiff_t operator[](const T& t) const { return depth(t); }
+
+        bool empty() const noexcept { return root_ == npos; }
+        std::ptrdiff_t depth(const T& t) const;
+        std::ptrdiff_t max_depth(const interval_type& in) const;
+        IntervalSet<T> at_least(std::ptrdiff_t k) const;
+        void add(const interval_type& in) { update(in, 1); }
+        void remove(const interval_type& in) { update(in, -1); }
+        void clear() noexcept;
+
+    private:
+
+        using point = Detail::SweepPoint<T>;
+
+        static constexpr auto no_peak = std::numeric_limits<std::ptrdiff_t>::min();
+
+        // The counter holds the net change in depth at each boundary point
+        // where it is not zero, in a treap ordered by point and heap ordered
+        // by a random priority. Each node records the total change over its
+        // subtree, and the highest depth reached at any point in the
+        // subtree, relative to the depth just before it.
+
+        struct node {
+            point key;
+            std::ptrdiff_t delta = 0;
+            std::ptrdiff_t total = 0;
+            std::ptrdiff_t peak = 0;
+            std::uint_fast32_t priority = 0;
+            std::size_t left = npos;
+            std::size_t right = npos;
+        };
+
+        struct summary {
+            std::ptrdiff_t total = 0;
+            std::ptrdiff_t peak = no_peak;
+            void append(std::ptrdiff_t t, std::ptrdiff_t p);
+        };
+
+        std::vector<node> nodes_;
+        std::vector<std::size_t> unused_;
+        std::size_t root_ = npos;
+        std::minstd_rand rng_;
+
+        void update(const interval_type& in, std::ptrdiff_t delta);
+        void adjust(const point& p, std::ptrdiff_t delta);
+        void pull(std::size_t n);
+        std::size_t merge(std::size_t a, std::size_t b);
+        std::pair<std::size_t, std::size_t> split(std::size_t n, const point& p, bool inclusive);
+        std::ptrdiff_t prefix(const point& p) const;
+        void collect(std::size_t n, const point& lo, const point& hi, bool lo_in, bool hi_in, summary& s) const;
+        template <typename F> void walk(std::size_t n, F& f) const;
+
+    };
+
+        template <IntervalCompatible T>
+        std::ptrdiff_t IntervalCounter<T>::depth(const T& t) const {
+            return prefix(Detail::lower_point(interval_type(t)));
+        }
+
+        template <IntervalCompatible T>
+        std::ptrdiff_t IntervalCounter<T>::max_depth(const interval_type& in) const {
+
+            if (in.empty()) {
+                throw std::invalid_argument("Maximum over an empty interval");
+            }
+
+            // The depth at the start of the interval, raised by the highest
+            // point reached at any boundary inside it
+
+            auto lo = Detail::lower_point(in);
+            auto hi = Detail::upper_point(in);
+            summary s;
+            collect(root_, lo, hi, false, false, s);
+
+            return prefix(lo) + std::max(std::ptrdiff_t(0), s.peak);
+
+        }
+
+        template <IntervalCompatible T>
+        IntervalSet<T> IntervalCounter<T>::at_least(std::ptrdiff_t k) const {
+
+            std::vector<Interval<T>> result;
+            std::ptrdiff_t level = 0;
+            point start {{}, -1, false};
+            bool inside = level >= k;
+
+            auto f = [&] (const node& x) {
+                level += x.delta;
+                if (inside != (level >= k)) {
+                    if (inside) {
+                        result.push_back(Detail::interval_between(start, x.key));
+                    } else {
+                        start = x.key;
+                    }
+                    inside = ! inside;
+                }
+            };
+
+            walk(root_, f);
+
+            if (inside) {
+                result.push_back(Detail::interval_between(start, point{{}, 1, false}));
+            }
+
+            return IntervalSet<T>(result.begin(), result.end());
+
+        }
+
+        template <IntervalCompatible T>
+        void IntervalCounter<T>::clear() noexcept {
+            nodes_.clear();
+            unused_.clear();
+            root_ = npos;
+        }
+
+        template <IntervalCompatible T>
+        void IntervalCounter<T>::summary::append(std::ptrdiff_t t, std::ptrdiff_t p) {
+            if (p != no_peak) {
+                peak = std::max(peak, total + p);
+            }
+            total += t;
+        }
+
+        template <IntervalCompatible T>
+        void IntervalCounter<T>::update(const interval_type& in, std::ptrdiff_t delta) {
+            if (! in.empty()) {
+                adjust(Detail::lower_point(in), delta);
+                adjust(Detail::upper_point(in), - delta);
+            }
+        }
+
+        template <IntervalCompatible T>
+        void IntervalCounter<T>::adjust(const point& p, std::ptrdiff_t delta) {
+
+            // Points at infinity never change the depth at any finite
+            // position, so they are not stored
+
+            if (p.rank != 0) {
+                return;
+            }
+
+            auto [lower, rest] = split(root_, p, false);
+            auto [middle, upper] = split(rest, p, true);
+
+            if (middle == npos) {
+
+                if (unused_.empty()) {
+                    middle = nodes_.size();
+                    nodes_.emplace_back();
+                } else {
+                    middle = unused_.back();
+                    unused_.pop_back();
+                }
+
+                auto& x = nodes_[middle];
+                x.key = p;
+                x.delta = delta;
+                x.priority = rng_();
+                x.left = x.right = npos;
+                pull(middle);
+
+            } else {
+
+                nodes_[middle].delta += delta;
+
+                if (nodes_[middle].delta == 0) {
+                    unused_.push_back(middle);
+                    middle = npos;
+                } else {
+                    pull(middle);
+                }
+
+            }
+
+            root_ = merge(merge(lower, middle), upper);
+
+        }
+
+        template <IntervalCompatible T>
+        void IntervalCounter<T>::pull(std::size_t n) {
+
+            auto& x = nodes_[n];
+            summary s;
+
+            if (x.left != npos) {
+                s.append(nodes_[x.left].total, nodes_[x.left].peak);
+            }
+
+            s.append(x.delta, x.delta);
+
+            if (x.right != npos) {
+                s.append(nodes_[x.right].total, nodes_[x.right].peak);
+            }
+
+            x.total = s.total;
+            x.peak = s.peak;
+
+        }
+
+        template <IntervalCompatible T>
+        std::size_t IntervalCounter<T>::merge(std::size_t a, std::size_t b) {
+            if (a == npos) {
+                return b;
+            } else if (b == npos) {
+                return a;
+            } else if (nodes_[a].priority > nodes_[b].priority) {
+                nodes_[a].right = merge(nodes_[a].right, b);
+                pull(a);
+                return a;
+            } else {
+                nodes_[b].left = merge(a, nodes_[b].left);
+                pull(b);
+                return b;
+            }
+        }
+
+        template <IntervalCompatible T>
+        std::pair<std::size_t, std::size_t> IntervalCounter<T>::split(std::size_t n, const point& p, bool inclusive) {
+
+            // Split into the points below p (or not above it, if inclusive)
+            // and the rest
+
+            if (n == npos) {
+                return {npos, npos};
+            }
+
+            auto& key = nodes_[n].key;
+
+            if (inclusive ? ! (p < key) : key < p) {
+                auto [l, r] = split(nodes_[n].right, p, inclusive);
+                nodes_[n].right = l;
+                pull(n);
+                return {n, r};
+            } else {
+                auto [l, r] = split(nodes_[n].left, p, inclusive);
+                nodes_[n].left = r;
+                pull(n);
+                return {l, n};
+            }
+
+        }
+
+        template <IntervalCompatible T>
+        std::ptrdiff_t IntervalCounter<T>::prefix(const point& p) const {
+
+            // The total change at all points not above p
+
+            std::ptrdiff_t sum = 0;
+            auto n = root_;
+
+            while (n != npos) {
+                auto& x = nodes_[n];
+                if (p < x.key) {
+                    n = x.left;
+                } else {
+                    if (x.left != npos) {
+                        sum += nodes_[x.left].total;
+                    }
+                    sum += x.delta;
+                    n = x.right;
+                }
+            }
+
+            return sum;
+
+        }
+
+        template <IntervalCompatible T>
+        void IntervalCounter<T>::collect(std::size_t n, const point& lo, const point& hi,
+                bool lo_in, bool hi_in, summary& s) const {
+
+            // Accumulate the points strictly between lo and hi, in order.
+            // The flags indicate that every point in the subtree is known to
+            // lie above lo, or below hi; only the paths to the two ends are
+            // followed, and every subtree between them is taken whole.
+
+            if (n == npos) {
+                return;
+            }
+
+            auto& x = nodes_[n];
+
+            if (lo_in && hi_in) {
+                s.append(x.total, x.peak);
+            } else if (! (lo < x.key)) {
+                collect(x.right, lo, hi, lo_in, hi_in, s);
+            } else if (! (x.key < hi)) {
+                collect(x.left, lo, hi, lo_in, hi_in, s);
+            } else {
+                collect(x.left, lo, hi, lo_in, true, s);
+                s.append(x.delta, x.delta);
+                collect(x.right, lo, hi, true, hi_in, s);
+            }
+
+        }
+
+        template <IntervalCompatible T>
+        template <typename F>
+        void IntervalCounter<T>::walk(std::size_t n, F& f) const {
+            if (n != npos) {
+                walk(nodes_[n].left, f);
+                f(nodes_[n]);
+                walk(nodes_[n].right, f);
+            }
+        }
+
+}
@@ -0,0 +1,82 @@
+// This header is private to the implementation and should not be included by users
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Prefetch for reading, given a byte offset that may lie beyond the
+        // end of the array (no pointer past the end is formed)
+
+        inline void prefetch_offset([[maybe_unused]] const void* base, [[maybe_unused]] std::size_t offset) noexcept {
+            #if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch(reinterpret_cast<const void*>(reinterpret_cast<std::uintptr_t>(base) + offset));
+            #endif
+        }
+
+        // Eytzinger (breadth first) layout of a sorted array. Slot 0 is
+        // unused; the children of slot k are at 2k and 2k+1. The layout
+        // returned maps each slot to the index of its element in the sorted
+        // order.
+
+        inline std::vector<std::size_t> eytzinger_layout(std::size_t n) {
+
+            std::vector<std::size_t> layout(n + 1, n);
+            std::vector<std::size_t> stack;
+            std::size_t k = 1;
+            std::size_t i = 0;
+
+            // Iterative in-order traversal of the implicit tree
+
+            while (k <= n || ! stack.empty()) {
+                if (k <= n) {
+                    stack.push_back(k);
+                    k *= 2;
+                } else {
+                    k = stack.back();
+                    stack.pop_back();
+                    layout[k] = i++;
+                    k = 2 * k + 1;
+                }
+            }
+
+            return layout;
+
+        }
+
+        // Branchless searches over an array in Eytzinger order, returning the
+        // slot of the first element that is not less than (lower bound) or
+        // greater than (upper bound) the key, or zero if there is none. Each
+        // step prefetches the four grandchildren of the current slot, which
+        // share a cache line, so the memory latency of the search overlaps
+        // with the comparisons two levels above.
+
+        template <typename T>
+        std::size_t eytzinger_lower_bound(const T* e, std::size_t n, T x) noexcept {
+            std::size_t k = 1;
+            while (k <= n) {
+                prefetch_offset(e, 4 * k * sizeof(T));
+                k = 2 * k + static_cast<std::size_t>(e[k] < x);
+            }
+            return k >> (std::countr_one(k) + 1);
+        }
+
+        template <typename T>
+        std::size_t eytzinger_upper_bound(const T* e, std::size_t n, T x) noexcept {
+            std::size_t k = 1;
+            while (k <= n) {
+                prefetch_offset(e, 4 * k * sizeof(T));
+                k = 2 * k + static_cast<std::size_t>(! (x < e[k]));
+            }
+            return k >> (std::countr_one(k) + 1);
+        }
+
+    }
+
+}
@@ -0,0 +1,481 @@
+#pragma once
+
+#include "rs-interval/frozen-map.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/set-algorithms.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <initializer_list>
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Proxy reference to an entry in a flat interval map, pairing
+        // references into the separate interval and value arrays. The value
+        // is held through the vector's const_reference type, which is a
+        // plain bool for std::vector<bool>.
+
+        template <typename K, typename T>
+        struct FlatMapEntry {
+
+            const Interval<K>& first;
+            typename std::vector<T>::const_reference second;
+
+            template <typename K2, typename T2>
+            requires std::constructible_from<K2, const Interval<K>&> && std::constructible_from<T2, const T&>
+            operator std::pair<K2, T2>() const {
+                return {first, second};
+            }
+
+        };
+
+        template <typename Ref>
+        struct ArrowProxy {
+            Ref ref;
+            const Ref* operator->() const noexcept { return &ref; }
+        };
+
+    }
+
+    // Flat interval map
+
+    template <IntervalCompatible K, std::regular T>
+    class FlatIntervalMap {
+
+    public:
+
+        class iterator;
+
+        using key_type = K;
+        using mapped_type = T;
+        using interval_type = Interval<K>;
+        using value_type = std::pair<Interval<K>, T>;
+        using const_reference = typename std::vector<T>::const_reference;
+
+        static constexpr auto category = interval_category<K>;
+
+        FlatIntervalMap() = default;
+        explicit FlatIntervalMap(const T& defval): keys_(), values_(), def_(defval) {}
+        FlatIntervalMap(std::initializer_list<value_type> list): FlatIntervalMap(list.begin(), list.end()) {}
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, value_type>
+        FlatIntervalMap(I first, S last) { assign(first, last); }
+        template <CombinePolicy<T> C>
+        explicit FlatIntervalMap(const IntervalMap<K, T, C>& map): def_(map.default_value()) { copy_map(map); }
+
+        const_reference operator[](const K& key) const;
+
+        iterator begin() const noexcept { return make_iterator(0); }
+        iterator end() const noexcept { return make_iterator(size()); }
+        bool empty() const noexcept { return keys_.empty(); }
+        std::size_t size() const noexcept { return keys_.size(); }
+        const T& default_value() const noexcept { return def_; }
+        void default_value(const T& defval) { def_ = defval; }
+        bool contains(const K& key) const { return do_find(key).second; }
+        iterator find(const K& key) const;
+        iterator lower_bound(const K& key) const { return make_iterator(do_find(key).first); }
+        iterator upper_bound(const K& key) const;
+        std::ranges::subrange<iterator> overlapping(const interval_type& in) const;
+        std::size_t count_overlapping(const interval_type& in) const;
+        iterator nth(std::size_t i) const noexcept { return make_iterator(std::min(i, size())); }
+        std::size_t rank(const K& key) const { return do_find(key).first; }
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, value_type>
+        void assign(I first, S last);
+        void clear() noexcept { keys_.clear(); values_.clear(); }
+        void reset(const T& defval = {}) { def_ = defval; clear(); }
+        void insert(const interval_type& in, const T& t) { do_insert(in, t); }
+        void insert(const interval_type& in, T&& t) { do_insert(in, std::move(t)); }
+        void insert(const value_type& v) { do_insert(v.first, v.second); }
+        void insert(value_type&& v) { do_insert(v.first, std::move(v.second)); }
+        template <typename... Args>
+        requires std::constructible_from<T, Args...>
+        void emplace(const interval_type& in, Args&&... args) { do_insert(in, T(std::forward<Args>(args)...)); }
+        void erase(const interval_type& in);
+        void reserve(std::size_t n) { keys_.reserve(n); values_.reserve(n); }
+        void shrink_to_fit() { keys_.shrink_to_fit(); values_.shrink_to_fit(); }
+        void swap(FlatIntervalMap& map) noexcept { keys_.swap(map.keys_); values_.swap(map.values_); std::swap(def_, map.def_); }
+        auto freeze() const requires Primitive<K> { return FrozenIntervalMap<K, T>(*this); }
+
+    private:
+
+        // The intervals and their values are kept in separate parallel
+        // arrays, so that searches only touch the intervals
+
+        std::vector<Interval<K>> keys_;
+        std::vector<T> values_;
+        T def_ {};
+
+        static auto offset(std::size_t i) noexcept { return static_cast<std::ptrdiff_t>(i); }
+
+        template <typename M> void copy_map(const M& map);
+        std::pair<std::size_t, bool> do_find(const K& key) const;
+        std::pair<std::size_t, std::size_t> do_overlapping(const interval_type& in) const;
+        template <typename U> void do_insert(const interval_type& in, U&& t);
+        void erase_entries(std::size_t i, std::size_t j);
+        template <typename U> void insert_entry(std::size_t i, const interval_type& in, U&& t);
+        iterator make_iterator(std::size_t i) const noexcept;
+
+    };
+
+        template <IntervalCompatible K, std::regular T>
+        class FlatIntervalMap<K, T>::iterator {
+
+        public:
+
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::input_iterator_tag;
+            using iterator_concept = std::random_access_iterator_tag;
+            using pointer = Detail::ArrowProxy<Detail::FlatMapEntry<K, T>>;
+            using reference = Detail::FlatMapEntry<K, T>;
+            using value_type = std::pair<Interval<K>, T>;
+
+            iterator() = default;
+
+            reference operator*() const noexcept { return {*key_, *value_}; }
+            pointer operator->() const noexcept { return {**this}; }
+            reference operator[](difference_type n) const noexcept { return *(*this + n); }
+            iterator& operator++() noexcept { ++key_; ++value_; return *this; }
+            iterator operator++(int) noexcept { auto i = *this; ++*this; return i; }
+            iterator& operator--() noexcept { --key_; --value_; return *this; }
+            iterator operator--(int) noexcept { auto i = *this; --*this; return i; }
+            iterator& operator+=(difference_type n) noexcept { key_ += n; value_ += n; return *this; }
+            iterator& operator-=(difference_type n) noexcept { key_ -= n; value_ -= n; return *this; }
+
+            friend iterator operator+(iterator i, difference_type n) noexcept { return i += n; }
+            friend iterator operator+(difference_type n, iterator i) noexcept { return i += n; }
+            friend iterator operator-(iterator i, difference_type n) noexcept { return i -= n; }
+            friend difference_type operator-(const iterator& i, const iterator& j) noexcept { return i.key_ - j.key_; }
+            friend bool operator==(const iterator& i, const iterator& j) noexcept { return i.key_ == j.key_; }
+            friend auto operator<=>(const iterator& i, const iterator& j) noexcept { return i.key_ <=> j.key_; }
+
+        private:
+
+            friend class FlatIntervalMap;
+
+            using key_iterator = typename std::vector<Interval<K>>::const_iterator;
+            using value_iterator = typename std::vector<T>::const_iterator;
+
+            key_iterator key_ {};
+            value_iterator value_ {};
+
+            iterator(key_iterator key, value_iterator value) noexcept: key_(key), value_(value) {}
+
+        };
+
+        template <IntervalCompatible K, std::regular T>
+        typename FlatIntervalMap<K, T>::const_reference FlatIntervalMap<K, T>::operator[](const K& key) const {
+            auto [i,ok] = do_find(key);
+            return ok ? values_[i] : def_;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        typename FlatIntervalMap<K, T>::iterator FlatIntervalMap<K, T>::find(const K& key) const {
+            auto [i,ok] = do_find(key);
+            return ok ? make_iterator(i) : end();
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        typename FlatIntervalMap<K, T>::iterator FlatIntervalMap<K, T>::upper_bound(const K& key) const {
+            auto [i,ok] = do_find(key);
+            return make_iterator(ok ? i + 1 : i);
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, typename FlatIntervalMap<K, T>::value_type>
+        void FlatIntervalMap<K, T>::assign(I first, S last) {
+
+            auto [list,disjoint] = Detail::collect_entries<K, T>(first, last);
+
+            clear();
+
+            if (disjoint) {
+
+                reserve(list.size());
+
+                for (auto& [in,t]: list) {
+                    keys_.push_back(in);
+                    values_.push_back(std::move(t));
+                }
+
+            } else {
+
+                // Overlapping entries are resolved in a node based map, so
+                // that later entries take precedence without each insertion
+                // having to move the rest of the array
+
+                IntervalMap<K, T> map;
+
+                for (auto& [in,t]: list) {
+                    map.insert(in, std::move(t));
+                }
+
+                list = {};
+                copy_map(map);
+
+            }
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        template <typename U>
+        void FlatIntervalMap<K, T>::do_insert(const interval_type& in, U&& t) {
+
+            if (in.empty()) {
+                return;
+            }
+
+            // [i,j) is the run of segments that touch or overlap the new one
+
+            auto i = static_cast<std::size_t>(std::partition_point(keys_.begin(), keys_.end(),
+                [&in] (const interval_type& x) { return in.order(x) == Order::b_below_a; }) - keys_.begin());
+            auto j = static_cast<std::size_t>(std::partition_point(keys_.begin() + offset(i), keys_.end(),
+                [&in] (const interval_type& x) { return in.order(x) > Order::a_below_b; }) - keys_.begin());
+
+            // Only the first and last segments in the run can extend beyond
+            // the new one. Each is either merged into it, if it has the same
+            // value, or trimmed to the part outside it.
+
+            auto key = in;
+            interval_type lower, upper;
+
+            if (i < j) {
+                if (values_[i] == t) {
+                    key = key.envelope(keys_[i]);
+                } else {
+                    lower = Detail::lower_remainder(keys_[i], in);
+                }
+                if (values_[j - 1] == t) {
+                    key = key.envelope(keys_[j - 1]);
+                } else {
+                    upper = Detail::upper_remainder(keys_[j - 1], in);
+                }
+            }
+
+            // [a,b) is the range of slots that the new segment replaces
+
+            auto a = lower.empty() ? i : i + 1;
+            auto b = upper.empty() ? j : j - 1;
+
+            if (! lower.empty()) {
+                keys_[i] = lower;
+            }
+
+            if (a > b) {
+                // A single segment is split around the new one
+                insert_entry(a, key, std::forward<U>(t));
+                insert_entry(a + 1, upper, values_[i]);
+                return;
+            }
+
+            if (! upper.empty()) {
+                keys_[j - 1] = upper;
+            }
+
+            if (a == b) {
+                insert_entry(a, key, std::forward<U>(t));
+            } else {
+                keys_[a] = key;
+                values_[a] = std::forward<U>(t);
+                erase_entries(a + 1, b);
+            }
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::ranges::subrange<typename FlatIntervalMap<K, T>::iterator>
+        FlatIntervalMap<K, T>::overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return {make_iterator(i), make_iterator(j)};
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t FlatIntervalMap<K, T>::count_overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return j - i;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void FlatIntervalMap<K, T>::erase(const interval_type& in) {
+
+            // [i,j) is the run of segments that overlap the erased interval
+
+            auto [i,j] = do_overlapping(in);
+
+            if (i == j) {
+                return;
+            }
+
+            // Only the first and last segments in the run can survive in part.
+            // They are trimmed in place, and the rest of the run is removed.
+
+            auto lower = Detail::lower_remainder(keys_[i], in);
+            auto upper = Detail::upper_remainder(keys_[j - 1], in);
+
+            if (! lower.empty()) {
+                keys_[i++] = lower;
+            }
+
+            if (! upper.empty()) {
+                if (i == j) {
+                    insert_entry(j, upper, values_[j - 1]);
+                    return;
+                }
+                keys_[--j] = upper;
+            }
+
+            erase_entries(i, j);
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        template <typename M>
+        void FlatIntervalMap<K, T>::copy_map(const M& map) {
+
+            clear();
+            reserve(map.size());
+
+            for (const auto& [in,t]: map) {
+                keys_.push_back(in);
+                values_.push_back(t);
+            }
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::pair<std::size_t, bool> FlatIntervalMap<K, T>::do_find(const K& key) const {
+
+            // Find the first segment that the key does not lie above
+
+            auto it = std::partition_point(keys_.begin(), keys_.end(),
+                [&key] (const interval_type& in) { return in.match(key) == Match::high; });
+
+            return {static_cast<std::size_t>(it - keys_.begin()), it != keys_.end() && it->match(key) == Match::ok};
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::pair<std::size_t, std::size_t> FlatIntervalMap<K, T>::do_overlapping(const interval_type& in) const {
+            auto [i,j] = Detail::overlapping_run(keys_.begin(), keys_.end(), in);
+            return {static_cast<std::size_t>(i - keys_.begin()), static_cast<std::size_t>(j - keys_.begin())};
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void FlatIntervalMap<K, T>::erase_entries(std::size_t i, std::size_t j) {
+            keys_.erase(keys_.begin() + offset(i), keys_.begin() + offset(j));
+            values_.erase(values_.begin() + offset(i), values_.begin() + offset(j));
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        template <typename U>
+        void FlatIntervalMap<K, T>::insert_entry(std::size_t i, const interval_type& in, U&& t) {
+
+            // The value may be an element of the same array, which insert()
+            // allows for; if it fails, the interval is removed again so that
+            // the arrays stay in step
+
+            values_.insert(values_.begin() + offset(i), std::forward<U>(t));
+
+            try {
+                keys_.insert(keys_.begin() + offset(i), in);
+            }
+            catch (...) {
+                values_.erase(values_.begin() + offset(i));
+                throw;
+            }
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        typename FlatIntervalMap<K, T>::iterator FlatIntervalMap<K, T>::make_iterator(std::size_t i) const noexcept {
+            return {keys_.begin() + offset(i), values_.begin() + offset(i)};
+        }
+
+    template <IntervalCompatible K, std::regular T>
+    bool operator==(const FlatIntervalMap<K, T>& a, const FlatIntervalMap<K, T>& b) noexcept {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+            [] (const auto& x, const auto& y) { return x.first == y.first && x.second == y.second; });
+    }
+
+    template <IntervalCompatible K, std::regular T>
+    auto operator<=>(const FlatIntervalMap<K, T>& a, const FlatIntervalMap<K, T>& b) noexcept {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end(),
+            [] (const auto& x, const auto& y) { return std::tie(x.first, x.second) <=> std::tie(y.first, y.second); });
+    }
+
+    template <IntervalCompatible K, std::regular T>
+    void swap(FlatIntervalMap<K, T>& a, FlatIntervalMap<K, T>& b) noexcept {
+        a.swap(b);
+    }
+
+}
+
+// The proxy reference and the value type of a flat map iterator have the
+// value type as their common reference, as the iterator concepts require
+
+template <typename K, typename T, template <typename> typename TQual, template <typename> typename UQual>
+struct std::basic_common_reference<RS::Interval::Detail::FlatMapEntry<K, T>, std::pair<RS::Interval::Interval<K>, T>, TQual, UQual> {
+    using type = std::pair<RS::Interval::Interval<K>, T>;
+};
+
+template <typename K, typename T, template <typename> typename TQual, template <typename> typename UQual>
+struct std::basic_common_reference<std::pair<RS::Interval::Interval<K>, T>, RS::Interval::Detail::FlatMapEntry<K, T>, TQual, UQual> {
+    using type = std::pair<RS::Interval::Interval<K>, T>;
+};
+
+template <RS::Interval::IntervalCompatible K, std::regular T>
+requires (std::formattable<K, char> && std::formattable<T, char>)
+struct std::formatter<RS::Interval::FlatIntervalMap<K, T>> {
+
+    std::formatter<RS::Interval::Interval<K>> key_interval_formatter;
+    std::formatter<T> value_formatter;
+
+    constexpr auto parse(std::format_parse_context& ctx) {
+        return ctx.begin();
+    }
+
+    template <typename FormatContext>
+    auto format(const RS::Interval::FlatIntervalMap<K, T>& map, FormatContext& ctx) const {
+
+        auto out = ctx.out();
+        *out++ = '{';
+
+        if (! map.empty()) {
+
+            auto in = map.begin();
+            auto end = map.end();
+            out = key_interval_formatter.format(in->first, ctx);
+            *out++ = ':';
+            out = value_formatter.format(in->second, ctx);
+            ++in;
+
+            while (in != end) {
+                *out++ = ',';
+                out = key_interval_formatter.format(in->first, ctx);
+                *out++ = ':';
+                out = value_formatter.format(in->second, ctx);
+                ++in;
+            }
+
+        }
+
+        *out++ = '}';
+
+        return out;
+
+    }
+
+};
@@ -0,0 +1,601 @@
+#pragma once
+
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set-algorithms.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace RS::Interval {
+
+    // Flat interval set
+
+    template <IntervalCompatible T>
+    class FlatIntervalSet {
+
+    public:
+
+        using iterator = typename std::vector<Interval<T>>::const_iterator;
+        using interval_type = Interval<T>;
+        using value_type = T;
+
+        static constexpr auto category = interval_category<T>;
+
+        FlatIntervalSet() = default;
+        FlatIntervalSet(const T& t): set_{{t}} { reindex(); }
+        FlatIntervalSet(const interval_type& in) { insert(in); }
+        FlatIntervalSet(std::initializer_list<interval_type> list): FlatIntervalSet(list.begin(), list.end()) {}
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, Interval<T>>
+        FlatIntervalSet(I first, S last) { assign(first, last); }
+        explicit FlatIntervalSet(const IntervalSet<T>& set): set_(set.begin(), set.end()) { reindex(); }
+
+        bool operator[](const T& t) const { return contains(t); }
+
+        auto begin() const noexcept { return set_.begin(); }
+        auto end() const noexcept { return set_.end(); }
+        bool empty() const noexcept { return set_.empty(); }
+        std::size_t size() const noexcept { return set_.size(); }
+        bool contains(const T& t) const;
+        void contains_batch(std::span<const T> keys, std::span<bool> out) const;
+        std::vector<T> filter(std::span<const T> keys) const;
+        std::ranges::subrange<iterator> overlapping(const interval_type& in) const;
+        std::size_t count_overlapping(const interval_type& in) const;
+        iterator nth(std::size_t i) const noexcept { return i < size() ? set_.begin() + static_cast<std::ptrdiff_t>(i) : end(); }
+        std::size_t rank(const T& t) const;
+        std::size_t cardinality() const noexcept requires (Integral<T> || Stepwise<T>) { return total(); }
+        std::size_t cardinality(const interval_type& within) const requires (Integral<T> || Stepwise<T>) { return measure_within(within); }
+        T measure() const noexcept requires Continuous<T> { return total(); }
+        T measure(const interval_type& within) const requires Continuous<T> { return measure_within(within); }
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, Interval<T>>
+        void assign(I first, S last);
+        void clear() noexcept { set_.clear(); prefix_.clear(); }
+        void insert(const interval_type& in);
+        void erase(const interval_type& in);
+        void reserve(std::size_t n) { set_.reserve(n); prefix_.reserve(n + 1); }
+        void shrink_to_fit() { set_.shrink_to_fit(); prefix_.shrink_to_fit(); }
+        void swap(FlatIntervalSet& set) noexcept { set_.swap(set.set_); prefix_.swap(set.prefix_); }
+        auto freeze() const requires Primitive<T> { return FrozenIntervalSet<T>(*this); }
+
+        FlatIntervalSet complement() const;
+        FlatIntervalSet set_intersection(const FlatIntervalSet& b) const;
+        FlatIntervalSet set_intersection(const interval_type& b) const;
+        FlatIntervalSet set_intersection(const T& b) const;
+        FlatIntervalSet set_intersection(const FlatIntervalSet& b, std::size_t threads) const;
+        FlatIntervalSet set_union(const FlatIntervalSet& b) const;
+        FlatIntervalSet set_union(const interval_type& b) const;
+        FlatIntervalSet set_union(const T& b) const;
+        FlatIntervalSet set_union(const FlatIntervalSet& b, std::size_t threads) const;
+        FlatIntervalSet set_difference(const FlatIntervalSet& b) const;
+        FlatIntervalSet set_difference(const interval_type& b) const;
+        FlatIntervalSet set_difference(const T& b) const;
+        FlatIntervalSet set_difference(const FlatIntervalSet& b, std::size_t threads) const;
+        FlatIntervalSet set_symmetric_difference(const FlatIntervalSet& b) const;
+        FlatIntervalSet set_symmetric_difference(const interval_type& b) const;
+        FlatIntervalSet set_symmetric_difference(const T& b) const;
+        FlatIntervalSet set_symmetric_difference(const FlatIntervalSet& b, std::size_t threads) const;
+
+        FlatIntervalSet& apply_complement();
+        FlatIntervalSet& apply_intersection(const FlatIntervalSet& b);
+        FlatIntervalSet& apply_intersection(const interval_type& b);
+        FlatIntervalSet& apply_intersection(const T& b);
+        FlatIntervalSet& apply_union(const FlatIntervalSet& b);
+        FlatIntervalSet& apply_union(const interval_type& b);
+        FlatIntervalSet& apply_union(const T& b);
+        FlatIntervalSet& apply_difference(const FlatIntervalSet& b);
+        FlatIntervalSet& apply_difference(const interval_type& b);
+        FlatIntervalSet& apply_difference(const T& b);
+        FlatIntervalSet& apply_symmetric_difference(const FlatIntervalSet& b);
+        FlatIntervalSet& apply_symmetric_difference(const interval_type& b);
+        FlatIntervalSet& apply_symmetric_difference(const T& b);
+
+    private:
+
+        using measure_type = Detail::measure_type<T>;
+
+        // prefix_[k] is the total size of the first k intervals, counting
+        // unbounded intervals as zero (they can only be at the ends). It is
+        // left empty for types whose intervals have no size. The sums are
+        // compensated, so that subtracting two large prefix sums does not
+        // lose the small lengths between them.
+
+        std::vector<Interval<T>> set_;
+        std::vector<Detail::CompensatedSum<measure_type>> prefix_;
+
+        measure_type total() const noexcept;
+        measure_type measure_within(const interval_type& within) const;
+        void reindex(std::size_t from = 0);
+        template <typename Combine> FlatIntervalSet parallel_combine(const FlatIntervalSet& b, std::size_t threads, Combine combine) const;
+
+    };
+
+        template <IntervalCompatible T>
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, Interval<T>>
+        void FlatIntervalSet<T>::assign(I first, S last) {
+            set_ = Detail::collect_intervals<T>(first, last);
+            reindex();
+        }
+
+        template <IntervalCompatible T>
+        bool FlatIntervalSet<T>::contains(const T& t) const {
+
+            // Find the first interval that lies entirely above the value; the
+            // only candidate for a match is the one before it.
+
+            auto i = std::partition_point(set_.begin(), set_.end(),
+                [&t] (const interval_type& in) { return in.match(t) != Match::low; });
+
+            return i != set_.begin() && std::prev(i)->match(t) == Match::ok;
+
+        }
+
+        template <IntervalCompatible T>
+        void FlatIntervalSet<T>::contains_batch(std::span<const T> keys, std::span<bool> out) const {
+
+            if (out.size() != keys.size()) {
+                throw std::invalid_argument("Batch query output size does not match input");
+            }
+
+            if (std::ranges::is_sorted(keys)) {
+                Detail::contains_sorted(set_.begin(), set_.end(), keys, out);
+            } else {
+                Detail::contains_interleaved(set_.data(), set_.size(), keys, out);
+            }
+
+        }
+
+        template <IntervalCompatible T>
+        std::vector<T> FlatIntervalSet<T>::filter(std::span<const T> keys) const {
+
+            auto flags = std::make_unique<bool[]>(keys.size());
+            contains_batch(keys, {flags.get(), keys.size()});
+            std::vector<T> result;
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                if (flags[k]) {
+                    result.push_back(keys[k]);
+                }
+            }
+
+            return result;
+
+        }
+
+        template <IntervalCompatible T>
+        void FlatIntervalSet<T>::insert(const interval_type& in) {
+
+            if (in.empty()) {
+                return;
+            }
+
+            // [i,j) is the run of intervals that touch or overlap the new one
+
+            auto i = std::partition_point(set_.begin(), set_.end(),
+                [&in] (const interval_type& x) { return in.order(x) == Order::b_below_a; });
+            auto j = std::partition_point(i, set_.end(),
+                [&in] (const interval_type& x) { return in.order(x) > Order::a_below_b; });
+
+            auto from = static_cast<std::size_t>(i - set_.begin());
+
+            if (i == j) {
+                set_.insert(i, in);
+            } else {
+                *i = in.envelope(*i).envelope(*std::prev(j));
+                set_.erase(std::next(i), j);
+            }
+
+            reindex(from);
+
+        }
+
+        template <IntervalCompatible T>
+        std::size_t FlatIntervalSet<T>::rank(const T& t) const {
+            auto i = std::partition_point(set_.begin(), set_.end(),
+                [&t] (const interval_type& in) { return in.match(t) == Match::high; });
+            return static_cast<std::size_t>(i - set_.begin());
+        }
+
+        template <IntervalCompatible T>
+        std::ranges::subrange<typename FlatIntervalSet<T>::iterator> FlatIntervalSet<T>::overlapping(const interval_type& in) const {
+            auto [i,j] = Detail::overlapping_run(set_.begin(), set_.end(), in);
+            return {i, j};
+        }
+
+        template <IntervalCompatible T>
+        std::size_t FlatIntervalSet<T>::count_overlapping(const interval_type& in) const {
+            auto [i,j] = Detail::overlapping_run(set_.begin(), set_.end(), in);
+            return static_cast<std::size_t>(j - i);
+        }
+
+        template <IntervalCompatible T>
+        void FlatIntervalSet<T>::erase(const interval_type& in) {
+
+            // [i,j) is the run of intervals that overlap the erased one
+
+            auto [i,j] = Detail::overlapping_run(set_.begin(), set_.end(), in);
+
+            if (i == j) {
+                return;
+            }
+
+            // Only the first and last intervals in the run can survive in part.
+            // They are trimmed in place, and the rest of the run is removed.
+
+            auto lower = Detail::lower_remainder(*i, in);
+            auto upper = Detail::upper_remainder(*std::prev(j), in);
+            auto from = static_cast<std::size_t>(i - set_.begin());
+
+            if (! lower.empty()) {
+                *i++ = lower;
+            }
+
+            if (! upper.empty()) {
+                if (i == j) {
+                    set_.insert(j, upper);
+                    reindex(from);
+                    return;
+                }
+                *--j = upper;
+            }
+
+            set_.erase(i, j);
+            reindex(from);
+
+        }
+
+        template <IntervalCompatible T>
+        typename FlatIntervalSet<T>::measure_type FlatIntervalSet<T>::total() const noexcept {
+            if (empty()) {
+                return {};
+            } else if (set_.front().is_infinite() || set_.back().is_infinite()) {
+                return Detail::infinite_measure<T>();
+            } else {
+                return prefix_.back().value();
+            }
+        }
+
+        template <IntervalCompatible T>
+        typename FlatIntervalSet<T>::measure_type FlatIntervalSet<T>::measure_within(const interval_type& within) const {
+
+            // Only the first and last intervals in the overlapping run can be
+            // cut short by the bounding interval; the ones between them are
+            // counted in full from the prefix sums.
+
+            auto [i,j] = Detail::overlapping_run(set_.begin(), set_.end(), within);
+
+            if (i == j) {
+                return {};
+            }
+
+            auto first = i->set_intersection(within);
+            auto last = std::prev(j)->set_intersection(within);
+
+            if (first.is_infinite() || last.is_infinite()) {
+                return Detail::infinite_measure<T>();
+            } else if (j - i == 1) {
+                return Detail::finite_measure(first);
+            }
+
+            auto lo = static_cast<std::size_t>(i - set_.begin()) + 1;
+            auto hi = static_cast<std::size_t>(j - set_.begin()) - 1;
+
+            return Detail::finite_measure(first) + (prefix_[hi] - prefix_[lo]) + Detail::finite_measure(last);
+
+        }
+
+        template <IntervalCompatible T>
+        void FlatIntervalSet<T>::reindex(std::size_t from) {
+            if constexpr (Detail::Measurable<T>) {
+                prefix_.resize(set_.size() + 1);
+                for (auto k = from; k < set_.size(); ++k) {
+                    prefix_[k + 1] = prefix_[k];
+                    prefix_[k + 1] += Detail::finite_measure(set_[k]);
+                }
+            }
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::complement() const {
+
+            if (empty()) {
+                return interval_type::all();
+            }
+
+            FlatIntervalSet result;
+            result.set_.reserve(size() + 1);
+            auto i = set_.begin();
+
+            if (i->is_left_bounded()) {
+                result.set_.push_back({{}, i->min(), Bound::unbound, ~ i->left()});
+            }
+
+            for (auto j = std::next(i), end = set_.end(); j != end; i = j++) {
+                result.set_.push_back({i->max(), j->min(), ~ i->right(), ~ j->left()});
+            }
+
+            if (i->is_right_bounded()) {
+                result.set_.push_back({i->max(), {}, ~ i->right(), Bound::unbound});
+            }
+
+            result.reindex();
+
+            return result;
+
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_intersection(const FlatIntervalSet& b) const {
+            FlatIntervalSet result;
+            result.set_.reserve(size() + b.size());
+            Detail::intersect_intervals(begin(), end(), b.begin(), b.end(), std::back_inserter(result.set_));
+            result.reindex();
+            return result;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_intersection(const interval_type& b) const {
+            return set_intersection(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_intersection(const T& b) const {
+            return set_intersection(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_intersection(const FlatIntervalSet& b, std::size_t threads) const {
+            return parallel_combine(b, threads, [] (auto i, auto j, auto k, auto l, auto out) {
+                return Detail::intersect_intervals(i, j, k, l, out);
+            });
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_union(const FlatIntervalSet& b) const {
+            FlatIntervalSet result;
+            result.set_.reserve(size() + b.size());
+            Detail::unite_intervals(begin(), end(), b.begin(), b.end(), std::back_inserter(result.set_));
+            result.reindex();
+            return result;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_union(const interval_type& b) const {
+            return set_union(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_union(const T& b) const {
+            return set_union(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_union(const FlatIntervalSet& b, std::size_t threads) const {
+            return parallel_combine(b, threads, [] (auto i, auto j, auto k, auto l, auto out) {
+                return Detail::unite_intervals(i, j, k, l, out);
+            });
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_difference(const FlatIntervalSet& b) const {
+            FlatIntervalSet result;
+            result.set_.reserve(size() + b.size());
+            Detail::subtract_intervals(begin(), end(), b.begin(), b.end(), std::back_inserter(result.set_));
+            result.reindex();
+            return result;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_difference(const interval_type& b) const {
+            return set_difference(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_difference(const T& b) const {
+            return set_difference(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_difference(const FlatIntervalSet& b, std::size_t threads) const {
+            return parallel_combine(b, threads, [] (auto i, auto j, auto k, auto l, auto out) {
+                return Detail::subtract_intervals(i, j, k, l, out);
+            });
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_symmetric_difference(const FlatIntervalSet& b) const {
+            FlatIntervalSet result;
+            result.set_.reserve(size() + b.size());
+            Detail::exclusive_intervals(begin(), end(), b.begin(), b.end(), std::back_inserter(result.set_));
+            result.reindex();
+            return result;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_symmetric_difference(const interval_type& b) const {
+            return set_symmetric_difference(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_symmetric_difference(const T& b) const {
+            return set_symmetric_difference(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T> FlatIntervalSet<T>::set_symmetric_difference(const FlatIntervalSet& b, std::size_t threads) const {
+            return parallel_combine(b, threads, [] (auto i, auto j, auto k, auto l, auto out) {
+                return Detail::exclusive_intervals(i, j, k, l, out);
+            });
+        }
+
+        template <IntervalCompatible T>
+        template <typename Combine>
+        FlatIntervalSet<T> FlatIntervalSet<T>::parallel_combine(const FlatIntervalSet& b, std::size_t threads, Combine combine) const {
+            FlatIntervalSet result;
+            result.set_ = Detail::parallel_combine<T>(set_, b.set_, threads, combine);
+            result.reindex();
+            return result;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_complement() {
+            auto set = complement();
+            swap(set);
+            return *this;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_intersection(const FlatIntervalSet& b) {
+            auto set = set_intersection(b);
+            swap(set);
+            return *this;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_intersection(const interval_type& b) {
+            return apply_intersection(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_intersection(const T& b) {
+            return apply_intersection(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_union(const FlatIntervalSet& b) {
+            auto set = set_union(b);
+            swap(set);
+            return *this;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_union(const interval_type& b) {
+            return apply_union(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_union(const T& b) {
+            return apply_union(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_difference(const FlatIntervalSet& b) {
+            auto set = set_difference(b);
+            swap(set);
+            return *this;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_difference(const interval_type& b) {
+            return apply_difference(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_difference(const T& b) {
+            return apply_difference(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_symmetric_difference(const FlatIntervalSet& b) {
+            auto set = set_symmetric_difference(b);
+            swap(set);
+            return *this;
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_symmetric_difference(const interval_type& b) {
+            return apply_symmetric_difference(FlatIntervalSet{b});
+        }
+
+        template <IntervalCompatible T>
+        FlatIntervalSet<T>& FlatIntervalSet<T>::apply_symmetric_difference(const T& b) {
+            return apply_symmetric_difference(FlatIntervalSet{b});
+        }
+
+    template <IntervalCompatible T>
+    bool operator==(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b) noexcept {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    template <IntervalCompatible T>
+    auto operator<=>(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b) noexcept {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    template <IntervalCompatible T>
+    void swap(FlatIntervalSet<T>& a, FlatIntervalSet<T>& b) noexcept {
+        a.swap(b);
+    }
+
+    template <IntervalCompatible T> auto set_intersection(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b) { return a.set_intersection(b); }
+    template <IntervalCompatible T> auto set_intersection(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b, std::size_t threads) { return a.set_intersection(b, threads); }
+    template <IntervalCompatible T> auto set_intersection(const FlatIntervalSet<T>& a, const Interval<T>& b) { return a.set_intersection(b); }
+    template <IntervalCompatible T> auto set_intersection(const Interval<T>& a, const FlatIntervalSet<T>& b) { return b.set_intersection(a); }
+    template <IntervalCompatible T> auto set_intersection(const FlatIntervalSet<T>& a, const T& b) { return a.set_intersection(b); }
+    template <IntervalCompatible T> auto set_intersection(const T& a, const FlatIntervalSet<T>& b) { return b.set_intersection(a); }
+
+    template <IntervalCompatible T> auto set_union(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b) { return a.set_union(b); }
+    template <IntervalCompatible T> auto set_union(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b, std::size_t threads) { return a.set_union(b, threads); }
+    template <IntervalCompatible T> auto set_union(const FlatIntervalSet<T>& a, const Interval<T>& b) { return a.set_union(b); }
+    template <IntervalCompatible T> auto set_union(const Interval<T>& a, const FlatIntervalSet<T>& b) { return b.set_union(a); }
+    template <IntervalCompatible T> auto set_union(const FlatIntervalSet<T>& a, const T& b) { return a.set_union(b); }
+    template <IntervalCompatible T> auto set_union(const T& a, const FlatIntervalSet<T>& b) { return b.set_union(a); }
+
+    template <IntervalCompatible T> auto set_difference(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b) { return a.set_difference(b); }
+    template <IntervalCompatible T> auto set_difference(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b, std::size_t threads) { return a.set_difference(b, threads); }
+    template <IntervalCompatible T> auto set_difference(const FlatIntervalSet<T>& a, const Interval<T>& b) { return a.set_difference(b); }
+    template <IntervalCompatible T> auto set_difference(const Interval<T>& a, const FlatIntervalSet<T>& b) { return FlatIntervalSet<T>(a).set_difference(b); }
+    template <IntervalCompatible T> auto set_difference(const FlatIntervalSet<T>& a, const T& b) { return a.set_difference(b); }
+    template <IntervalCompatible T> auto set_difference(const T& a, const FlatIntervalSet<T>& b) { return FlatIntervalSet<T>(a).set_difference(b); }
+
+    template <IntervalCompatible T> auto set_symmetric_difference(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b) { return a.set_symmetric_difference(b); }
+    template <IntervalCompatible T> auto set_symmetric_difference(const FlatIntervalSet<T>& a, const FlatIntervalSet<T>& b, std::size_t threads) { return a.set_symmetric_difference(b, threads); }
+    template <IntervalCompatible T> auto set_symmetric_difference(const FlatIntervalSet<T>& a, const Interval<T>& b) { return a.set_symmetric_difference(b); }
+    template <IntervalCompatible T> auto set_symmetric_difference(const Interval<T>& a, const FlatIntervalSet<T>& b) { return b.set_symmetric_difference(a); }
+    template <IntervalCompatible T> auto set_symmetric_difference(const FlatIntervalSet<T>& a, const T& b) { return a.set_symmetric_difference(b); }
+    template <IntervalCompatible T> auto set_symmetric_difference(const T& a, const FlatIntervalSet<T>& b) { return b.set_symmetric_difference(a); }
+
+}
+
+template <RS::Interval::IntervalCompatible T>
+requires (std::formattable<T, char>)
+struct std::formatter<RS::Interval::FlatIntervalSet<T>>:
+std::formatter<RS::Interval::Interval<T>> {
+
+    template <typename FormatContext>
+    auto format(const RS::Interval::FlatIntervalSet<T>& set, FormatContext& ctx) const {
+
+        using base = std::formatter<RS::Interval::Interval<T>>;
+
+        auto out = ctx.out();
+        *out++ = '{';
+
+        if (! set.empty()) {
+            auto in = set.begin();
+            auto end = set.end();
+            out = base::format(*in++, ctx);
+            while (in != end) {
+                *out++ = ',';
+                out = base::format(*in++, ctx);
+            }
+        }
+
+        *out++ = '}';
+
+        return out;
+
+    }
+
+};
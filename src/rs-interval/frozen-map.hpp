@@ -0,0 +1,171 @@
+#pragma once
+
+#include "rs-interval/eytzinger.hpp"
+#include "rs-interval/frozen-set.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/simd.hpp"
+#include "rs-interval/types.hpp"
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    // Frozen interval map
+
+    template <Primitive K, std::regular T>
+    class FrozenIntervalMap {
+
+    public:
+
+        using key_type = K;
+        using mapped_type = T;
+        using interval_type = Interval<K>;
+        using value_type = std::pair<Interval<K>, T>;
+        using iterator = typename std::vector<value_type>::const_iterator;
+
+        static constexpr auto category = interval_category<K>;
+
+        FrozenIntervalMap() = default;
+        template <CombinePolicy<T> C>
+        explicit FrozenIntervalMap(const IntervalMap<K, T, C>& map): def_(map.default_value()) { build(map.begin(), map.end(), map.size()); }
+        explicit FrozenIntervalMap(const FlatIntervalMap<K, T>& map): def_(map.default_value()) { build(map.begin(), map.end(), map.size()); }
+
+        const T& operator[](const K& key) const;
+
+        auto begin() const noexcept { return entries_.begin(); }
+        auto end() const noexcept { return entries_.end(); }
+        bool empty() const noexcept { return entries_.empty(); }
+        std::size_t size() const noexcept { return entries_.size(); }
+        const T& default_value() const noexcept { return def_; }
+        bool contains(const K& key) const { return do_find(key) != npos; }
+        iterator find(const K& key) const;
+        IntervalMap<K, T> to_map() const;
+
+    private:
+
+        static constexpr std::size_t npos = ~ std::size_t(0);
+
+        // The entries are kept in ascending order for iteration. The search
+        // arrays hold the inclusive bounds of the same intervals in
+        // Eytzinger order, with the index of the corresponding entry.
+
+        std::vector<value_type> entries_;
+        Detail::AlignedVector<K> lo_;
+        Detail::AlignedVector<K> hi_;
+        Detail::AlignedVector<std::size_t> index_;
+        T def_ {};
+
+        template <typename ForwardIterator> void build(ForwardIterator i, ForwardIterator j, std::size_t n);
+        std::size_t do_find(const K& key) const noexcept;
+
+    };
+
+        template <Primitive K, std::regular T>
+        template <typename ForwardIterator>
+        void FrozenIntervalMap<K, T>::build(ForwardIterator i, ForwardIterator j, std::size_t n) {
+
+            entries_.reserve(n);
+
+            for (; i != j; ++i) {
+                entries_.emplace_back(*i);
+            }
+
+            auto layout = Detail::eytzinger_layout(n);
+
+            lo_.assign(n + 1, K());
+            hi_.assign(n + 1, K());
+            index_.assign(n + 1, 0);
+
+            for (std::size_t k = 1; k <= n; ++k) {
+                const auto& in = entries_[layout[k]].first;
+                lo_[k] = Detail::inclusive_lower(in);
+                hi_[k] = Detail::inclusive_upper(in);
+                index_[k] = layout[k];
+            }
+
+        }
+
+        template <Primitive K, std::regular T>
+        const T& FrozenIntervalMap<K, T>::operator[](const K& key) const {
+            auto i = do_find(key);
+            return i == npos ? def_ : entries_[i].second;
+        }
+
+        template <Primitive K, std::regular T>
+        typename FrozenIntervalMap<K, T>::iterator FrozenIntervalMap<K, T>::find(const K& key) const {
+            auto i = do_find(key);
+            return i == npos ? end() : begin() + static_cast<std::ptrdiff_t>(i);
+        }
+
+        template <Primitive K, std::regular T>
+        IntervalMap<K, T> FrozenIntervalMap<K, T>::to_map() const {
+            IntervalMap<K, T> map(def_);
+            map.assign(entries_.begin(), entries_.end());
+            return map;
+        }
+
+        template <Primitive K, std::regular T>
+        std::size_t FrozenIntervalMap<K, T>::do_find(const K& key) const noexcept {
+
+            // The only interval that can contain the key is the first one
+            // whose upper bound is not below it
+
+            auto k = Detail::eytzinger_lower_bound(hi_.data(), entries_.size(), key);
+
+            if (k == 0 || ! (lo_[k] <= key)) {
+                return npos;
+            } else {
+                return index_[k];
+            }
+
+        }
+
+}
+
+template <RS::Interval::Primitive K, std::regular T>
+requires (std::formattable<K, char> && std::formattable<T, char>)
+struct std::formatter<RS::Interval::FrozenIntervalMap<K, T>> {
+
+    std::formatter<RS::Interval::Interval<K>> key_interval_formatter;
+    std::formatter<T> value_formatter;
+
+    constexpr auto parse(std::format_parse_context& ctx) {
+        return ctx.begin();
+    }
+
+    template <typename FormatContext>
+    auto format(const RS::Interval::FrozenIntervalMap<K, T>& map, FormatContext& ctx) const {
+
+        auto out = ctx.out();
+        *out++ = '{';
+
+        if (! map.empty()) {
+
+            auto in = map.begin();
+            auto end = map.end();
+            out = key_interval_formatter.format(in->first, ctx);
+            *out++ = ':';
+            out = value_formatter.format(in->second, ctx);
+            ++in;
+
+            while (in != end) {
+                *out++ = ',';
+                out = key_interval_formatter.format(in->first, ctx);
+                *out++ = ':';
+                out = value_formatter.format(in->second, ctx);
+                ++in;
+            }
+
+        }
+
+        *out++ = '}';
+
+        return out;
+
+    }
+
+};
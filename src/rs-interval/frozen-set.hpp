@@ -0,0 +1,233 @@
+#pragma once
+
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/simd.hpp"
+#include "rs-interval/types.hpp"
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Conversion between interval bounds and the inclusive bounds used
+        // by the frozen containers. Open bounds on floating point values are
+        // moved to the adjacent representable value, and unbounded ends
+        // become the extreme values of the type.
+
+        template <typename T>
+        T inclusive_lower(const Interval<T>& in) {
+            if (! in.is_left_bounded()) {
+                if constexpr (std::floating_point<T>) {
+                    return - std::numeric_limits<T>::infinity();
+                } else {
+                    return std::numeric_limits<T>::lowest();
+                }
+            } else if (in.is_left_open()) {
+                if constexpr (std::floating_point<T>) {
+                    return std::nextafter(in.min(), std::numeric_limits<T>::infinity());
+                } else {
+                    return in.min() + 1;
+                }
+            } else {
+                return in.min();
+            }
+        }
+
+        template <typename T>
+        T inclusive_upper(const Interval<T>& in) {
+            if (! in.is_right_bounded()) {
+                if constexpr (std::floating_point<T>) {
+                    return std::numeric_limits<T>::infinity();
+                } else {
+                    return std::numeric_limits<T>::max();
+                }
+            } else if (in.is_right_open()) {
+                if constexpr (std::floating_point<T>) {
+                    return std::nextafter(in.max(), - std::numeric_limits<T>::infinity());
+                } else {
+                    return in.max() - 1;
+                }
+            } else {
+                return in.max();
+            }
+        }
+
+        template <typename T>
+        Interval<T> exclusive_interval(T lo, T hi, Bound l, Bound r) {
+            if (l == Bound::open) {
+                if constexpr (std::floating_point<T>) {
+                    lo = std::nextafter(lo, - std::numeric_limits<T>::infinity());
+                } else {
+                    --lo;
+                }
+            }
+            if (r == Bound::open) {
+                if constexpr (std::floating_point<T>) {
+                    hi = std::nextafter(hi, std::numeric_limits<T>::infinity());
+                } else {
+                    ++hi;
+                }
+            }
+            if (l == Bound::unbound) {
+                lo = hi;
+            }
+            if (r == Bound::unbound) {
+                hi = lo;
+            }
+            return {lo, hi, l, r};
+        }
+
+    }
+
+    // Frozen interval set
+
+    template <Primitive T>
+    class FrozenIntervalSet {
+
+    public:
+
+        using interval_type = Interval<T>;
+        using value_type = T;
+
+        static constexpr auto category = interval_category<T>;
+
+        FrozenIntervalSet() = default;
+        explicit FrozenIntervalSet(const IntervalSet<T>& set) { build(set.begin(), set.end(), set.size()); }
+        explicit FrozenIntervalSet(const FlatIntervalSet<T>& set) { build(set.begin(), set.end(), set.size()); }
+
+        bool operator[](const T& t) const { return contains(t); }
+
+        bool empty() const noexcept { return size_ == 0; }
+        std::size_t size() const noexcept { return size_; }
+        interval_type interval(std::size_t i) const { return Detail::exclusive_interval(lo_[i], hi_[i], left_[i], right_[i]); }
+        bool contains(const T& t) const;
+        void contains_batch(std::span<const T> keys, std::span<bool> out) const;
+        std::vector<T> filter(std::span<const T> keys) const;
+        IntervalSet<T> to_set() const;
+
+    private:
+
+        Detail::AlignedVector<T> lo_;
+        Detail::AlignedVector<T> hi_;
+        Detail::AlignedVector<Bound> left_;
+        Detail::AlignedVector<Bound> right_;
+        Detail::AlignedVector<T> index_;
+        Detail::AlignedVector<std::size_t> block_;
+        std::size_t size_ = 0;
+
+        Detail::MembershipTable<T> table() const noexcept {
+            return {lo_.data(), hi_.data(), size_, index_.data(), block_.data(), index_.empty() ? 0 : index_.size() - 1};
+        }
+
+        template <typename ForwardIterator> void build(ForwardIterator i, ForwardIterator j, std::size_t n);
+
+    };
+
+        template <Primitive T>
+        template <typename ForwardIterator>
+        void FrozenIntervalSet<T>::build(ForwardIterator i, ForwardIterator j, std::size_t n) {
+
+            // The padding lets the kernels read a whole block past the last
+            // interval without a bounds check
+
+            auto padded = n + Detail::membership_block;
+
+            lo_.assign(padded, Detail::inclusive_upper(Interval<T>::all()));
+            hi_.assign(padded, Detail::inclusive_lower(Interval<T>::all()));
+            left_.assign(n, Bound::empty);
+            right_.assign(n, Bound::empty);
+            size_ = n;
+
+            for (std::size_t k = 0; i != j; ++i, ++k) {
+                lo_[k] = Detail::inclusive_lower(*i);
+                hi_[k] = Detail::inclusive_upper(*i);
+                left_[k] = i->left();
+                right_[k] = i->right();
+            }
+
+            Detail::build_membership_index(lo_.data(), n, index_, block_);
+
+        }
+
+        template <Primitive T>
+        bool FrozenIntervalSet<T>::contains(const T& t) const {
+            bool result = false;
+            Detail::membership_kernel<T>()(table(), &t, &result, 1);
+            return result;
+        }
+
+        template <Primitive T>
+        void FrozenIntervalSet<T>::contains_batch(std::span<const T> keys, std::span<bool> out) const {
+
+            if (out.size() != keys.size()) {
+                throw std::invalid_argument("Batch query output size does not match input");
+            }
+
+            Detail::membership_kernel<T>()(table(), keys.data(), out.data(), keys.size());
+
+        }
+
+        template <Primitive T>
+        std::vector<T> FrozenIntervalSet<T>::filter(std::span<const T> keys) const {
+
+            auto flags = std::make_unique<bool[]>(keys.size());
+            contains_batch(keys, {flags.get(), keys.size()});
+            std::vector<T> result;
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                if (flags[k]) {
+                    result.push_back(keys[k]);
+                }
+            }
+
+            return result;
+
+        }
+
+        template <Primitive T>
+        IntervalSet<T> FrozenIntervalSet<T>::to_set() const {
+            std::vector<interval_type> vec;
+            vec.reserve(size_);
+            for (std::size_t i = 0; i < size_; ++i) {
+                vec.push_back(interval(i));
+            }
+            return IntervalSet<T>(vec.begin(), vec.end());
+        }
+
+}
+
+template <RS::Interval::Primitive T>
+requires (std::formattable<T, char>)
+struct std::formatter<RS::Interval::FrozenIntervalSet<T>>:
+std::formatter<RS::Interval::Interval<T>> {
+
+    template <typename FormatContext>
+    auto format(const RS::Interval::FrozenIntervalSet<T>& set, FormatContext& ctx) const {
+
+        using base = std::formatter<RS::Interval::Interval<T>>;
+
+        auto out = ctx.out();
+        *out++ = '{';
+
+        for (std::size_t i = 0; i < set.size(); ++i) {
+            if (i != 0) {
+                *out++ = ',';
+            }
+            out = base::format(set.interval(i), ctx);
+        }
+
+        *out++ = '}';
+
+        return out;
+
+    }
+
+};
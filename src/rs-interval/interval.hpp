@@ -20,7 +20,11 @@ namespace RS::Interval {
 
     template <IntervalCompatible T> class Interval;
     template <IntervalCompatible T> class IntervalSet;
-    template <IntervalCompatible K, std::regular T> class IntervalMap;
+    template <IntervalCompatible T> class FlatIntervalSet;
+    template <Primitive T> class FrozenIntervalSet;
+    template <IntervalCompatible K, std::regular T, CombinePolicy<T> C = Overwrite> class IntervalMap;
+    template <IntervalCompatible K, std::regular T> class FlatIntervalMap;
+    template <Primitive K, std::regular T> class FrozenIntervalMap;
 
     // Interval class
 
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "rs-interval/frozen-map.hpp"
 #include "rs-interval/interval.hpp"
+#include "rs-interval/ranked-tree.hpp"
+#include "rs-interval/set-algorithms.hpp"
 #include "rs-interval/types.hpp"
 #include <algorithm>
 #include <compare>
@@ -8,15 +11,15 @@
 #include <cstddef>
 #include <format>
 #include <initializer_list>
-#include <map>
+#include <iterator>
+#include <ranges>
 #include <utility>
-#include <vector>
 
 namespace RS::Interval {
 
     // Interval map
 
-    template <IntervalCompatible K, std::regular T>
+    template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
     class IntervalMap {
 
     public:
@@ -24,14 +27,18 @@ namespace RS::Interval {
         using key_type = K;
         using mapped_type = T;
         using interval_type = Interval<K>;
-        using iterator = typename std::map<Interval<K>, T>::const_iterator;
-        using value_type = typename std::map<Interval<K>, T>::value_type;
+        using value_type = std::pair<Interval<K>, T>;
+        using iterator = typename Detail::RankedTree<value_type, Interval<K>>::iterator;
+        using combine_type = C;
 
         static constexpr auto category = interval_category<K>;
 
         IntervalMap() = default;
-        explicit IntervalMap(const T& defval): map_(), def_(defval) {}
-        IntervalMap(std::initializer_list<value_type> list) { for (const auto& v: list) insert(v); }
+        explicit IntervalMap(const T& defval, const C& combine = {}): map_(), def_(defval), combine_(combine) {}
+        IntervalMap(std::initializer_list<value_type> list): IntervalMap(list.begin(), list.end()) {}
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, value_type>
+        IntervalMap(I first, S last) { assign(first, last); }
 
         const T& operator[](const K& key) const;
 
@@ -45,36 +52,59 @@ namespace RS::Interval {
         iterator find(const K& key) const;
         iterator lower_bound(const K& key) const { return do_find(key).first; }
         iterator upper_bound(const K& key) const;
+        std::ranges::subrange<iterator> overlapping(const interval_type& in) const;
+        std::size_t count_overlapping(const interval_type& in) const;
+        iterator nth(std::size_t i) const noexcept { return map_.nth(i); }
+        std::size_t rank(const K& key) const { return map_.position(lower_bound(key)); }
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, value_type>
+        void assign(I first, S last);
         void clear() noexcept { map_.clear(); }
         void reset(const T& defval = {}) { def_ = defval; clear(); }
-        void insert(const interval_type& in, const T& t);
-        void insert(const value_type& v) { insert(v.first, v.second); }
+        void insert(const interval_type& in, const T& t) { do_insert(in, t); }
+        void insert(const interval_type& in, T&& t) { do_insert(in, std::move(t)); }
+        void insert(const value_type& v) { do_insert(v.first, v.second); }
+        void insert(value_type&& v) { do_insert(v.first, std::move(v.second)); }
+        template <typename... Args>
+        requires std::constructible_from<T, Args...>
+        void emplace(const interval_type& in, Args&&... args) { do_insert(in, T(std::forward<Args>(args)...)); }
         void erase(const interval_type& in);
-        void swap(IntervalMap& map) noexcept { map_.swap(map.map_); std::swap(def_, map.def_); }
+        void swap(IntervalMap& map) noexcept { map_.swap(map.map_); std::swap(def_, map.def_); std::swap(combine_, map.combine_); }
+        auto freeze() const requires Primitive<K> { return FrozenIntervalMap<K, T>(*this); }
 
     private:
 
-        std::map<Interval<K>, T> map_;
+        // The segments are held in a tree that records subtree sizes, so
+        // that they can be found by position
+
+        using tree_type = Detail::RankedTree<value_type, Interval<K>>;
+
+        tree_type map_;
         T def_ {};
+        [[no_unique_address]] C combine_ {};
 
+        void do_combine(const interval_type& in, const T& t);
         std::pair<iterator, bool> do_find(const K& key) const;
+        template <typename U> void do_insert(const interval_type& in, U&& t);
+        std::pair<iterator, iterator> do_overlapping(const interval_type& in) const;
+        template <typename U> void do_overwrite(const interval_type& in, U&& t);
 
     };
 
-        template <IntervalCompatible K, std::regular T>
-        const T& IntervalMap<K, T>::operator[](const K& key) const {
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        const T& IntervalMap<K, T, C>::operator[](const K& key) const {
             auto [it,ok] = do_find(key);
             return ok ? it->second : def_;
         }
 
-        template <IntervalCompatible K, std::regular T>
-        typename IntervalMap<K, T>::iterator IntervalMap<K, T>::find(const K& key) const {
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        typename IntervalMap<K, T, C>::iterator IntervalMap<K, T, C>::find(const K& key) const {
             auto [it,ok] = do_find(key);
             return ok ? it : end();
         }
 
-        template <IntervalCompatible K, std::regular T>
-        typename IntervalMap<K, T>::iterator IntervalMap<K, T>::upper_bound(const K& key) const {
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        typename IntervalMap<K, T, C>::iterator IntervalMap<K, T, C>::upper_bound(const K& key) const {
             auto [it,ok] = do_find(key);
             if (ok) {
                 ++it;
@@ -82,88 +112,190 @@ namespace RS::Interval {
             return it;
         }
 
-        template <IntervalCompatible K, std::regular T>
-        void IntervalMap<K, T>::insert(const interval_type& in, const T& t) {
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        std::ranges::subrange<typename IntervalMap<K, T, C>::iterator>
+        IntervalMap<K, T, C>::overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return {i, j};
+        }
 
-            if (in.empty()) {
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        std::size_t IntervalMap<K, T, C>::count_overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return static_cast<std::size_t>(std::distance(i, j));
+        }
+
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, typename IntervalMap<K, T, C>::value_type>
+        void IntervalMap<K, T, C>::assign(I first, S last) {
+
+            auto [list,disjoint] = Detail::collect_entries<K, T>(first, last);
+
+            // If any intervals overlap, they are inserted one at a time so
+            // that later entries take precedence
+
+            if (disjoint) {
+                map_ = tree_type(std::move(list));
+            } else {
+                map_.clear();
+                for (auto& [in,t]: list) {
+                    insert(in, std::move(t));
+                }
+            }
+
+        }
+
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        void IntervalMap<K, T, C>::erase(const interval_type& in) {
+
+            // [i,j) is the run of segments that overlap the erased interval
+
+            auto [i,j] = do_overlapping(in);
+
+            if (i == j) {
                 return;
             }
 
-            auto key = in;
-            auto i = map_.upper_bound(key);
+            // Only the first and last segments in the run can survive in part.
+            // Their nodes are trimmed and reused; a new node is only needed
+            // when a single segment is split in two.
 
-            if (i != map_.begin()) {
-                --i;
+            auto lower = Detail::lower_remainder(i->first, in);
+            auto upper = Detail::upper_remainder(std::prev(j)->first, in);
+            typename tree_type::node_type lower_node, upper_node;
+
+            if (! lower.empty()) {
+                lower_node = map_.extract(i++);
+                lower_node.key() = lower;
             }
 
-            std::vector<value_type> add;
-            std::vector<iterator> del;
+            bool split = ! upper.empty() && i == j;
 
-            for (; i != map_.end(); ++i) {
-                auto ord = key.order(i->first);
-                if (ord <= Order::a_below_b) {
-                    break;
-                } else if (ord <= Order::b_touches_a && i->second == t) {
-                    key = key.envelope(i->first);
-                    del.push_back(i);
-                } else if (ord == Order::b_touches_a) {
-                    break;
-                } else if (ord <= Order::b_overlaps_a) {
-                    auto diff = i->first.set_difference(in);
-                    for (const auto& d: diff)
-                        add.push_back({d, i->second});
-                    del.push_back(i);
+            if (! upper.empty() && ! split) {
+                auto k = std::prev(j);
+                if (k == i) {
+                    ++i;
                 }
+                upper_node = map_.extract(k);
+                upper_node.key() = upper;
             }
 
-            for (const auto& d: del) {
-                map_.erase(d);
-            }
+            map_.erase(i, j);
 
-            for (const auto& a: add) {
-                map_.insert(a);
+            if (lower_node) {
+                auto k = map_.insert(j, std::move(lower_node));
+                if (split) {
+                    map_.insert(j, {upper, k->second});
+                }
             }
 
-            map_.insert({key, t});
+            if (upper_node) {
+                map_.insert(j, std::move(upper_node));
+            }
 
         }
 
-        template <IntervalCompatible K, std::regular T>
-        void IntervalMap<K, T>::erase(const interval_type& in) {
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        void IntervalMap<K, T, C>::do_combine(const interval_type& in, const T& t) {
 
-            if (empty() || in.empty()) {
+            if (in.empty()) {
                 return;
             }
 
-            auto i = map_.lower_bound(in);
+            auto i = map_.upper_bound(in);
 
-            if (i != map_.begin()) {
+            for (int k = 0; k < 2 && i != map_.begin(); ++k) {
                 --i;
             }
 
-            std::vector<value_type> vec;
+            while (i != map_.end() && in.order(i->first) == Order::b_below_a) {
+                ++i;
+            }
 
-            while (i != map_.end()) {
-                auto ord = in.order(i->first);
-                if (ord <= Order::a_touches_b) {
-                    break;
+            // The run of segments that touch or overlap the new interval is
+            // replaced by a sequence of pieces in ascending order: the parts
+            // of the segments outside the new interval keep their values,
+            // the parts inside it have the new value combined into them, and
+            // the gaps between them take the new value. Pieces that touch and
+            // have equal values are merged before they are written back, and
+            // the nodes of the consumed segments are reused for them.
+
+            typename tree_type::node_type spare;
+            interval_type pending;
+            T pending_value {};
+            auto rest = in;
+
+            auto flush = [&] (iterator hint) {
+                if (pending.empty()) {
+                    return;
+                } else if (spare) {
+                    spare.key() = pending;
+                    spare.mapped() = std::move(pending_value);
+                    map_.insert(hint, std::move(spare));
+                } else {
+                    map_.emplace_hint(hint, pending, std::move(pending_value));
                 }
-                auto j = i++;
-                if (ord <= Order::b_overlaps_a) {
-                    auto temp = j->first.set_difference(in);
-                    for (const auto& t: temp) {
-                        vec.push_back({t, j->second});
-                    }
-                    map_.erase(j);
+                pending = {};
+            };
+
+            auto emit = [&] (const interval_type& piece, T&& value, iterator hint) {
+                if (! pending.empty() && pending_value == value && pending.touches(piece)) {
+                    pending = pending.envelope(piece);
+                } else {
+                    flush(hint);
+                    pending = piece;
+                    pending_value = std::move(value);
+                }
+            };
+
+            while (i != map_.end() && in.order(i->first) > Order::a_below_b) {
+
+                auto next = std::next(i);
+                auto node = map_.extract(i);
+                auto seg = node.key();
+                auto& v = node.mapped();
+                auto lower = Detail::lower_remainder(seg, in);
+                auto upper = Detail::upper_remainder(seg, in);
+                auto overlap = seg.set_intersection(in);
+                interval_type gap;
+
+                if (! rest.empty()) {
+                    gap = Detail::lower_remainder(rest, seg);
+                    rest = Detail::upper_remainder(rest, seg);
+                }
+
+                if (! lower.empty()) {
+                    emit(lower, overlap.empty() && upper.empty() ? T(std::move(v)) : T(v), next);
+                }
+
+                if (! gap.empty()) {
+                    emit(gap, T(t), next);
+                }
+
+                if (! overlap.empty()) {
+                    emit(overlap, T(combine_(std::as_const(v), t)), next);
                 }
+
+                if (! upper.empty()) {
+                    emit(upper, T(std::move(v)), next);
+                }
+
+                spare = std::move(node);
+                i = next;
+
             }
 
-            map_.insert(vec.begin(), vec.end());
+            if (! rest.empty()) {
+                emit(rest, T(t), i);
+            }
+
+            flush(i);
 
         }
 
-        template <IntervalCompatible K, std::regular T>
-        std::pair<typename IntervalMap<K, T>::iterator, bool> IntervalMap<K, T>::do_find(const K& key) const {
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        std::pair<typename IntervalMap<K, T, C>::iterator, bool> IntervalMap<K, T, C>::do_find(const K& key) const {
 
             if (empty()) {
                 return {end(), false};
@@ -187,13 +319,165 @@ namespace RS::Interval {
 
         }
 
-    template <IntervalCompatible K, std::regular T>
-    bool operator==(const IntervalMap<K, T>& a, const IntervalMap<K, T>& b) noexcept {
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        template <typename U>
+        void IntervalMap<K, T, C>::do_insert(const interval_type& in, U&& t) {
+            if constexpr (std::same_as<C, Overwrite>) {
+                do_overwrite(in, std::forward<U>(t));
+            } else {
+                do_combine(in, t);
+            }
+        }
+
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        std::pair<typename IntervalMap<K, T, C>::iterator, typename IntervalMap<K, T, C>::iterator>
+        IntervalMap<K, T, C>::do_overlapping(const interval_type& in) const {
+
+            if (empty() || in.empty()) {
+                return {end(), end()};
+            }
+
+            // Of the segments that start below the interval, only the last
+            // can overlap it
+
+            auto i = map_.lower_bound(in);
+
+            if (i != map_.begin()) {
+                --i;
+            }
+
+            while (i != map_.end() && in.order(i->first) >= Order::b_touches_a) {
+                ++i;
+            }
+
+            auto j = i;
+
+            while (j != map_.end() && in.order(j->first) > Order::a_touches_b) {
+                ++j;
+            }
+
+            return {i, j};
+
+        }
+
+        template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+        template <typename U>
+        void IntervalMap<K, T, C>::do_overwrite(const interval_type& in, U&& t) {
+
+            if (in.empty()) {
+                return;
+            }
+
+            // Step back over the segments that may overlap or touch the start
+            // of the new one: the last one that starts at or below it, and
+            // the one before that, which may touch it
+
+            auto i = map_.upper_bound(in);
+
+            for (int k = 0; k < 2 && i != map_.begin(); ++k) {
+                --i;
+            }
+
+            while (i != map_.end() && in.order(i->first) == Order::b_below_a) {
+                ++i;
+            }
+
+            // [i,j) is the run of segments that touch or overlap the new one
+
+            auto j = i;
+
+            while (j != map_.end() && in.order(j->first) > Order::a_below_b) {
+                ++j;
+            }
+
+            // Only the first and last segments in the run can extend beyond
+            // the new one. Each is either merged into it, if it has the same
+            // value, or trimmed to the part outside it.
+
+            auto key = in;
+            interval_type lower, upper;
+
+            if (i != j) {
+                auto last = std::prev(j);
+                if (i->second == t) {
+                    key = key.envelope(i->first);
+                } else {
+                    lower = Detail::lower_remainder(i->first, in);
+                }
+                if (last->second == t) {
+                    key = key.envelope(last->first);
+                } else {
+                    upper = Detail::upper_remainder(last->first, in);
+                }
+            }
+
+            // Trimmed segments have their nodes extracted and reused; a
+            // segment that only touches the new one is left where it is
+
+            typename tree_type::node_type lower_node, upper_node, key_node;
+            bool split = ! lower.empty() && ! upper.empty() && std::next(i) == j;
+
+            if (! lower.empty()) {
+                if (lower == i->first) {
+                    ++i;
+                } else {
+                    lower_node = map_.extract(i++);
+                    lower_node.key() = lower;
+                }
+            }
+
+            if (! upper.empty() && ! split) {
+                auto k = std::prev(j);
+                if (upper == k->first) {
+                    j = k;
+                } else {
+                    if (k == i) {
+                        ++i;
+                    }
+                    upper_node = map_.extract(k);
+                    upper_node.key() = upper;
+                }
+            }
+
+            // Any segments left in the run are covered by the new one. The
+            // first of them is reused for it, and the rest are erased in one
+            // call, so a new node is only needed when nothing is replaced.
+
+            if (i != j) {
+                key_node = map_.extract(i++);
+                key_node.key() = key;
+                key_node.mapped() = std::forward<U>(t);
+                map_.erase(i, j);
+            }
+
+            if (lower_node) {
+                auto k = map_.insert(j, std::move(lower_node));
+                if (split) {
+                    map_.emplace_hint(j, key, std::forward<U>(t));
+                    map_.emplace_hint(j, upper, k->second);
+                    return;
+                }
+            }
+
+            if (key_node) {
+                map_.insert(j, std::move(key_node));
+            } else {
+                map_.emplace_hint(j, key, std::forward<U>(t));
+            }
+
+            if (upper_node) {
+                map_.insert(j, std::move(upper_node));
+            }
+
+        }
+
+    template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+    bool operator==(const IntervalMap<K, T, C>& a, const IntervalMap<K, T, C>& b) noexcept {
         return std::equal(a.begin(), a.end(), b.begin(), b.end());
     }
 
-    template <IntervalCompatible K, std::regular T>
-    auto operator<=>(const IntervalMap<K, T>& a, const IntervalMap<K, T>& b) noexcept {
+    template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+    auto operator<=>(const IntervalMap<K, T, C>& a, const IntervalMap<K, T, C>& b) noexcept {
 
         auto i = a.begin();
         auto j = a.end();
@@ -217,16 +501,16 @@ namespace RS::Interval {
 
     }
 
-    template <IntervalCompatible K, std::regular T>
-    void swap(IntervalMap<K, T>& a, IntervalMap<K, T>& b) noexcept {
+    template <IntervalCompatible K, std::regular T, CombinePolicy<T> C>
+    void swap(IntervalMap<K, T, C>& a, IntervalMap<K, T, C>& b) noexcept {
         a.swap(b);
     }
 
 }
 
-template <RS::Interval::IntervalCompatible K, std::regular T>
+template <RS::Interval::IntervalCompatible K, std::regular T, RS::Interval::CombinePolicy<T> C>
 requires (std::formattable<K, char> && std::formattable<T, char>)
-struct std::formatter<RS::Interval::IntervalMap<K, T>> {
+struct std::formatter<RS::Interval::IntervalMap<K, T, C>> {
 
     std::formatter<RS::Interval::Interval<K>> key_interval_formatter;
     std::formatter<T> value_formatter;
@@ -236,7 +520,7 @@ struct std::formatter<RS::Interval::IntervalMap<K, T>> {
     }
 
     template <typename FormatContext>
-    auto format(const RS::Interval::IntervalMap<K, T>& map, FormatContext& ctx) const {
+    auto format(const RS::Interval::IntervalMap<K, T, C>& map, FormatContext& ctx) const {
 
         auto out = ctx.out();
         *out++ = '{';
@@ -0,0 +1,565 @@
+#pragma once
+
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set-algorithms.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <initializer_list>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    // Interval multimap
+
+    template <IntervalCompatible K, std::regular T>
+    class IntervalMultiMap {
+
+    public:
+
+        class iterator;
+
+        using key_type = K;
+        using mapped_type = T;
+        using interval_type = Interval<K>;
+        using value_type = std::pair<Interval<K>, T>;
+
+        static constexpr auto category = interval_category<K>;
+
+        IntervalMultiMap() = default;
+        IntervalMultiMap(std::initializer_list<value_type> list): IntervalMultiMap(list.begin(), list.end()) {}
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, value_type>
+        IntervalMultiMap(I first, S last) { assign(first, last); }
+
+        iterator begin() const noexcept { return {this, leftmost(root_)}; }
+        iterator end() const noexcept { return {this, npos}; }
+        bool empty() const noexcept { return size_ == 0; }
+        std::size_t size() const noexcept { return size_; }
+        bool contains(const K& key) const { return count(key) != 0; }
+        std::size_t count(const K& key) const { return count_overlapping(interval_type(key)); }
+        std::vector<iterator> stab(const K& key) const { return overlapping(interval_type(key)); }
+        std::vector<iterator> overlapping(const interval_type& in) const;
+        std::size_t count_overlapping(const interval_type& in) const;
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, value_type>
+        void assign(I first, S last);
+        void clear() noexcept { nodes_.clear(); free_.clear(); root_ = npos; size_ = 0; }
+        iterator insert(const interval_type& in, const T& t) { return do_insert(in, t); }
+        iterator insert(const interval_type& in, T&& t) { return do_insert(in, std::move(t)); }
+        iterator insert(const value_type& v) { return do_insert(v.first, v.second); }
+        iterator insert(value_type&& v) { return do_insert(v.first, std::move(v.second)); }
+        iterator erase(iterator i);
+        std::size_t erase(const value_type& v);
+        void reserve(std::size_t n) { nodes_.reserve(n); }
+        void swap(IntervalMultiMap& map) noexcept;
+
+        friend bool operator==(const IntervalMultiMap& a, const IntervalMultiMap& b) noexcept {
+            return a.size() == b.size() && std::ranges::equal(a, b);
+        }
+
+    private:
+
+        using point = Detail::SweepPoint<K>;
+
+        static constexpr std::size_t npos = ~ std::size_t(0);
+
+        // The entries are held in a treap, ordered by lower bound, then by
+        // upper bound, then by order of insertion, and heap ordered by a
+        // random priority. Each node holds the highest upper bound of any
+        // entry in its subtree, so that a search can skip every subtree
+        // that ends before the query interval starts. Nodes live in a pool
+        // and are linked by index; erased nodes are recycled, so indices
+        // (and iterators) stay valid until their own entry is erased.
+
+        struct node {
+            value_type entry;
+            point reach;
+            std::uint_fast32_t priority = 0;
+            std::size_t left = npos;
+            std::size_t right = npos;
+            std::size_t parent = npos;
+        };
+
+        std::vector<node> nodes_;
+        std::vector<std::size_t> free_;
+        std::size_t root_ = npos;
+        std::size_t size_ = 0;
+        std::minstd_rand rng_;
+
+        static bool entry_less(const value_type& a, const value_type& b);
+        template <typename U> iterator do_insert(const interval_type& in, U&& t);
+        template <typename F> void search(std::size_t n, const interval_type& in,
+            const point& start, const point& stop, F f) const;
+        std::size_t leftmost(std::size_t n) const noexcept;
+        std::size_t rightmost(std::size_t n) const noexcept;
+        std::size_t next_node(std::size_t n) const noexcept;
+        std::size_t prev_node(std::size_t n) const noexcept;
+        std::size_t new_node(value_type&& v);
+        void pull(std::size_t n);
+        void pull_all(std::size_t n);
+        void pull_up(std::size_t n);
+        void replace_child(std::size_t parent, std::size_t old_child, std::size_t new_child) noexcept;
+        void rotate_up(std::size_t n);
+
+    };
+
+        template <IntervalCompatible K, std::regular T>
+        class IntervalMultiMap<K, T>::iterator {
+
+        public:
+
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::bidirectional_iterator_tag;
+            using pointer = const std::pair<Interval<K>, T>*;
+            using reference = const std::pair<Interval<K>, T>&;
+            using value_type = std::pair<Interval<K>, T>;
+
+            iterator() = default;
+
+            reference operator*() const noexcept { return owner_->nodes_[node_].entry; }
+            pointer operator->() const noexcept { return &**this; }
+            iterator& operator++() noexcept { node_ = owner_->next_node(node_); return *this; }
+            iterator operator++(int) noexcept { auto i = *this; ++*this; return i; }
+            iterator& operator--() noexcept { node_ = owner_->prev_node(node_); return *this; }
+            iterator operator--(int) noexcept { auto i = *this; --*this; return i; }
+
+            friend bool operator==(const iterator& i, const iterator& j) noexcept { return i.node_ == j.node_; }
+
+        private:
+
+            friend class IntervalMultiMap;
+
+            const IntervalMultiMap* owner_ = nullptr;
+            std::size_t node_ = npos;
+
+            iterator(const IntervalMultiMap* owner, std::size_t node) noexcept: owner_(owner), node_(node) {}
+
+        };
+
+        template <IntervalCompatible K, std::regular T>
+        std::vector<typename IntervalMultiMap<K, T>::iterator> IntervalMultiMap<K, T>::overlapping(const interval_type& in) const {
+            std::vector<iterator> result;
+            if (! in.empty()) {
+                search(root_, in, Detail::lower_point(in), Detail::upper_point(in),
+                    [this, &result] (std::size_t n) { result.push_back({this, n}); });
+            }
+            return result;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t IntervalMultiMap<K, T>::count_overlapping(const interval_type& in) const {
+            std::size_t n = 0;
+            if (! in.empty()) {
+                search(root_, in, Detail::lower_point(in), Detail::upper_point(in), [&n] (std::size_t) { ++n; });
+            }
+            return n;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, typename IntervalMultiMap<K, T>::value_type>
+        void IntervalMultiMap<K, T>::assign(I first, S last) {
+
+            std::vector<value_type> entries;
+
+            for (; first != last; ++first) {
+                value_type v(*first);
+                if (! v.first.empty()) {
+                    entries.push_back(std::move(v));
+                }
+            }
+
+            std::ranges::stable_sort(entries, entry_less);
+
+            // Build the treap from the sorted entries in linear time, using
+            // the right spine as a stack
+
+            clear();
+            nodes_.reserve(entries.size());
+            std::vector<std::size_t> spine;
+
+            for (auto& v: entries) {
+
+                auto n = nodes_.size();
+                auto& x = nodes_.emplace_back();
+                x.entry = std::move(v);
+                x.priority = rng_();
+                auto last = npos;
+
+                while (! spine.empty() && nodes_[spine.back()].priority < x.priority) {
+                    last = spine.back();
+                    spine.pop_back();
+                }
+
+                x.left = last;
+
+                if (last != npos) {
+                    nodes_[last].parent = n;
+                }
+
+                if (! spine.empty()) {
+                    nodes_[spine.back()].right = n;
+                    x.parent = spine.back();
+                }
+
+                spine.push_back(n);
+
+            }
+
+            size_ = nodes_.size();
+
+            if (! spine.empty()) {
+                root_ = spine.front();
+                pull_all(root_);
+            }
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        typename IntervalMultiMap<K, T>::iterator IntervalMultiMap<K, T>::erase(iterator i) {
+
+            auto n = i.node_;
+            auto next = next_node(n);
+
+            // Rotate the node down until it is a leaf, then unlink it and
+            // recompute the reach of its former ancestors
+
+            for (;;) {
+                auto& x = nodes_[n];
+                if (x.left == npos && x.right == npos) {
+                    break;
+                }
+                auto c = x.left == npos ? x.right
+                    : x.right == npos ? x.left
+                    : nodes_[x.left].priority > nodes_[x.right].priority ? x.left : x.right;
+                rotate_up(c);
+            }
+
+            auto p = nodes_[n].parent;
+            replace_child(p, n, npos);
+            pull_up(p);
+            nodes_[n] = {};
+            free_.push_back(n);
+            --size_;
+
+            return {this, next};
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t IntervalMultiMap<K, T>::erase(const value_type& v) {
+
+            // Equal entries are adjacent in the sorted order
+
+            auto first = npos;
+
+            for (auto c = root_; c != npos;) {
+                if (entry_less(nodes_[c].entry, v)) {
+                    c = nodes_[c].right;
+                } else {
+                    first = c;
+                    c = nodes_[c].left;
+                }
+            }
+
+            std::size_t n = 0;
+            iterator i(this, first);
+
+            while (i != end() && ! entry_less(v, *i)) {
+                if (*i == v) {
+                    i = erase(i);
+                    ++n;
+                } else {
+                    ++i;
+                }
+            }
+
+            return n;
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void IntervalMultiMap<K, T>::swap(IntervalMultiMap& map) noexcept {
+            nodes_.swap(map.nodes_);
+            free_.swap(map.free_);
+            std::swap(root_, map.root_);
+            std::swap(size_, map.size_);
+            std::swap(rng_, map.rng_);
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        bool IntervalMultiMap<K, T>::entry_less(const value_type& a, const value_type& b) {
+            auto la = Detail::lower_point(a.first);
+            auto lb = Detail::lower_point(b.first);
+            if (la < lb) {
+                return true;
+            } else if (lb < la) {
+                return false;
+            } else {
+                return Detail::upper_point(a.first) < Detail::upper_point(b.first);
+            }
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        template <typename U>
+        typename IntervalMultiMap<K, T>::iterator IntervalMultiMap<K, T>::do_insert(const interval_type& in, U&& t) {
+
+            if (in.empty()) {
+                return end();
+            }
+
+            // A new entry goes after any existing entries with the same
+            // interval. It is added as a leaf, and then rotated up until the
+            // heap order is restored.
+
+            auto n = new_node(value_type(in, std::forward<U>(t)));
+            auto p = npos;
+            auto left = false;
+
+            for (auto c = root_; c != npos;) {
+                p = c;
+                left = entry_less(nodes_[n].entry, nodes_[c].entry);
+                c = left ? nodes_[c].left : nodes_[c].right;
+            }
+
+            nodes_[n].parent = p;
+
+            if (p == npos) {
+                root_ = n;
+            } else if (left) {
+                nodes_[p].left = n;
+            } else {
+                nodes_[p].right = n;
+            }
+
+            pull_up(n);
+
+            while (nodes_[n].parent != npos && nodes_[nodes_[n].parent].priority < nodes_[n].priority) {
+                rotate_up(n);
+            }
+
+            ++size_;
+
+            return {this, n};
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        template <typename F>
+        void IntervalMultiMap<K, T>::search(std::size_t n, const interval_type& in,
+                const point& start, const point& stop, F f) const {
+
+            // An entry overlaps the query interval if its lower bound is
+            // below the query's upper bound, and its upper bound is above
+            // the query's lower bound
+
+            if (n == npos) {
+                return;
+            }
+
+            auto& x = nodes_[n];
+
+            if (! (start < x.reach)) {
+                return;
+            }
+
+            search(x.left, in, start, stop, f);
+
+            if (! (Detail::lower_point(x.entry.first) < stop)) {
+                return;
+            }
+
+            if (x.entry.first.overlaps(in)) {
+                f(n);
+            }
+
+            search(x.right, in, start, stop, f);
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t IntervalMultiMap<K, T>::leftmost(std::size_t n) const noexcept {
+            if (n != npos) {
+                while (nodes_[n].left != npos) {
+                    n = nodes_[n].left;
+                }
+            }
+            return n;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t IntervalMultiMap<K, T>::rightmost(std::size_t n) const noexcept {
+            if (n != npos) {
+                while (nodes_[n].right != npos) {
+                    n = nodes_[n].right;
+                }
+            }
+            return n;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t IntervalMultiMap<K, T>::next_node(std::size_t n) const noexcept {
+            if (nodes_[n].right != npos) {
+                return leftmost(nodes_[n].right);
+            }
+            auto p = nodes_[n].parent;
+            while (p != npos && nodes_[p].right == n) {
+                n = p;
+                p = nodes_[p].parent;
+            }
+            return p;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t IntervalMultiMap<K, T>::prev_node(std::size_t n) const noexcept {
+            if (n == npos) {
+                return rightmost(root_);
+            } else if (nodes_[n].left != npos) {
+                return rightmost(nodes_[n].left);
+            }
+            auto p = nodes_[n].parent;
+            while (p != npos && nodes_[p].left == n) {
+                n = p;
+                p = nodes_[p].parent;
+            }
+            return p;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t IntervalMultiMap<K, T>::new_node(value_type&& v) {
+
+            std::size_t n;
+
+            if (free_.empty()) {
+                n = nodes_.size();
+                nodes_.emplace_back();
+            } else {
+                n = free_.back();
+                free_.pop_back();
+            }
+
+            nodes_[n].entry = std::move(v);
+            nodes_[n].priority = rng_();
+
+            return n;
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void IntervalMultiMap<K, T>::pull(std::size_t n) {
+            auto& x = nodes_[n];
+            x.reach = Detail::upper_point(x.entry.first);
+            for (auto c: {x.left, x.right}) {
+                if (c != npos) {
+                    x.reach = std::max(x.reach, nodes_[c].reach);
+                }
+            }
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void IntervalMultiMap<K, T>::pull_all(std::size_t n) {
+            if (n != npos) {
+                pull_all(nodes_[n].left);
+                pull_all(nodes_[n].right);
+                pull(n);
+            }
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void IntervalMultiMap<K, T>::pull_up(std::size_t n) {
+            for (; n != npos; n = nodes_[n].parent) {
+                pull(n);
+            }
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void IntervalMultiMap<K, T>::replace_child(std::size_t parent, std::size_t old_child, std::size_t new_child) noexcept {
+            if (parent == npos) {
+                root_ = new_child;
+            } else if (nodes_[parent].left == old_child) {
+                nodes_[parent].left = new_child;
+            } else {
+                nodes_[parent].right = new_child;
+            }
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        void IntervalMultiMap<K, T>::rotate_up(std::size_t n) {
+
+            // Rotate the node above its parent. The subtree keeps the same
+            // entries, so only the two nodes' reaches change.
+
+            auto& x = nodes_[n];
+            auto p = x.parent;
+            auto& y = nodes_[p];
+            auto g = y.parent;
+
+            if (y.left == n) {
+                y.left = x.right;
+                if (x.right != npos) {
+                    nodes_[x.right].parent = p;
+                }
+                x.right = p;
+            } else {
+                y.right = x.left;
+                if (x.left != npos) {
+                    nodes_[x.left].parent = p;
+                }
+                x.left = p;
+            }
+
+            y.parent = n;
+            x.parent = g;
+            replace_child(g, p, n);
+            pull(p);
+            pull(n);
+
+        }
+
+    template <IntervalCompatible K, std::regular T>
+    void swap(IntervalMultiMap<K, T>& a, IntervalMultiMap<K, T>& b) noexcept {
+        a.swap(b);
+    }
+
+}
+
+template <RS::Interval::IntervalCompatible K, std::regular T>
+requires (std::formattable<K, char> && std::formattable<T, char>)
+struct std::formatter<RS::Interval::IntervalMultiMap<K, T>> {
+
+    std::formatter<RS::Interval::Interval<K>> key_interval_formatter;
+    std::formatter<T> value_formatter;
+
+    constexpr auto parse(std::format_parse_context& ctx) {
+        return ctx.begin();
+    }
+
+    template <typename FormatContext>
+    auto format(const RS::Interval::IntervalMultiMap<K, T>& map, FormatContext& ctx) const {
+
+        auto out = ctx.out();
+        *out++ = '{';
+
+        for (auto in = map.begin(); in != map.end(); ++in) {
+            if (in != map.begin()) {
+                *out++ = ',';
+            }
+            out = key_interval_formatter.format(in->first, ctx);
+            *out++ = ':';
+            out = value_formatter.format(in->second, ctx);
+        }
+
+        *out++ = '}';
+
+        return out;
+
+    }
+
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/persistent-tree.hpp"
+#include "rs-interval/set-algorithms.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <initializer_list>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    // Persistent interval map
+
+    template <IntervalCompatible K, std::regular T>
+    class PersistentIntervalMap {
+
+    public:
+
+        using key_type = K;
+        using mapped_type = T;
+        using interval_type = Interval<K>;
+        using value_type = std::pair<Interval<K>, T>;
+        using iterator = typename Detail::PersistentTree<value_type>::iterator;
+
+        static constexpr auto category = interval_category<K>;
+
+        PersistentIntervalMap() = default;
+        explicit PersistentIntervalMap(const T& defval): tree_(), def_(defval) {}
+        PersistentIntervalMap(std::initializer_list<value_type> list): PersistentIntervalMap(list.begin(), list.end()) {}
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, value_type>
+        PersistentIntervalMap(I first, S last);
+        template <CombinePolicy<T> C>
+        explicit PersistentIntervalMap(const IntervalMap<K, T, C>& map):
+            tree_(std::vector<value_type>(map.begin(), map.end())), def_(map.default_value()) {}
+
+        const T& operator[](const K& key) const;
+
+        iterator begin() const { return tree_.begin(); }
+        iterator end() const noexcept { return tree_.end(); }
+        bool empty() const noexcept { return tree_.empty(); }
+        std::size_t size() const noexcept { return tree_.size(); }
+        const T& default_value() const noexcept { return def_; }
+        bool contains(const K& key) const { return do_find(key).second; }
+        iterator find(const K& key) const;
+        std::ranges::subrange<iterator> overlapping(const interval_type& in) const;
+        std::size_t count_overlapping(const interval_type& in) const;
+        iterator nth(std::size_t i) const { return tree_.nth(i); }
+        std::size_t rank(const K& key) const { return do_find(key).first; }
+        PersistentIntervalMap insert(const interval_type& in, const T& t) const;
+        PersistentIntervalMap insert(const value_type& v) const { return insert(v.first, v.second); }
+        PersistentIntervalMap erase(const interval_type& in) const;
+        IntervalMap<K, T> to_map() const;
+
+        friend bool operator==(const PersistentIntervalMap& a, const PersistentIntervalMap& b) {
+            return a.tree_.shares_root(b.tree_) || std::ranges::equal(a, b);
+        }
+
+    private:
+
+        // As with the persistent set, each version holds the root of a tree
+        // whose nodes are shared with every other version derived from it
+
+        Detail::PersistentTree<value_type> tree_;
+        T def_ {};
+
+        PersistentIntervalMap(Detail::PersistentTree<value_type>&& tree, const T& defval): tree_(std::move(tree)), def_(defval) {}
+
+        std::pair<std::size_t, bool> do_find(const K& key) const;
+        std::pair<std::size_t, std::size_t> do_overlapping(const interval_type& in) const;
+
+    };
+
+        template <IntervalCompatible K, std::regular T>
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, typename PersistentIntervalMap<K, T>::value_type>
+        PersistentIntervalMap<K, T>::PersistentIntervalMap(I first, S last) {
+
+            auto [list,disjoint] = Detail::collect_entries<K, T>(first, last);
+
+            // If any intervals overlap, they are inserted one at a time so
+            // that later entries take precedence
+
+            if (disjoint) {
+                tree_ = Detail::PersistentTree<value_type>(std::move(list));
+            } else {
+                for (auto& [in,t]: list) {
+                    *this = insert(in, t);
+                }
+            }
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        const T& PersistentIntervalMap<K, T>::operator[](const K& key) const {
+            auto [i,ok] = do_find(key);
+            return ok ? tree_[i].second : def_;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        typename PersistentIntervalMap<K, T>::iterator PersistentIntervalMap<K, T>::find(const K& key) const {
+            auto [i,ok] = do_find(key);
+            return ok ? tree_.nth(i) : end();
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::ranges::subrange<typename PersistentIntervalMap<K, T>::iterator>
+        PersistentIntervalMap<K, T>::overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return {tree_.nth(i), tree_.nth(j)};
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::size_t PersistentIntervalMap<K, T>::count_overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return j - i;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        PersistentIntervalMap<K, T> PersistentIntervalMap<K, T>::insert(const interval_type& in, const T& t) const {
+
+            if (in.empty()) {
+                return *this;
+            }
+
+            // [i,j) is the run of segments that touch or overlap the new one
+
+            auto i = tree_.partition_point([&in] (const value_type& x) { return in.order(x.first) > Order::b_touches_a; });
+            auto j = tree_.partition_point([&in] (const value_type& x) { return in.order(x.first) > Order::a_below_b; });
+
+            // Only the first and last segments in the run can extend beyond
+            // the new one. Each is either merged into it, if it has the same
+            // value, or trimmed to the part outside it.
+
+            auto key = in;
+            std::vector<value_type> pieces;
+
+            if (i < j) {
+
+                auto& first = tree_[i];
+                auto& last = tree_[j - 1];
+
+                if (first.second == t) {
+                    key = key.envelope(first.first);
+                } else if (auto lower = Detail::lower_remainder(first.first, in); ! lower.empty()) {
+                    pieces.push_back({lower, first.second});
+                }
+
+                if (last.second == t) {
+                    key = key.envelope(last.first);
+                }
+
+                if (j - i == 1 && pieces.empty() && key == first.first && first.second == t) {
+                    return *this;
+                }
+
+                pieces.push_back({key, t});
+
+                if (last.second != t) {
+                    if (auto upper = Detail::upper_remainder(last.first, in); ! upper.empty()) {
+                        pieces.push_back({upper, last.second});
+                    }
+                }
+
+            } else {
+
+                pieces.push_back({key, t});
+
+            }
+
+            return {tree_.replace(i, j, std::move(pieces)), def_};
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        PersistentIntervalMap<K, T> PersistentIntervalMap<K, T>::erase(const interval_type& in) const {
+
+            auto [i,j] = do_overlapping(in);
+
+            if (i == j) {
+                return *this;
+            }
+
+            // Only the first and last segments in the run can survive in part
+
+            auto& first = tree_[i];
+            auto& last = tree_[j - 1];
+            auto lower = Detail::lower_remainder(first.first, in);
+            auto upper = Detail::upper_remainder(last.first, in);
+            std::vector<value_type> rest;
+
+            if (! lower.empty()) {
+                rest.push_back({lower, first.second});
+            }
+
+            if (! upper.empty()) {
+                rest.push_back({upper, last.second});
+            }
+
+            return {tree_.replace(i, j, std::move(rest)), def_};
+
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        IntervalMap<K, T> PersistentIntervalMap<K, T>::to_map() const {
+            IntervalMap<K, T> map(def_);
+            map.assign(begin(), end());
+            return map;
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::pair<std::size_t, bool> PersistentIntervalMap<K, T>::do_find(const K& key) const {
+            auto i = tree_.partition_point([&key] (const value_type& x) { return x.first.match(key) == Match::high; });
+            return {i, i < size() && tree_[i].first.match(key) == Match::ok};
+        }
+
+        template <IntervalCompatible K, std::regular T>
+        std::pair<std::size_t, std::size_t> PersistentIntervalMap<K, T>::do_overlapping(const interval_type& in) const {
+
+            if (empty() || in.empty()) {
+                return {0, 0};
+            }
+
+            auto i = tree_.partition_point([&in] (const value_type& x) { return in.order(x.first) >= Order::b_touches_a; });
+            auto j = tree_.partition_point([&in] (const value_type& x) { return in.order(x.first) > Order::a_touches_b; });
+
+            return {i, j};
+
+        }
+
+}
+
+template <RS::Interval::IntervalCompatible K, std::regular T>
+requires (std::formattable<K, char> && std::formattable<T, char>)
+struct std::formatter<RS::Interval::PersistentIntervalMap<K, T>> {
+
+    std::formatter<RS::Interval::Interval<K>> key_interval_formatter;
+    std::formatter<T> value_formatter;
+
+    constexpr auto parse(std::format_parse_context& ctx) {
+        return ctx.begin();
+    }
+
+    template <typename FormatContext>
+    auto format(const RS::Interval::PersistentIntervalMap<K, T>& map, FormatContext& ctx) const {
+
+        auto out = ctx.out();
+        *out++ = '{';
+
+        if (! map.empty()) {
+
+            auto in = map.begin();
+            auto end = map.end();
+            out = key_interval_formatter.format(in->first, ctx);
+            *out++ = ':';
+            out = value_formatter.format(in->second, ctx);
+            ++in;
+
+            while (in != end) {
+                *out++ = ',';
+                out = key_interval_formatter.format(in->first, ctx);
+                *out++ = ':';
+                out = value_formatter.format(in->second, ctx);
+                ++in;
+            }
+
+        }
+
+        *out++ = '}';
+
+        return out;
+
+    }
+
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "rs-interval/interval.hpp"
+#include "rs-interval/persistent-tree.hpp"
+#include "rs-interval/set-algorithms.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <initializer_list>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    // Persistent interval set
+
+    template <IntervalCompatible T>
+    class PersistentIntervalSet {
+
+    public:
+
+        using iterator = typename Detail::PersistentTree<Interval<T>>::iterator;
+        using interval_type = Interval<T>;
+        using value_type = T;
+
+        static constexpr auto category = interval_category<T>;
+
+        PersistentIntervalSet() = default;
+        PersistentIntervalSet(const T& t): tree_(std::vector{interval_type(t)}) {}
+        PersistentIntervalSet(const interval_type& in): PersistentIntervalSet(&in, &in + 1) {}
+        PersistentIntervalSet(std::initializer_list<interval_type> list): PersistentIntervalSet(list.begin(), list.end()) {}
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, Interval<T>>
+        PersistentIntervalSet(I first, S last): tree_(Detail::collect_intervals<T>(first, last)) {}
+        explicit PersistentIntervalSet(const IntervalSet<T>& set): tree_(std::vector<interval_type>(set.begin(), set.end())) {}
+
+        bool operator[](const T& t) const { return contains(t); }
+
+        iterator begin() const { return tree_.begin(); }
+        iterator end() const noexcept { return tree_.end(); }
+        bool empty() const noexcept { return tree_.empty(); }
+        std::size_t size() const noexcept { return tree_.size(); }
+        bool contains(const T& t) const;
+        std::ranges::subrange<iterator> overlapping(const interval_type& in) const;
+        std::size_t count_overlapping(const interval_type& in) const;
+        iterator nth(std::size_t i) const { return tree_.nth(i); }
+        std::size_t rank(const T& t) const;
+        PersistentIntervalSet insert(const interval_type& in) const;
+        PersistentIntervalSet erase(const interval_type& in) const;
+        IntervalSet<T> to_set() const { return IntervalSet<T>(begin(), end()); }
+
+        friend bool operator==(const PersistentIntervalSet& a, const PersistentIntervalSet& b) {
+            return a.tree_.shares_root(b.tree_) || std::ranges::equal(a, b);
+        }
+
+    private:
+
+        // Every version holds a pointer to the root of a shared tree. An
+        // update builds a new root, copying only the nodes on the paths to
+        // the intervals it replaces.
+
+        Detail::PersistentTree<Interval<T>> tree_;
+
+        explicit PersistentIntervalSet(Detail::PersistentTree<Interval<T>>&& tree): tree_(std::move(tree)) {}
+
+        std::pair<std::size_t, std::size_t> do_overlapping(const interval_type& in) const;
+
+    };
+
+        template <IntervalCompatible T>
+        bool PersistentIntervalSet<T>::contains(const T& t) const {
+            auto i = rank(t);
+            return i < size() && tree_[i].match(t) == Match::ok;
+        }
+
+        template <IntervalCompatible T>
+        std::ranges::subrange<typename PersistentIntervalSet<T>::iterator>
+        PersistentIntervalSet<T>::overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return {tree_.nth(i), tree_.nth(j)};
+        }
+
+        template <IntervalCompatible T>
+        std::size_t PersistentIntervalSet<T>::count_overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return j - i;
+        }
+
+        template <IntervalCompatible T>
+        std::size_t PersistentIntervalSet<T>::rank(const T& t) const {
+            return tree_.partition_point([&t] (const interval_type& x) { return x.match(t) == Match::high; });
+        }
+
+        template <IntervalCompatible T>
+        PersistentIntervalSet<T> PersistentIntervalSet<T>::insert(const interval_type& in) const {
+
+            if (in.empty()) {
+                return *this;
+            }
+
+            // [i,j) is the run of intervals that touch or overlap the new one
+
+            auto i = tree_.partition_point([&in] (const interval_type& x) { return in.order(x) > Order::b_touches_a; });
+            auto j = tree_.partition_point([&in] (const interval_type& x) { return in.order(x) > Order::a_below_b; });
+            auto add = in;
+
+            if (i < j) {
+                add = add.envelope(tree_[i]).envelope(tree_[j - 1]);
+                if (j - i == 1 && add == tree_[i]) {
+                    return *this;
+                }
+            }
+
+            return PersistentIntervalSet(tree_.replace(i, j, {add}));
+
+        }
+
+        template <IntervalCompatible T>
+        PersistentIntervalSet<T> PersistentIntervalSet<T>::erase(const interval_type& in) const {
+
+            auto [i,j] = do_overlapping(in);
+
+            if (i == j) {
+                return *this;
+            }
+
+            // Only the first and last intervals in the run can survive in part
+
+            auto lower = Detail::lower_remainder(tree_[i], in);
+            auto upper = Detail::upper_remainder(tree_[j - 1], in);
+            std::vector<interval_type> rest;
+
+            for (auto& x: {lower, upper}) {
+                if (! x.empty()) {
+                    rest.push_back(x);
+                }
+            }
+
+            return PersistentIntervalSet(tree_.replace(i, j, std::move(rest)));
+
+        }
+
+        template <IntervalCompatible T>
+        std::pair<std::size_t, std::size_t> PersistentIntervalSet<T>::do_overlapping(const interval_type& in) const {
+
+            if (empty() || in.empty()) {
+                return {0, 0};
+            }
+
+            auto i = tree_.partition_point([&in] (const interval_type& x) { return in.order(x) >= Order::b_touches_a; });
+            auto j = tree_.partition_point([&in] (const interval_type& x) { return in.order(x) > Order::a_touches_b; });
+
+            return {i, j};
+
+        }
+
+}
+
+template <RS::Interval::IntervalCompatible T>
+requires (std::formattable<T, char>)
+struct std::formatter<RS::Interval::PersistentIntervalSet<T>>:
+std::formatter<RS::Interval::Interval<T>> {
+
+    template <typename FormatContext>
+    auto format(const RS::Interval::PersistentIntervalSet<T>& set, FormatContext& ctx) const {
+
+        using base = std::formatter<RS::Interval::Interval<T>>;
+
+        auto out = ctx.out();
+        *out++ = '{';
+
+        if (! set.empty()) {
+            auto in = set.begin();
+            auto end = set.end();
+            out = base::format(*in++, ctx);
+            while (in != end) {
+                *out++ = ',';
+                out = base::format(*in++, ctx);
+            }
+        }
+
+        *out++ = '}';
+
+        return out;
+
+    }
+
+};
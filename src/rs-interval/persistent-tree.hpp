@@ -0,0 +1,309 @@
+// This header is private to the implementation and should not be included by users
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Persistent treap of entries in sorted order, indexed by position.
+        // Nodes are immutable once built and shared between every version
+        // that contains them; an update copies only the nodes on the paths
+        // it touches. Priorities come from a counter carried by each version
+        // and scrambled by a mixing function, so that deriving new versions
+        // needs no shared random state.
+
+        template <typename E>
+        class PersistentTree {
+
+        private:
+
+            struct node;
+
+            using node_ptr = std::shared_ptr<const node>;
+
+            struct node {
+                E entry;
+                std::uint64_t priority = 0;
+                std::size_t count = 1;
+                node_ptr left;
+                node_ptr right;
+            };
+
+        public:
+
+            class iterator;
+
+            PersistentTree() = default;
+            explicit PersistentTree(std::vector<E>&& sorted);
+
+            iterator begin() const { return nth(0); }
+            iterator end() const noexcept { return {}; }
+            bool empty() const noexcept { return ! root_; }
+            std::size_t size() const noexcept { return count(root_); }
+            const E& operator[](std::size_t i) const noexcept;
+            iterator nth(std::size_t i) const;
+            template <typename P> std::size_t partition_point(P pred) const;
+            PersistentTree replace(std::size_t i, std::size_t j, std::vector<E>&& entries) const;
+            bool shares_root(const PersistentTree& t) const noexcept { return root_ == t.root_; }
+
+        private:
+
+            node_ptr root_;
+            std::uint64_t seed_ = 0;
+
+            std::uint64_t next_priority() noexcept;
+            static std::size_t count(const node_ptr& n) noexcept { return n ? n->count : 0; }
+            static node_ptr make_node(const E& entry, std::uint64_t priority, node_ptr left, node_ptr right);
+            static node_ptr merge(const node_ptr& a, const node_ptr& b);
+            static std::pair<node_ptr, node_ptr> split(const node_ptr& n, std::size_t k);
+
+        };
+
+            template <typename E>
+            class PersistentTree<E>::iterator {
+
+            public:
+
+                using difference_type = std::ptrdiff_t;
+                using iterator_category = std::forward_iterator_tag;
+                using pointer = const E*;
+                using reference = const E&;
+                using value_type = E;
+
+                iterator() = default;
+
+                reference operator*() const noexcept { return path_.back()->entry; }
+                pointer operator->() const noexcept { return &**this; }
+                iterator& operator++();
+                iterator operator++(int) { auto i = *this; ++*this; return i; }
+
+                friend bool operator==(const iterator& i, const iterator& j) noexcept {
+                    return i.path_.empty() || j.path_.empty() ? i.path_.empty() == j.path_.empty() : i.path_.back() == j.path_.back();
+                }
+
+            private:
+
+                friend class PersistentTree;
+
+                // The current node is last, preceded by the ancestors whose
+                // entries have not yet been visited
+
+                std::vector<const node*> path_;
+
+            };
+
+            template <typename E>
+            typename PersistentTree<E>::iterator& PersistentTree<E>::iterator::operator++() {
+                auto x = path_.back();
+                path_.pop_back();
+                for (auto y = x->right.get(); y; y = y->left.get()) {
+                    path_.push_back(y);
+                }
+                return *this;
+            }
+
+            template <typename E>
+            PersistentTree<E>::PersistentTree(std::vector<E>&& sorted) {
+
+                // Build a Cartesian tree in linear time. Each node's subtree
+                // covers the entries between the nearest higher priorities on
+                // either side, so its size is known when it leaves the stack.
+
+                std::vector<std::pair<std::shared_ptr<node>, std::size_t>> stack;
+                auto n = sorted.size();
+
+                for (std::size_t i = 0; i < n; ++i) {
+
+                    auto x = std::make_shared<node>();
+                    x->entry = std::move(sorted[i]);
+                    x->priority = next_priority();
+                    std::shared_ptr<node> last;
+                    auto start = i;
+
+                    while (! stack.empty() && stack.back().first->priority < x->priority) {
+                        last = std::move(stack.back().first);
+                        start = stack.back().second;
+                        last->count = i - start;
+                        stack.pop_back();
+                    }
+
+                    x->left = std::move(last);
+
+                    if (! stack.empty()) {
+                        stack.back().first->right = x;
+                    }
+
+                    stack.push_back({std::move(x), start});
+
+                }
+
+                for (auto& [x,start]: stack) {
+                    x->count = n - start;
+                }
+
+                if (! stack.empty()) {
+                    root_ = stack.front().first;
+                }
+
+            }
+
+            template <typename E>
+            const E& PersistentTree<E>::operator[](std::size_t i) const noexcept {
+
+                auto x = root_.get();
+
+                for (;;) {
+                    auto k = count(x->left);
+                    if (i < k) {
+                        x = x->left.get();
+                    } else if (i == k) {
+                        return x->entry;
+                    } else {
+                        i -= k + 1;
+                        x = x->right.get();
+                    }
+                }
+
+            }
+
+            template <typename E>
+            typename PersistentTree<E>::iterator PersistentTree<E>::nth(std::size_t i) const {
+
+                iterator it;
+
+                if (i >= size()) {
+                    return it;
+                }
+
+                auto x = root_.get();
+
+                for (;;) {
+                    auto k = count(x->left);
+                    if (i < k) {
+                        it.path_.push_back(x);
+                        x = x->left.get();
+                    } else if (i == k) {
+                        it.path_.push_back(x);
+                        return it;
+                    } else {
+                        i -= k + 1;
+                        x = x->right.get();
+                    }
+                }
+
+            }
+
+            template <typename E>
+            template <typename P>
+            std::size_t PersistentTree<E>::partition_point(P pred) const {
+
+                // The number of leading entries that satisfy the predicate,
+                // which must be true for a prefix of the entries and false
+                // for the rest
+
+                std::size_t k = 0;
+
+                for (auto x = root_.get(); x;) {
+                    if (pred(x->entry)) {
+                        k += count(x->left) + 1;
+                        x = x->right.get();
+                    } else {
+                        x = x->left.get();
+                    }
+                }
+
+                return k;
+
+            }
+
+            template <typename E>
+            PersistentTree<E> PersistentTree<E>::replace(std::size_t i, std::size_t j, std::vector<E>&& entries) const {
+
+                // Replace the entries in [i,j) with the new ones, which must
+                // fit in the same place in the order
+
+                PersistentTree result;
+                result.seed_ = seed_;
+                auto [lower, rest] = split(root_, i);
+                auto upper = split(rest, j - i).second;
+                node_ptr middle;
+
+                for (auto& entry: entries) {
+                    middle = merge(middle, make_node(entry, result.next_priority(), {}, {}));
+                }
+
+                result.root_ = merge(merge(lower, middle), upper);
+
+                return result;
+
+            }
+
+            template <typename E>
+            std::uint64_t PersistentTree<E>::next_priority() noexcept {
+
+                // SplitMix64
+
+                auto x = seed_ += 0x9e37'79b9'7f4a'7c15ull;
+                x = (x ^ (x >> 30)) * 0xbf58'476d'1ce4'e5b9ull;
+                x = (x ^ (x >> 27)) * 0x94d0'49bb'1331'11ebull;
+
+                return x ^ (x >> 31);
+
+            }
+
+            template <typename E>
+            typename PersistentTree<E>::node_ptr PersistentTree<E>::make_node(const E& entry, std::uint64_t priority,
+                    node_ptr left, node_ptr right) {
+                auto n = count(left) + count(right) + 1;
+                return std::make_shared<const node>(entry, priority, n, std::move(left), std::move(right));
+            }
+
+            template <typename E>
+            typename PersistentTree<E>::node_ptr PersistentTree<E>::merge(const node_ptr& a, const node_ptr& b) {
+                if (! a) {
+                    return b;
+                } else if (! b) {
+                    return a;
+                } else if (a->priority > b->priority) {
+                    return make_node(a->entry, a->priority, a->left, merge(a->right, b));
+                } else {
+                    return make_node(b->entry, b->priority, merge(a, b->left), b->right);
+                }
+            }
+
+            template <typename E>
+            std::pair<typename PersistentTree<E>::node_ptr, typename PersistentTree<E>::node_ptr>
+            PersistentTree<E>::split(const node_ptr& n, std::size_t k) {
+
+                // Split into the first k entries and the rest. A subtree that
+                // falls entirely on one side is shared, not copied.
+
+                if (k == 0) {
+                    return {{}, n};
+                } else if (k >= count(n)) {
+                    return {n, {}};
+                }
+
+                auto left_count = count(n->left);
+
+                if (k <= left_count) {
+                    auto [l, r] = split(n->left, k);
+                    return {l, make_node(n->entry, n->priority, r, n->right)};
+                } else {
+                    auto [l, r] = split(n->right, k - left_count - 1);
+                    return {make_node(n->entry, n->priority, n->left, l), r};
+                }
+
+            }
+
+    }
+
+}
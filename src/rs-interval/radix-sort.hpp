@@ -0,0 +1,177 @@
+// This header is private to the implementation and should not be included by users
+
+#pragma once
+
+#include "rs-interval/interval.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Sorting of intervals by lower boundary, for bulk construction of
+        // the interval containers. For primitive integer and floating point
+        // types this uses an LSD radix sort on an order preserving unsigned
+        // encoding of the boundary value, preceded by a counting pass on the
+        // bound type; otherwise it falls back on a comparison sort. Both
+        // paths are stable.
+
+        template <typename T>
+        concept RadixSortable = (std::integral<T> && ! std::same_as<T, bool>)
+            || std::same_as<T, float> || std::same_as<T, double>;
+
+        template <RadixSortable T>
+        auto radix_key(T t) noexcept {
+
+            if constexpr (std::integral<T>) {
+
+                using U = std::make_unsigned_t<T>;
+                auto u = static_cast<U>(t);
+
+                if constexpr (std::signed_integral<T>) {
+                    u ^= static_cast<U>(U(1) << (8 * sizeof(T) - 1));
+                }
+
+                return u;
+
+            } else {
+
+                // Negative values have all bits flipped, positive values
+                // only the sign bit. Negative zero is mapped to positive
+                // zero so that equal values have equal keys.
+
+                using U = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+                static constexpr U sign = U(1) << (8 * sizeof(T) - 1);
+                auto u = std::bit_cast<U>(t == T(0) ? T(0) : t);
+
+                return (u & sign) ? U(~ u) : U(u | sign);
+
+            }
+
+        }
+
+        // Rank of the lower boundary type at equal key: an unbounded
+        // boundary is given key zero and sorts before anything else, and a
+        // closed boundary lies just before its value, an open one just after
+
+        template <IntervalCompatible T>
+        std::size_t lower_bound_rank(const Interval<T>& in) noexcept {
+            if (! in.is_left_bounded()) {
+                return 0;
+            } else if (in.is_left_open()) {
+                return 2;
+            } else {
+                return 1;
+            }
+        }
+
+        template <typename E, typename Proj>
+        void radix_sort_by_lower(std::vector<E>& vec, Proj proj) {
+
+            using T = typename std::remove_cvref_t<decltype(proj(vec.front()))>::value_type;
+            using U = decltype(radix_key(T()));
+
+            static constexpr std::size_t bytes = sizeof(U);
+
+            auto key_of = [&proj] (const E& e) {
+                const auto& in = proj(e);
+                return in.is_left_bounded() ? radix_key(in.min()) : U(0);
+            };
+
+            // Build every histogram in a single read pass, so that each
+            // scatter pass is a pure sequential read and bucketed write
+
+            std::array<std::size_t, 3> bound_count {};
+            std::vector<std::array<std::size_t, 256>> byte_count(bytes);
+
+            for (const auto& e: vec) {
+                ++bound_count[lower_bound_rank(proj(e))];
+                auto key = key_of(e);
+                for (std::size_t b = 0; b < bytes; ++b) {
+                    ++byte_count[b][(key >> (8 * b)) & 0xff];
+                }
+            }
+
+            auto n = vec.size();
+            std::vector<E> buffer(n);
+
+            auto trivial = [n] (const auto& count) {
+                return std::ranges::find(count, n) != count.end();
+            };
+
+            auto scatter = [&vec, &buffer] (auto& count, auto bucket_of) {
+                std::size_t offset = 0;
+                for (auto& c: count) {
+                    offset += std::exchange(c, offset);
+                }
+                for (auto& e: vec) {
+                    buffer[count[bucket_of(e)]++] = std::move(e);
+                }
+                vec.swap(buffer);
+            };
+
+            if (! trivial(bound_count)) {
+                scatter(bound_count, [&proj] (const E& e) { return lower_bound_rank(proj(e)); });
+            }
+
+            for (std::size_t b = 0; b < bytes; ++b) {
+                if (! trivial(byte_count[b])) {
+                    scatter(byte_count[b], [&key_of,b] (const E& e) {
+                        return static_cast<std::size_t>((key_of(e) >> (8 * b)) & 0xff);
+                    });
+                }
+            }
+
+        }
+
+        // Sort a vector of intervals, or of objects containing intervals
+        // (selected by the projection), into ascending order of lower
+        // boundary. The relative order of elements with the same lower
+        // boundary is preserved.
+
+        template <typename E, typename Proj>
+        void sort_by_lower(std::vector<E>& vec, Proj proj) {
+
+            using T = typename std::remove_cvref_t<decltype(proj(vec.front()))>::value_type;
+
+            // Below this size the counting passes cost more than they save
+
+            static constexpr std::size_t radix_threshold = 256;
+
+            if constexpr (RadixSortable<T>) {
+                if (vec.size() >= radix_threshold) {
+                    radix_sort_by_lower(vec, proj);
+                    return;
+                }
+            }
+
+            std::stable_sort(vec.begin(), vec.end(), [&proj] (const E& a, const E& b) {
+                const auto& ia = proj(a);
+                const auto& ib = proj(b);
+                if (! ib.is_left_bounded()) {
+                    return false;
+                } else if (! ia.is_left_bounded()) {
+                    return true;
+                } else if (ia.min() < ib.min()) {
+                    return true;
+                } else if (ib.min() < ia.min()) {
+                    return false;
+                } else {
+                    return ia.is_left_closed() && ib.is_left_open();
+                }
+            });
+
+        }
+
+    }
+
+}
@@ -0,0 +1,678 @@
+// This header is private to the implementation and should not be included by users
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Mutable treap of entries in sorted order, with the parts of the
+        // std::set and std::map interfaces that the node-based containers
+        // use, plus access by position. Entries are ordered by key, which is
+        // the entry itself for a set, or its first member for a map. Each
+        // node records the size of its subtree. Nodes are allocated one at a
+        // time and linked to their parents; the root hangs from a header
+        // node, allocated separately, that marks the end of the sequence, so
+        // iterators stay valid until their own entry is erased, even when
+        // the tree is moved or swapped. Only a moved-from tree lacks a
+        // header, and allocates a new one when it is next modified.
+
+        // If a weighing function is supplied, each node also records the
+        // total weight of its subtree, so that the weight of all the entries
+        // before a position can be found in logarithmic time. The weight
+        // type needs a default value of zero and a += operator, and the
+        // weighing function must not throw.
+
+        template <typename W, typename E>
+        struct RankedTreeWeight {
+            using type = std::remove_cvref_t<std::invoke_result_t<const W&, const E&>>;
+        };
+
+        template <typename E>
+        struct RankedTreeWeight<void, E> {
+            struct type {};
+        };
+
+        template <typename E, typename K = E, typename W = void>
+        class RankedTree {
+
+        private:
+
+            using weight_type = typename RankedTreeWeight<W, E>::type;
+
+            static constexpr bool weighted = ! std::same_as<W, void>;
+
+            struct node_base {
+                node_base* parent = nullptr;
+                node_base* left = nullptr;
+                node_base* right = nullptr;
+                std::size_t count = 0;
+                [[no_unique_address]] weight_type weight {};
+            };
+
+            struct node: node_base {
+                E entry;
+                std::uint_fast32_t priority = 0;
+                template <typename... Args> explicit node(Args&&... args): entry(std::forward<Args>(args)...) {}
+            };
+
+        public:
+
+            class iterator;
+            class node_type;
+
+            using key_type = K;
+            using value_type = E;
+
+            RankedTree() = default;
+            explicit RankedTree(std::vector<E>&& sorted);
+            RankedTree(const RankedTree& t);
+            RankedTree(RankedTree&& t) noexcept: header_() { swap(t); }
+            ~RankedTree() noexcept { clear(); }
+            RankedTree& operator=(const RankedTree& t);
+            RankedTree& operator=(RankedTree&& t) noexcept { RankedTree temp(std::move(t)); swap(temp); return *this; }
+
+            iterator begin() const noexcept { return first_ ? iterator(first_) : end(); }
+            iterator end() const noexcept { return iterator(header_.get()); }
+            bool empty() const noexcept { return first_ == nullptr; }
+            std::size_t size() const noexcept { return header_ ? count(header_->left) : 0; }
+            iterator lower_bound(const K& key) const;
+            iterator upper_bound(const K& key) const;
+            template <typename P> iterator partition_point(P pred) const;
+            iterator nth(std::size_t i) const noexcept;
+            std::size_t position(iterator i) const noexcept;
+            weight_type weight_before(iterator i) const requires weighted;
+            iterator insert(const E& entry) { return insert(upper_bound(key_of(entry)), entry); }
+            iterator insert(E&& entry) { auto hint = upper_bound(key_of(entry)); return insert(hint, std::move(entry)); }
+            iterator insert(iterator hint, const E& entry) { return insert_node(new node(entry), hint); }
+            iterator insert(iterator hint, E&& entry) { return insert_node(new node(std::move(entry)), hint); }
+            iterator insert(iterator hint, node_type&& nh);
+            template <typename... Args> iterator emplace_hint(iterator hint, Args&&... args);
+            node_type extract(iterator i) noexcept;
+            iterator erase(iterator i) noexcept;
+            iterator erase(iterator i, iterator j) noexcept;
+            void clear() noexcept;
+            void swap(RankedTree& t) noexcept;
+
+        private:
+
+            std::unique_ptr<node_base> header_ = std::make_unique<node_base>();
+            node_base* first_ = nullptr;
+            std::minstd_rand rng_;
+
+            node_base* header();
+            node_base* root() const noexcept { return header_ ? header_->left : nullptr; }
+            iterator insert_node(node* x, iterator hint);
+            void detach(node_base* x) noexcept;
+            void pull_up(node_base* n) noexcept;
+            void rotate_up(node_base* x) noexcept;
+            void pull_all(node_base* n) noexcept;
+
+            static const K& key_of(const E& entry) noexcept;
+            static const E& entry_of(const node_base* n) noexcept { return static_cast<const node*>(n)->entry; }
+            static std::uint_fast32_t priority_of(const node_base* n) noexcept { return static_cast<const node*>(n)->priority; }
+            static std::size_t count(const node_base* n) noexcept { return n ? n->count : 0; }
+            static void pull(node_base* n) noexcept;
+            static node_base* leftmost(node_base* n) noexcept;
+            static node_base* rightmost(node_base* n) noexcept;
+            static const node_base* next_node(const node_base* n) noexcept;
+            static const node_base* prev_node(const node_base* n) noexcept;
+            static void replace_child(node_base* parent, node_base* old_child, node_base* new_child) noexcept;
+            static node_base* clone(const node_base* n, node_base* parent);
+            static void destroy(node_base* n) noexcept;
+
+        };
+
+            template <typename E, typename K, typename W>
+            class RankedTree<E, K, W>::iterator {
+
+            public:
+
+                using difference_type = std::ptrdiff_t;
+                using iterator_category = std::bidirectional_iterator_tag;
+                using pointer = const E*;
+                using reference = const E&;
+                using value_type = E;
+
+                iterator() = default;
+
+                reference operator*() const noexcept { return entry_of(node_); }
+                pointer operator->() const noexcept { return &**this; }
+                iterator& operator++() noexcept { node_ = next_node(node_); return *this; }
+                iterator operator++(int) noexcept { auto i = *this; ++*this; return i; }
+                iterator& operator--() noexcept { node_ = prev_node(node_); return *this; }
+                iterator operator--(int) noexcept { auto i = *this; --*this; return i; }
+
+                friend bool operator==(const iterator& i, const iterator& j) noexcept { return i.node_ == j.node_; }
+
+            private:
+
+                friend class RankedTree;
+
+                const node_base* node_ = nullptr;
+
+                explicit iterator(const node_base* n) noexcept: node_(n) {}
+
+            };
+
+            template <typename E, typename K, typename W>
+            class RankedTree<E, K, W>::node_type {
+
+            public:
+
+                node_type() = default;
+                node_type(node_type&& nh) noexcept: node_(std::exchange(nh.node_, nullptr)) {}
+                ~node_type() noexcept { delete node_; }
+                node_type& operator=(node_type&& nh) noexcept { std::swap(node_, nh.node_); return *this; }
+
+                explicit operator bool() const noexcept { return node_ != nullptr; }
+
+                bool empty() const noexcept { return node_ == nullptr; }
+                E& value() const noexcept { return node_->entry; }
+                auto& key() const noexcept requires (! std::same_as<E, K>) { return node_->entry.first; }
+                auto& mapped() const noexcept requires (! std::same_as<E, K>) { return node_->entry.second; }
+
+            private:
+
+                friend class RankedTree;
+
+                node* node_ = nullptr;
+
+                explicit node_type(node* n) noexcept: node_(n) {}
+
+            };
+
+            template <typename E, typename K, typename W>
+            RankedTree<E, K, W>::RankedTree(std::vector<E>&& sorted) {
+
+                // Build the treap from the sorted entries in linear time,
+                // using the right spine as a stack
+
+                std::vector<node_base*> spine;
+
+                for (auto& entry: sorted) {
+
+                    auto x = new node(std::move(entry));
+                    x->priority = rng_();
+                    node_base* last = nullptr;
+
+                    while (! spine.empty() && priority_of(spine.back()) < x->priority) {
+                        last = spine.back();
+                        spine.pop_back();
+                    }
+
+                    x->left = last;
+
+                    if (last) {
+                        last->parent = x;
+                    }
+
+                    if (! spine.empty()) {
+                        spine.back()->right = x;
+                        x->parent = spine.back();
+                    }
+
+                    spine.push_back(x);
+
+                }
+
+                if (! spine.empty()) {
+                    auto h = header();
+                    h->left = spine.front();
+                    h->left->parent = h;
+                    first_ = leftmost(h->left);
+                    pull_all(h->left);
+                }
+
+            }
+
+            template <typename E, typename K, typename W>
+            RankedTree<E, K, W>::RankedTree(const RankedTree& t):
+            rng_(t.rng_) {
+                if (! t.empty()) {
+                    auto h = header();
+                    h->left = clone(t.root(), h);
+                    first_ = leftmost(h->left);
+                }
+            }
+
+            template <typename E, typename K, typename W>
+            RankedTree<E, K, W>& RankedTree<E, K, W>::operator=(const RankedTree& t) {
+                if (&t != this) {
+                    RankedTree temp(t);
+                    swap(temp);
+                }
+                return *this;
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::lower_bound(const K& key) const {
+                return partition_point([&key] (const E& entry) { return key_of(entry) < key; });
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::upper_bound(const K& key) const {
+                return partition_point([&key] (const E& entry) { return ! (key < key_of(entry)); });
+            }
+
+            template <typename E, typename K, typename W>
+            template <typename P>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::partition_point(P pred) const {
+
+                // The first entry that does not satisfy the predicate, which
+                // must be true for a prefix of the entries and false for the
+                // rest
+
+                auto result = end();
+
+                for (const node_base* x = root(); x;) {
+                    if (pred(entry_of(x))) {
+                        x = x->right;
+                    } else {
+                        result.node_ = x;
+                        x = x->left;
+                    }
+                }
+
+                return result;
+
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::nth(std::size_t i) const noexcept {
+
+                if (i >= size()) {
+                    return end();
+                }
+
+                const node_base* x = root();
+
+                for (;;) {
+                    auto k = count(x->left);
+                    if (i < k) {
+                        x = x->left;
+                    } else if (i == k) {
+                        return iterator(x);
+                    } else {
+                        i -= k + 1;
+                        x = x->right;
+                    }
+                }
+
+            }
+
+            template <typename E, typename K, typename W>
+            std::size_t RankedTree<E, K, W>::position(iterator i) const noexcept {
+
+                // Count the entries in the left subtree, and in the left
+                // subtree of every ancestor reached from the right, along
+                // with the ancestor itself
+
+                auto x = i.node_;
+
+                if (x == nullptr || x == header_.get()) {
+                    return size();
+                }
+
+                auto k = count(x->left);
+
+                for (auto p = x->parent; p != header_.get(); x = p, p = p->parent) {
+                    if (p->right == x) {
+                        k += count(p->left) + 1;
+                    }
+                }
+
+                return k;
+
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::weight_type RankedTree<E, K, W>::weight_before(iterator i) const requires weighted {
+
+                // Add up the same subtrees and ancestors as position()
+
+                auto x = i.node_;
+
+                if (x == nullptr || x == header_.get()) {
+                    return root() ? root()->weight : weight_type{};
+                }
+
+                auto w = x->left ? x->left->weight : weight_type{};
+
+                for (auto p = x->parent; p != header_.get(); x = p, p = p->parent) {
+                    if (p->right == x) {
+                        if (p->left) {
+                            w += p->left->weight;
+                        }
+                        w += W()(entry_of(p));
+                    }
+                }
+
+                return w;
+
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::insert(iterator hint, node_type&& nh) {
+                if (! nh) {
+                    return end();
+                }
+                return insert_node(std::exchange(nh.node_, nullptr), hint);
+            }
+
+            template <typename E, typename K, typename W>
+            template <typename... Args>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::emplace_hint(iterator hint, Args&&... args) {
+                return insert_node(new node(std::forward<Args>(args)...), hint);
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::node_type RankedTree<E, K, W>::extract(iterator i) noexcept {
+                auto x = const_cast<node_base*>(i.node_);
+                detach(x);
+                return node_type(static_cast<node*>(x));
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::erase(iterator i) noexcept {
+                auto next = std::next(i);
+                auto x = const_cast<node_base*>(i.node_);
+                detach(x);
+                delete static_cast<node*>(x);
+                return next;
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::erase(iterator i, iterator j) noexcept {
+                while (i != j) {
+                    i = erase(i);
+                }
+                return j;
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::clear() noexcept {
+                if (header_) {
+                    destroy(header_->left);
+                    header_->left = nullptr;
+                }
+                first_ = nullptr;
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::swap(RankedTree& t) noexcept {
+                header_.swap(t.header_);
+                std::swap(first_, t.first_);
+                std::swap(rng_, t.rng_);
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::node_base* RankedTree<E, K, W>::header() {
+                if (! header_) {
+                    header_ = std::make_unique<node_base>();
+                }
+                return header_.get();
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::iterator RankedTree<E, K, W>::insert_node(node* x, iterator hint) {
+
+                // The new entry belongs immediately before the hint. If it
+                // does not, the position is found by searching from the root.
+
+                std::unique_ptr<node> guard(x);
+                auto h = header();
+                auto& key = key_of(x->entry);
+
+                if (hint.node_ == nullptr
+                        || (hint.node_ != h && ! (key < key_of(entry_of(hint.node_))))
+                        || (hint != begin() && ! (key_of(*std::prev(hint)) < key))) {
+                    hint = upper_bound(key);
+                }
+
+                // Add it as a leaf, then rotate it up until the heap order is
+                // restored
+
+                auto pos = const_cast<node_base*>(hint.node_ ? hint.node_ : h);
+                guard.release();
+                x->parent = x->left = x->right = nullptr;
+                x->priority = rng_();
+
+                if (h->left == nullptr) {
+                    h->left = x;
+                    x->parent = h;
+                } else if (pos->left == nullptr) {
+                    pos->left = x;
+                    x->parent = pos;
+                } else {
+                    auto p = rightmost(pos->left);
+                    p->right = x;
+                    x->parent = p;
+                }
+
+                if (first_ == nullptr || pos == first_) {
+                    first_ = x;
+                }
+
+                pull_up(x);
+
+                while (x->parent != h && priority_of(x->parent) < x->priority) {
+                    rotate_up(x);
+                }
+
+                return iterator(x);
+
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::detach(node_base* x) noexcept {
+
+                if (x == first_) {
+                    auto next = next_node(x);
+                    first_ = next == header_.get() ? nullptr : const_cast<node_base*>(next);
+                }
+
+                // Rotate the node down until it is a leaf, then unlink it and
+                // recount its former ancestors
+
+                while (x->left || x->right) {
+                    auto c = x->left == nullptr ? x->right
+                        : x->right == nullptr ? x->left
+                        : priority_of(x->left) > priority_of(x->right) ? x->left : x->right;
+                    rotate_up(c);
+                }
+
+                auto p = x->parent;
+                replace_child(p, x, nullptr);
+                pull_up(p);
+
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::pull_up(node_base* n) noexcept {
+                for (; n != header_.get(); n = n->parent) {
+                    pull(n);
+                }
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::pull(node_base* n) noexcept {
+
+                n->count = count(n->left) + count(n->right) + 1;
+
+                if constexpr (weighted) {
+                    auto w = n->left ? n->left->weight : weight_type{};
+                    w += W()(entry_of(n));
+                    if (n->right) {
+                        w += n->right->weight;
+                    }
+                    n->weight = w;
+                }
+
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::rotate_up(node_base* x) noexcept {
+
+                // Rotate the node above its parent. The subtree keeps the
+                // same entries, so only the two nodes' counts and weights
+                // change.
+
+                auto p = x->parent;
+                auto g = p->parent;
+
+                if (p->left == x) {
+                    p->left = x->right;
+                    if (x->right) {
+                        x->right->parent = p;
+                    }
+                    x->right = p;
+                } else {
+                    p->right = x->left;
+                    if (x->left) {
+                        x->left->parent = p;
+                    }
+                    x->left = p;
+                }
+
+                p->parent = x;
+                x->parent = g;
+                replace_child(g, p, x);
+                pull(p);
+                pull(x);
+
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::pull_all(node_base* n) noexcept {
+                if (n) {
+                    pull_all(n->left);
+                    pull_all(n->right);
+                    pull(n);
+                }
+            }
+
+            template <typename E, typename K, typename W>
+            const K& RankedTree<E, K, W>::key_of(const E& entry) noexcept {
+                if constexpr (std::same_as<E, K>) {
+                    return entry;
+                } else {
+                    return entry.first;
+                }
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::node_base* RankedTree<E, K, W>::leftmost(node_base* n) noexcept {
+                while (n->left) {
+                    n = n->left;
+                }
+                return n;
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::node_base* RankedTree<E, K, W>::rightmost(node_base* n) noexcept {
+                while (n->right) {
+                    n = n->right;
+                }
+                return n;
+            }
+
+            template <typename E, typename K, typename W>
+            const typename RankedTree<E, K, W>::node_base* RankedTree<E, K, W>::next_node(const node_base* n) noexcept {
+
+                // Climbing from the last node stops at the header, whose only
+                // child is on its left
+
+                if (n->right) {
+                    return leftmost(n->right);
+                }
+
+                auto p = n->parent;
+
+                while (p->right == n) {
+                    n = p;
+                    p = p->parent;
+                }
+
+                return p;
+
+            }
+
+            template <typename E, typename K, typename W>
+            const typename RankedTree<E, K, W>::node_base* RankedTree<E, K, W>::prev_node(const node_base* n) noexcept {
+
+                // Stepping back from the header finds the last node, since
+                // the root is its left child
+
+                if (n->left) {
+                    return rightmost(n->left);
+                }
+
+                auto p = n->parent;
+
+                while (p->left == n) {
+                    n = p;
+                    p = p->parent;
+                }
+
+                return p;
+
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::replace_child(node_base* parent, node_base* old_child, node_base* new_child) noexcept {
+                if (parent->left == old_child) {
+                    parent->left = new_child;
+                } else {
+                    parent->right = new_child;
+                }
+            }
+
+            template <typename E, typename K, typename W>
+            typename RankedTree<E, K, W>::node_base* RankedTree<E, K, W>::clone(const node_base* n, node_base* parent) {
+
+                if (n == nullptr) {
+                    return nullptr;
+                }
+
+                auto x = std::make_unique<node>(entry_of(n));
+                x->priority = priority_of(n);
+                x->count = n->count;
+                x->weight = n->weight;
+                x->parent = parent;
+
+                try {
+                    x->left = clone(n->left, x.get());
+                    x->right = clone(n->right, x.get());
+                }
+                catch (...) {
+                    destroy(x->left);
+                    throw;
+                }
+
+                return x.release();
+
+            }
+
+            template <typename E, typename K, typename W>
+            void RankedTree<E, K, W>::destroy(node_base* n) noexcept {
+                if (n) {
+                    destroy(n->left);
+                    destroy(n->right);
+                    delete static_cast<node*>(n);
+                }
+            }
+
+    }
+
+}
@@ -0,0 +1,703 @@
+#pragma once
+
+#include "rs-interval/flat-map.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/set-algorithms.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Sums are taken in the widest type with the signedness of the
+        // mapped type, so that negative values still sum correctly when the
+        // key type is unsigned. Floating point on either side gives a
+        // floating point sum.
+
+        template <Primitive K, Primitive T>
+        struct SegmentSum {
+            using type = std::conditional_t<std::signed_integral<T>, std::intmax_t, std::uintmax_t>;
+        };
+
+        template <Primitive K, Primitive T>
+        requires (std::floating_point<K> || std::floating_point<T>)
+        struct SegmentSum<K, T> {
+            using type = std::common_type_t<K, T, double>;
+        };
+
+    }
+
+    // Interval segment tree
+
+    template <Primitive K, Primitive T>
+    class IntervalSegmentTree {
+
+    public:
+
+        using key_type = K;
+        using mapped_type = T;
+        using interval_type = Interval<K>;
+        using sum_type = typename Detail::SegmentSum<K, T>::type;
+
+        static constexpr auto category = interval_category<K>;
+
+        IntervalSegmentTree(): IntervalSegmentTree(T()) {}
+        explicit IntervalSegmentTree(const T& defval);
+        template <CombinePolicy<T> C>
+        explicit IntervalSegmentTree(const IntervalMap<K, T, C>& map): def_(map.default_value()) { build(map.begin(), map.end()); }
+        explicit IntervalSegmentTree(const FlatIntervalMap<K, T>& map): def_(map.default_value()) { build(map.begin(), map.end()); }
+
+        T operator[](const K& key) const;
+
+        std::size_t size() const noexcept { return nodes_.size() - free_.size(); }
+        const T& default_value() const noexcept { return def_; }
+        void add(const Interval<K>& in, const T& delta);
+        sum_type sum(const Interval<K>& in) const;
+        T min(const Interval<K>& in) const;
+        T max(const Interval<K>& in) const;
+        IntervalMap<K, T> to_map() const;
+
+    private:
+
+        static constexpr std::size_t npos = ~ std::size_t(0);
+
+        // The tree is a treap of disjoint segments that together cover the
+        // whole domain, ordered by key and heap ordered by a random
+        // priority. Each node holds the minimum, maximum, sum, and measure
+        // of its subtree, and any pending addition that has not yet been
+        // passed on to its children. Unbounded segments are given a measure
+        // of zero; they never contribute to a sum, because sums are only
+        // taken over bounded intervals. Neighbouring segments never have
+        // the same value, so the number of segments tracks the current
+        // shape of the function rather than the number of additions.
+        // Nodes freed by merging segments are kept for reuse.
+
+        struct node {
+            Interval<K> key;
+            T value {};
+            T lazy {};
+            T low {};
+            T high {};
+            sum_type measure {};
+            sum_type total {};
+            std::uint_fast32_t priority = 0;
+            std::size_t left = npos;
+            std::size_t right = npos;
+        };
+
+        struct summary {
+            sum_type total {};
+            T low {};
+            T high {};
+            bool found = false;
+            void add(T lo, T hi, sum_type t);
+        };
+
+        std::vector<node> nodes_;
+        std::vector<std::size_t> free_;
+        std::size_t root_ = npos;
+        T def_ {};
+        std::minstd_rand rng_;
+
+        template <typename ForwardIterator> void build(ForwardIterator i, ForwardIterator j);
+        void apply(std::size_t n, T delta);
+        void push(std::size_t n);
+        void pull(std::size_t n);
+        void pull_all(std::size_t n);
+        void cut(const Interval<K>& in, bool lower);
+        void coalesce(const Detail::SweepPoint<K>& p);
+        std::size_t make_node(const Interval<K>& key, T value);
+        std::size_t insert(std::size_t n, std::size_t x);
+        std::size_t erase(std::size_t n, const Detail::SweepPoint<K>& p);
+        std::size_t join(std::size_t l, std::size_t r);
+        void refresh(std::size_t n, const Detail::SweepPoint<K>& p);
+        std::pair<std::size_t, std::size_t> split(std::size_t n, const Interval<K>& in);
+        void update(std::size_t n, const Interval<K>& in, bool lo_in, bool hi_in, T delta);
+        void collect(std::size_t n, const Interval<K>& in, bool lo_in, bool hi_in, T offset, summary& s) const;
+        void collect_entries(std::size_t n, T offset, std::vector<std::pair<Interval<K>, T>>& entries) const;
+        summary query(const Interval<K>& in) const;
+
+        static sum_type measure(const Interval<K>& in);
+        static bool is_below(Order ord) noexcept { return ord == Order::a_below_b || ord == Order::a_touches_b; }
+        static bool is_above(Order ord) noexcept { return ord == Order::b_below_a || ord == Order::b_touches_a; }
+
+    };
+
+        template <Primitive K, Primitive T>
+        IntervalSegmentTree<K, T>::IntervalSegmentTree(const T& defval):
+        def_(defval) {
+            std::vector<std::pair<Interval<K>, T>> none;
+            build(none.begin(), none.end());
+        }
+
+        template <Primitive K, Primitive T>
+        T IntervalSegmentTree<K, T>::operator[](const K& key) const {
+
+            auto n = root_;
+            T offset {};
+
+            // The segments cover the whole domain, so this only falls
+            // through for an unordered key such as a NaN
+
+            while (n != npos) {
+                auto& x = nodes_[n];
+                auto m = x.key.match(key);
+                if (m == Match::ok) {
+                    return T(x.value + offset);
+                }
+                offset = T(offset + x.lazy);
+                n = m == Match::low ? x.left : x.right;
+            }
+
+            return def_;
+
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::add(const Interval<K>& in, const T& delta) {
+
+            if (in.empty() || delta == T()) {
+                return;
+            }
+
+            // Split the segments that straddle either end of the interval,
+            // so that every segment is either entirely inside or entirely
+            // outside it
+
+            cut(in, true);
+            cut(in, false);
+            update(root_, in, false, false, delta);
+
+            // Only the segments meeting at the ends of the interval can now
+            // have the same value as their neighbours
+
+            coalesce(Detail::lower_point(in));
+            coalesce(Detail::upper_point(in));
+
+        }
+
+        template <Primitive K, Primitive T>
+        typename IntervalSegmentTree<K, T>::sum_type IntervalSegmentTree<K, T>::sum(const Interval<K>& in) const {
+            if (in.is_infinite()) {
+                throw std::invalid_argument("Sum over an unbounded interval");
+            }
+            return query(in).total;
+        }
+
+        template <Primitive K, Primitive T>
+        T IntervalSegmentTree<K, T>::min(const Interval<K>& in) const {
+            if (in.empty()) {
+                throw std::invalid_argument("Minimum over an empty interval");
+            }
+            return query(in).low;
+        }
+
+        template <Primitive K, Primitive T>
+        T IntervalSegmentTree<K, T>::max(const Interval<K>& in) const {
+            if (in.empty()) {
+                throw std::invalid_argument("Maximum over an empty interval");
+            }
+            return query(in).high;
+        }
+
+        template <Primitive K, Primitive T>
+        IntervalMap<K, T> IntervalSegmentTree<K, T>::to_map() const {
+            std::vector<std::pair<Interval<K>, T>> entries;
+            entries.reserve(size());
+            collect_entries(root_, T(), entries);
+            IntervalMap<K, T> map(def_);
+            map.assign(entries.begin(), entries.end());
+            return map;
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::summary::add(T lo, T hi, sum_type t) {
+            if (found) {
+                low = std::min(low, lo);
+                high = std::max(high, hi);
+            } else {
+                low = lo;
+                high = hi;
+                found = true;
+            }
+            total += t;
+        }
+
+        template <Primitive K, Primitive T>
+        template <typename ForwardIterator>
+        void IntervalSegmentTree<K, T>::build(ForwardIterator i, ForwardIterator j) {
+
+            // Fill the gaps between the map's intervals with the default
+            // value, joining neighbours with equal values, then build the
+            // treap from the sorted segments in linear time, using the right
+            // spine as a stack
+
+            std::vector<std::pair<Interval<K>, T>> segments;
+            auto prev = Detail::lower_point(Interval<K>::all());
+
+            auto append = [&segments] (const Interval<K>& in, const T& t) {
+                if (in.empty()) {
+                    return;
+                } else if (segments.empty() || segments.back().second != t) {
+                    segments.emplace_back(in, t);
+                } else {
+                    auto& last = segments.back().first;
+                    last = Detail::interval_between(Detail::lower_point(last), Detail::upper_point(in));
+                }
+            };
+
+            for (; i != j; ++i) {
+                const Interval<K>& in = i->first;
+                append(Detail::interval_between(prev, Detail::lower_point(in)), def_);
+                append(in, i->second);
+                prev = Detail::upper_point(in);
+            }
+
+            append(Detail::interval_between(prev, Detail::upper_point(Interval<K>::all())), def_);
+
+            nodes_.clear();
+            free_.clear();
+            nodes_.reserve(segments.size());
+            std::vector<std::size_t> spine;
+
+            for (auto& [key, value]: segments) {
+
+                auto n = nodes_.size();
+                auto& x = nodes_.emplace_back();
+                x.key = key;
+                x.value = value;
+                x.priority = rng_();
+                auto last = npos;
+
+                while (! spine.empty() && nodes_[spine.back()].priority < x.priority) {
+                    last = spine.back();
+                    spine.pop_back();
+                }
+
+                x.left = last;
+
+                if (! spine.empty()) {
+                    nodes_[spine.back()].right = n;
+                }
+
+                spine.push_back(n);
+
+            }
+
+            root_ = spine.front();
+            pull_all(root_);
+
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::apply(std::size_t n, T delta) {
+            if (n != npos) {
+                auto& x = nodes_[n];
+                x.value += delta;
+                x.lazy += delta;
+                x.low += delta;
+                x.high += delta;
+                x.total += sum_type(delta) * x.measure;
+            }
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::push(std::size_t n) {
+            auto& x = nodes_[n];
+            if (x.lazy != T()) {
+                apply(x.left, x.lazy);
+                apply(x.right, x.lazy);
+                x.lazy = T();
+            }
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::pull(std::size_t n) {
+
+            auto& x = nodes_[n];
+            x.low = x.high = x.value;
+            x.measure = measure(x.key);
+            x.total = sum_type(x.value) * x.measure;
+
+            for (auto c: {x.left, x.right}) {
+                if (c != npos) {
+                    auto& y = nodes_[c];
+                    x.low = std::min(x.low, y.low);
+                    x.high = std::max(x.high, y.high);
+                    x.measure += y.measure;
+                    x.total += y.total;
+                }
+            }
+
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::pull_all(std::size_t n) {
+            if (n != npos) {
+                pull_all(nodes_[n].left);
+                pull_all(nodes_[n].right);
+                pull(n);
+            }
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::cut(const Interval<K>& in, bool lower) {
+
+            // Find the segment that extends beyond the lower or upper end of
+            // the interval, if there is one, bringing its value up to date
+
+            auto n = root_;
+            Interval<K> rest;
+
+            while (n != npos) {
+
+                push(n);
+                auto& x = nodes_[n];
+                auto ord = x.key.order(in);
+
+                if (is_below(ord)) {
+                    n = x.right;
+                } else if (is_above(ord)) {
+                    n = x.left;
+                } else {
+                    rest = lower ? Detail::lower_remainder(x.key, in) : Detail::upper_remainder(x.key, in);
+                    if (! rest.empty()) {
+                        break;
+                    }
+                    n = lower ? x.left : x.right;
+                }
+
+            }
+
+            if (n == npos) {
+                return;
+            }
+
+            // The old node keeps the part outside the interval, and a new
+            // node is inserted for the part inside it. The insertion path
+            // always passes through the old node, since the two segments are
+            // adjacent, so its summary is updated on the way back up.
+
+            auto& x = nodes_[n];
+            Interval<K> inner;
+
+            if (lower) {
+                inner = Detail::interval_between(Detail::lower_point(in), Detail::upper_point(x.key));
+            } else {
+                inner = Detail::interval_between(Detail::lower_point(x.key), Detail::upper_point(in));
+            }
+
+            x.key = rest;
+            auto m = make_node(inner, x.value);
+            pull(m);
+            root_ = insert(root_, m);
+
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::coalesce(const Detail::SweepPoint<K>& p) {
+
+            // Find the segments on either side of the point. Both lie on the
+            // search path, so every pending addition above them has been
+            // pushed down and their values are current.
+
+            auto a = npos;
+            auto b = npos;
+
+            for (auto n = root_; n != npos;) {
+                push(n);
+                if (Detail::lower_point(nodes_[n].key) < p) {
+                    a = n;
+                    n = nodes_[n].right;
+                } else {
+                    b = n;
+                    n = nodes_[n].left;
+                }
+            }
+
+            if (a == npos || b == npos || nodes_[a].value != nodes_[b].value) {
+                return;
+            }
+
+            // Widening the lower segment leaves its position in the order
+            // unchanged, so the upper one can be removed by key, and the
+            // summaries above the lower one recalculated afterwards
+
+            auto lower = Detail::lower_point(nodes_[a].key);
+            nodes_[a].key = Detail::interval_between(lower, Detail::upper_point(nodes_[b].key));
+            root_ = erase(root_, Detail::lower_point(nodes_[b].key));
+            refresh(root_, lower);
+
+        }
+
+        template <Primitive K, Primitive T>
+        std::size_t IntervalSegmentTree<K, T>::make_node(const Interval<K>& key, T value) {
+
+            std::size_t n;
+
+            if (free_.empty()) {
+                n = nodes_.size();
+                nodes_.emplace_back();
+            } else {
+                n = free_.back();
+                free_.pop_back();
+                nodes_[n] = {};
+            }
+
+            auto& x = nodes_[n];
+            x.key = key;
+            x.value = value;
+            x.priority = rng_();
+
+            return n;
+
+        }
+
+        template <Primitive K, Primitive T>
+        std::size_t IntervalSegmentTree<K, T>::insert(std::size_t n, std::size_t x) {
+
+            if (n == npos) {
+                return x;
+            }
+
+            if (nodes_[n].priority < nodes_[x].priority) {
+                auto [l, r] = split(n, nodes_[x].key);
+                nodes_[x].left = l;
+                nodes_[x].right = r;
+            } else {
+                push(n);
+                if (Detail::lower_point(nodes_[x].key) < Detail::lower_point(nodes_[n].key)) {
+                    nodes_[n].left = insert(nodes_[n].left, x);
+                } else {
+                    nodes_[n].right = insert(nodes_[n].right, x);
+                }
+                x = n;
+            }
+
+            pull(x);
+
+            return x;
+
+        }
+
+        template <Primitive K, Primitive T>
+        std::size_t IntervalSegmentTree<K, T>::erase(std::size_t n, const Detail::SweepPoint<K>& p) {
+
+            // Remove the segment starting at the point, replacing it with
+            // the join of its children
+
+            if (n == npos) {
+                return npos;
+            }
+
+            push(n);
+            auto& x = nodes_[n];
+            auto q = Detail::lower_point(x.key);
+
+            if (p < q) {
+                x.left = erase(x.left, p);
+            } else if (q < p) {
+                x.right = erase(x.right, p);
+            } else {
+                auto r = join(x.left, x.right);
+                free_.push_back(n);
+                return r;
+            }
+
+            pull(n);
+
+            return n;
+
+        }
+
+        template <Primitive K, Primitive T>
+        std::size_t IntervalSegmentTree<K, T>::join(std::size_t l, std::size_t r) {
+
+            // Join two treaps, where every segment in the first lies below
+            // every segment in the second
+
+            if (l == npos) {
+                return r;
+            } else if (r == npos) {
+                return l;
+            } else if (nodes_[r].priority < nodes_[l].priority) {
+                push(l);
+                nodes_[l].right = join(nodes_[l].right, r);
+                pull(l);
+                return l;
+            } else {
+                push(r);
+                nodes_[r].left = join(l, nodes_[r].left);
+                pull(r);
+                return r;
+            }
+
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::refresh(std::size_t n, const Detail::SweepPoint<K>& p) {
+
+            // Recalculate the summaries on the path to the segment starting
+            // at the point
+
+            if (n == npos) {
+                return;
+            }
+
+            auto q = Detail::lower_point(nodes_[n].key);
+
+            if (p < q) {
+                refresh(nodes_[n].left, p);
+            } else if (q < p) {
+                refresh(nodes_[n].right, p);
+            }
+
+            pull(n);
+
+        }
+
+        template <Primitive K, Primitive T>
+        std::pair<std::size_t, std::size_t> IntervalSegmentTree<K, T>::split(std::size_t n, const Interval<K>& in) {
+
+            // Split into the segments below the interval and the rest
+
+            if (n == npos) {
+                return {npos, npos};
+            }
+
+            push(n);
+
+            if (Detail::lower_point(nodes_[n].key) < Detail::lower_point(in)) {
+                auto [l, r] = split(nodes_[n].right, in);
+                nodes_[n].right = l;
+                pull(n);
+                return {n, r};
+            } else {
+                auto [l, r] = split(nodes_[n].left, in);
+                nodes_[n].left = r;
+                pull(n);
+                return {l, n};
+            }
+
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::update(std::size_t n, const Interval<K>& in, bool lo_in, bool hi_in, T delta) {
+
+            // The flags indicate that every segment in the subtree is known
+            // to lie above the lower end, or below the upper end, of the
+            // interval. Only the two paths leading to the ends of the
+            // interval are followed; every subtree between them is entirely
+            // inside and is updated lazily.
+
+            if (n == npos) {
+                return;
+            }
+
+            if (lo_in && hi_in) {
+                apply(n, delta);
+                return;
+            }
+
+            push(n);
+            auto& x = nodes_[n];
+            auto ord = x.key.order(in);
+
+            if (is_below(ord)) {
+                update(x.right, in, false, hi_in, delta);
+            } else if (is_above(ord)) {
+                update(x.left, in, lo_in, false, delta);
+            } else {
+                x.value += delta;
+                update(x.left, in, lo_in, true, delta);
+                update(x.right, in, true, hi_in, delta);
+            }
+
+            pull(n);
+
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::collect(std::size_t n, const Interval<K>& in, bool lo_in, bool hi_in,
+                T offset, summary& s) const {
+
+            // As for update(), but without modifying the tree, so pending
+            // additions are accumulated on the way down instead of pushed
+
+            if (n == npos) {
+                return;
+            }
+
+            auto& x = nodes_[n];
+
+            if (lo_in && hi_in) {
+                s.add(T(x.low + offset), T(x.high + offset), x.total + sum_type(offset) * x.measure);
+                return;
+            }
+
+            auto ord = x.key.order(in);
+            auto inner = T(offset + x.lazy);
+
+            if (is_below(ord)) {
+                collect(x.right, in, false, hi_in, inner, s);
+            } else if (is_above(ord)) {
+                collect(x.left, in, lo_in, false, inner, s);
+            } else {
+                auto value = T(x.value + offset);
+                s.add(value, value, sum_type(value) * measure(x.key.set_intersection(in)));
+                collect(x.left, in, lo_in, true, inner, s);
+                collect(x.right, in, true, hi_in, inner, s);
+            }
+
+        }
+
+        template <Primitive K, Primitive T>
+        void IntervalSegmentTree<K, T>::collect_entries(std::size_t n, T offset,
+                std::vector<std::pair<Interval<K>, T>>& entries) const {
+
+            if (n == npos) {
+                return;
+            }
+
+            auto& x = nodes_[n];
+            auto inner = T(offset + x.lazy);
+            collect_entries(x.left, inner, entries);
+            auto value = T(x.value + offset);
+
+            if (value != def_) {
+                entries.emplace_back(x.key, value);
+            }
+
+            collect_entries(x.right, inner, entries);
+
+        }
+
+        template <Primitive K, Primitive T>
+        typename IntervalSegmentTree<K, T>::summary IntervalSegmentTree<K, T>::query(const Interval<K>& in) const {
+            summary s;
+            if (! in.empty()) {
+                collect(root_, in, false, false, T(), s);
+            }
+            return s;
+        }
+
+        template <Primitive K, Primitive T>
+        typename IntervalSegmentTree<K, T>::sum_type IntervalSegmentTree<K, T>::measure(const Interval<K>& in) {
+            if (in.empty() || in.is_infinite()) {
+                return sum_type();
+            } else {
+                return static_cast<sum_type>(in.size());
+            }
+        }
+
+}
@@ -0,0 +1,727 @@
+// This header is private to the implementation and should not be included by users
+
+#pragma once
+
+#include "rs-interval/arithmetic.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/radix-sort.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Linear time algorithms on ordered sequences of disjoint, coalesced
+        // intervals, as stored in the interval set classes
+
+        template <typename InputIterator>
+        using interval_value_type = typename std::iterator_traits<InputIterator>::value_type::value_type;
+
+        // Output adapter that accepts intervals in ascending order of lower
+        // bound, and merges any that touch or overlap before writing them
+
+        template <IntervalCompatible T, typename OutputIterator>
+        class IntervalCoalescer {
+
+        public:
+
+            explicit IntervalCoalescer(OutputIterator out): out_(out) {}
+
+            void push(const Interval<T>& in) {
+                if (in.empty()) {
+                    return;
+                } else if (pending_.empty()) {
+                    pending_ = in;
+                } else if (pending_.touches(in)) {
+                    pending_ = pending_.envelope(in);
+                } else {
+                    *out_++ = pending_;
+                    pending_ = in;
+                }
+            }
+
+            OutputIterator flush() {
+                if (! pending_.empty()) {
+                    *out_++ = pending_;
+                    pending_ = {};
+                }
+                return out_;
+            }
+
+        private:
+
+            Interval<T> pending_;
+            OutputIterator out_;
+
+        };
+
+        // Collect an arbitrary sequence of intervals (or values) into a sorted
+        // and coalesced vector, suitable for building an interval set
+
+        template <IntervalCompatible T, std::input_iterator I, std::sentinel_for<I> S>
+        std::vector<Interval<T>> collect_intervals(I first, S last) {
+
+            std::vector<Interval<T>> vec;
+
+            if constexpr (std::forward_iterator<I>) {
+                vec.reserve(static_cast<std::size_t>(std::ranges::distance(first, last)));
+            }
+
+            for (; first != last; ++first) {
+                Interval<T> in(*first);
+                if (! in.empty()) {
+                    vec.push_back(in);
+                }
+            }
+
+            sort_by_lower(vec, [] (const Interval<T>& in) -> const Interval<T>& { return in; });
+
+            // The coalescer never writes past the element being read, so the
+            // merge can be done in place
+
+            IntervalCoalescer<T, typename std::vector<Interval<T>>::iterator> co(vec.begin());
+
+            for (const auto& in: vec) {
+                co.push(in);
+            }
+
+            vec.erase(co.flush(), vec.end());
+
+            return vec;
+
+        }
+
+        // Collect an arbitrary sequence of (interval,value) pairs for building
+        // an interval map. If the intervals are disjoint, they are returned in
+        // ascending order, with touching entries of equal value merged, and
+        // the flag is true. Otherwise the result depends on the order of the
+        // entries; they are returned in their original order, and the flag is
+        // false.
+
+        template <IntervalCompatible K, typename T, std::input_iterator I, std::sentinel_for<I> S>
+        std::pair<std::vector<std::pair<Interval<K>, T>>, bool> collect_entries(I first, S last) {
+
+            using entry_list = std::vector<std::pair<Interval<K>, T>>;
+
+            entry_list list;
+
+            if constexpr (std::forward_iterator<I>) {
+                list.reserve(static_cast<std::size_t>(std::ranges::distance(first, last)));
+            }
+
+            for (; first != last; ++first) {
+                list.emplace_back(*first);
+                if (list.back().first.empty()) {
+                    list.pop_back();
+                }
+            }
+
+            auto disjoint = [] (const entry_list& el) {
+                return std::ranges::adjacent_find(el, [] (const auto& a, const auto& b) {
+                    return a.first.order(b.first) > Order::a_touches_b;
+                }) == el.end();
+            };
+
+            auto coalesce = [] (entry_list& el) {
+                std::size_t n = 0;
+                for (auto& entry: el) {
+                    if (n > 0 && el[n - 1].second == entry.second && el[n - 1].first.touches(entry.first)) {
+                        el[n - 1].first = el[n - 1].first.envelope(entry.first);
+                    } else {
+                        if (&el[n] != &entry) {
+                            el[n] = std::move(entry);
+                        }
+                        ++n;
+                    }
+                }
+                el.erase(el.begin() + static_cast<std::ptrdiff_t>(n), el.end());
+            };
+
+            // Input that is already ordered is used as it is; otherwise a
+            // sorted copy is tried
+
+            if (disjoint(list)) {
+                coalesce(list);
+                return {std::move(list), true};
+            }
+
+            auto sorted = list;
+            sort_by_lower(sorted, [] (const auto& entry) -> const Interval<K>& { return entry.first; });
+
+            if (disjoint(sorted)) {
+                coalesce(sorted);
+                return {std::move(sorted), true};
+            } else {
+                return {std::move(list), false};
+            }
+
+        }
+
+        // A position on the number line, lying just before or just after a
+        // value, or at either infinity. Every interval boundary can be mapped
+        // to one of these, so that the interval covers exactly the positions
+        // from its lower point (inclusive) to its upper point (exclusive).
+
+        template <IntervalCompatible T>
+        struct SweepPoint {
+
+            T value {};
+            int rank = 0;        // -1 = minus infinity, 0 = finite, 1 = plus infinity
+            bool after = false;  // Just after the value, rather than just before
+
+            bool operator==(const SweepPoint& b) const {
+                return rank == b.rank && (rank != 0 || (after == b.after && value == b.value));
+            }
+
+            bool operator<(const SweepPoint& b) const {
+                if (rank != b.rank) {
+                    return rank < b.rank;
+                } else if (rank != 0) {
+                    return false;
+                } else if (value < b.value) {
+                    return true;
+                } else if (b.value < value) {
+                    return false;
+                } else {
+                    return ! after && b.after;
+                }
+            }
+
+        };
+
+        template <IntervalCompatible T>
+        SweepPoint<T> lower_point(const Interval<T>& in) {
+            if (in.is_left_bounded()) {
+                return {in.min(), 0, in.is_left_open()};
+            } else {
+                return {{}, -1, false};
+            }
+        }
+
+        template <IntervalCompatible T>
+        SweepPoint<T> upper_point(const Interval<T>& in) {
+            if (in.is_right_bounded()) {
+                return {in.max(), 0, in.is_right_closed()};
+            } else {
+                return {{}, 1, false};
+            }
+        }
+
+        template <IntervalCompatible T>
+        Interval<T> interval_between(const SweepPoint<T>& lower, const SweepPoint<T>& upper) {
+            auto l = lower.rank < 0 ? Bound::unbound : lower.after ? Bound::open : Bound::closed;
+            auto r = upper.rank > 0 ? Bound::unbound : upper.after ? Bound::closed : Bound::open;
+            return {lower.value, upper.value, l, r};
+        }
+
+        // The parts of a that lie below or above b, or empty if there is
+        // none. These do not check that a and b actually overlap.
+
+        template <IntervalCompatible T>
+        Interval<T> lower_remainder(const Interval<T>& a, const Interval<T>& b) {
+            auto la = lower_point(a);
+            auto lb = lower_point(b);
+            return la < lb ? interval_between(la, lb) : Interval<T>();
+        }
+
+        template <IntervalCompatible T>
+        Interval<T> upper_remainder(const Interval<T>& a, const Interval<T>& b) {
+            auto ua = upper_point(a);
+            auto ub = upper_point(b);
+            return ub < ua ? interval_between(ub, ua) : Interval<T>();
+        }
+
+        // The total size of a collection of intervals: the number of elements
+        // for discrete types, or the length for continuous types. Unbounded
+        // intervals are counted separately; any of them make the total
+        // infinite, represented by npos or by a floating point infinity.
+
+        template <typename T>
+        concept Measurable = Continuous<T> || Integral<T> || Stepwise<T>;
+
+        template <IntervalCompatible T>
+        using measure_type = std::conditional_t<Continuous<T>, T, std::size_t>;
+
+        template <IntervalCompatible T>
+        constexpr measure_type<T> infinite_measure() noexcept {
+            if constexpr (Continuous<T>) {
+                return std::numeric_limits<T>::infinity();
+            } else {
+                return npos;
+            }
+        }
+
+        template <IntervalCompatible T>
+        measure_type<T> finite_measure(const Interval<T>& in) {
+            if constexpr (Measurable<T>) {
+                if (! in.empty() && ! in.is_infinite()) {
+                    return in.size();
+                }
+            }
+            return {};
+        }
+
+        // A running sum that can be added to and subtracted from without
+        // losing small terms. For floating point types the sum is kept as a
+        // rounded value plus the exact rounding error, so that adding a
+        // large length and later subtracting it again restores the small
+        // lengths around it. Other types are summed directly.
+
+        template <typename T>
+        class CompensatedSum {
+
+        public:
+
+            CompensatedSum() = default;
+            CompensatedSum(const T& t): hi_(t) {}
+
+            T value() const { return hi_ + lo_; }
+
+            CompensatedSum& operator+=(const T& t) {
+                if constexpr (std::floating_point<T>) {
+                    auto [s,e] = two_sum(hi_, t);
+                    e += lo_;
+                    hi_ = s + e;
+                    lo_ = e - (hi_ - s);
+                } else {
+                    hi_ += t;
+                }
+                return *this;
+            }
+
+            CompensatedSum& operator+=(const CompensatedSum& s) {
+                *this += s.hi_;
+                return *this += s.lo_;
+            }
+
+            CompensatedSum& operator-=(const T& t) {
+                if constexpr (std::floating_point<T>) {
+                    return *this += - t;
+                } else {
+                    hi_ -= t;
+                    return *this;
+                }
+            }
+
+            friend T operator-(CompensatedSum a, const CompensatedSum& b) {
+                a -= b.hi_;
+                a -= b.lo_;
+                return a.value();
+            }
+
+        private:
+
+            T hi_ {};
+            T lo_ {};
+
+            static std::pair<T, T> two_sum(T a, T b) noexcept {
+                auto s = a + b;
+                auto c = s - a;
+                return {s, (a - (s - c)) + (b - c)};
+            }
+
+        };
+
+        // The finite size of an interval as a term of a compensated sum,
+        // used to weigh the nodes of a tree of intervals
+
+        template <IntervalCompatible T>
+        struct IntervalWeight {
+            CompensatedSum<measure_type<T>> operator()(const Interval<T>& in) const {
+                return finite_measure(in);
+            }
+        };
+
+        template <IntervalCompatible T>
+        class IntervalMeasure {
+
+        public:
+
+            measure_type<T> value() const { return unbounded_ == 0 ? finite_.value() : infinite_measure<T>(); }
+            void add(const Interval<T>& in) { update(in, 1); }
+            void subtract(const Interval<T>& in) { update(in, -1); }
+            void clear() noexcept { finite_ = {}; unbounded_ = 0; }
+
+        private:
+
+            CompensatedSum<measure_type<T>> finite_;
+            std::ptrdiff_t unbounded_ = 0;
+
+            void update(const Interval<T>& in, int sign) {
+                if (in.is_infinite() && ! in.empty()) {
+                    unbounded_ += sign;
+                } else if (sign > 0) {
+                    finite_ += finite_measure(in);
+                } else {
+                    finite_ -= finite_measure(in);
+                }
+            }
+
+        };
+
+        // The run of intervals in a sorted disjoint range that overlap an
+        // interval, found by binary search
+
+        template <std::random_access_iterator RandomAccessIterator, IntervalCompatible T>
+        std::pair<RandomAccessIterator, RandomAccessIterator> overlapping_run(RandomAccessIterator i,
+                RandomAccessIterator j, const Interval<T>& in) {
+            if (in.empty()) {
+                return {j, j};
+            }
+            i = std::partition_point(i, j, [&in] (const Interval<T>& x) { return in.order(x) >= Order::b_touches_a; });
+            j = std::partition_point(i, j, [&in] (const Interval<T>& x) { return in.order(x) > Order::a_touches_b; });
+            return {i, j};
+        }
+
+        template <typename InputIterator1, typename InputIterator2, typename OutputIterator>
+        OutputIterator intersect_intervals(InputIterator1 i, InputIterator1 j,
+                InputIterator2 k, InputIterator2 l, OutputIterator out) {
+
+            while (i != j && k != l) {
+
+                auto in = i->set_intersection(*k);
+
+                if (! in.empty()) {
+                    *out++ = in;
+                }
+
+                // Advance past whichever interval ends first; the other one
+                // may still overlap the next interval from this side
+
+                auto ri = right_boundary_of(*i);
+                auto rk = right_boundary_of(*k);
+
+                if (ri.compare_rr(rk)) {
+                    ++i;
+                } else if (rk.compare_rr(ri)) {
+                    ++k;
+                } else {
+                    ++i;
+                    ++k;
+                }
+
+            }
+
+            return out;
+
+        }
+
+        template <typename InputIterator1, typename InputIterator2, typename OutputIterator>
+        OutputIterator unite_intervals(InputIterator1 i, InputIterator1 j,
+                InputIterator2 k, InputIterator2 l, OutputIterator out) {
+
+            IntervalCoalescer<interval_value_type<InputIterator1>, OutputIterator> co(out);
+
+            while (i != j && k != l) {
+                if (*k < *i) {
+                    co.push(*k++);
+                } else {
+                    co.push(*i++);
+                }
+            }
+
+            for (; i != j; ++i) {
+                co.push(*i);
+            }
+
+            for (; k != l; ++k) {
+                co.push(*k);
+            }
+
+            return co.flush();
+
+        }
+
+        // General sweep over the boundaries of both sequences. The predicate
+        // is called with the membership state of the two inputs after each
+        // boundary, and decides whether that region is part of the output.
+
+        template <typename InputIterator1, typename InputIterator2, typename OutputIterator, typename Predicate>
+        OutputIterator combine_intervals(InputIterator1 i, InputIterator1 j,
+                InputIterator2 k, InputIterator2 l, OutputIterator out, Predicate pred) {
+
+            using T = interval_value_type<InputIterator1>;
+            using P = SweepPoint<T>;
+
+            IntervalCoalescer<T, OutputIterator> co(out);
+            bool in_a = false;
+            bool in_b = false;
+            bool in_out = pred(false, false);
+            P start {{}, -1, false};
+
+            const auto next_a = [&] { return in_a ? upper_point(*i) : lower_point(*i); };
+            const auto next_b = [&] { return in_b ? upper_point(*k) : lower_point(*k); };
+
+            while (i != j || k != l) {
+
+                P p;
+
+                if (i == j) {
+                    p = next_b();
+                } else if (k == l) {
+                    p = next_a();
+                } else {
+                    p = std::min(next_a(), next_b());
+                }
+
+                while (i != j && next_a() == p) {
+                    if (in_a) {
+                        ++i;
+                    }
+                    in_a = ! in_a;
+                }
+
+                while (k != l && next_b() == p) {
+                    if (in_b) {
+                        ++k;
+                    }
+                    in_b = ! in_b;
+                }
+
+                if (pred(in_a, in_b) != in_out) {
+                    if (in_out) {
+                        co.push(interval_between(start, p));
+                    } else {
+                        start = p;
+                    }
+                    in_out = ! in_out;
+                }
+
+            }
+
+            if (in_out) {
+                co.push(interval_between(start, P{{}, 1, false}));
+            }
+
+            return co.flush();
+
+        }
+
+        template <typename InputIterator1, typename InputIterator2, typename OutputIterator>
+        OutputIterator subtract_intervals(InputIterator1 i, InputIterator1 j,
+                InputIterator2 k, InputIterator2 l, OutputIterator out) {
+            return combine_intervals(i, j, k, l, out, [] (bool a, bool b) { return a && ! b; });
+        }
+
+        template <typename InputIterator1, typename InputIterator2, typename OutputIterator>
+        OutputIterator exclusive_intervals(InputIterator1 i, InputIterator1 j,
+                InputIterator2 k, InputIterator2 l, OutputIterator out) {
+            return combine_intervals(i, j, k, l, out, [] (bool a, bool b) { return a != b; });
+        }
+
+        // Parallel form of the binary set operations, for inputs in
+        // contiguous storage. The inputs are cut at the lower bounds of evenly
+        // spaced intervals from the larger one, and any interval from the
+        // other input that crosses a cut is clipped into two pieces. Each
+        // chunk is combined on its own thread, and pieces that touch across a
+        // cut are merged when the outputs are joined.
+
+        inline constexpr std::size_t parallel_chunk_size = 4096;
+
+        template <IntervalCompatible T, typename Combine>
+        std::vector<Interval<T>> parallel_combine(std::span<const Interval<T>> a, std::span<const Interval<T>> b,
+                std::size_t threads, Combine combine) {
+
+            using P = SweepPoint<T>;
+            using list = std::vector<Interval<T>>;
+
+            if (threads == 0) {
+                threads = std::max(std::thread::hardware_concurrency(), 1u);
+            }
+
+            auto chunks = std::min(threads, (a.size() + b.size()) / parallel_chunk_size);
+            list result;
+
+            if (chunks <= 1) {
+                combine(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+                return result;
+            }
+
+            auto x = a.size() >= b.size() ? a : b;
+            std::vector<P> cuts {{{}, -1, false}};
+
+            for (std::size_t m = 1; m < chunks; ++m) {
+                cuts.push_back(lower_point(x[m * x.size() / chunks]));
+            }
+
+            cuts.push_back({{}, 1, false});
+
+            // The part of a sequence that lies between two cuts
+
+            auto slice = [] (std::span<const Interval<T>> y, const P& lo, const P& hi) {
+                auto i = std::ranges::partition_point(y, [&lo] (const Interval<T>& in) { return ! (lo < upper_point(in)); });
+                auto j = std::ranges::partition_point(y, [&hi] (const Interval<T>& in) { return lower_point(in) < hi; });
+                list part(i, j);
+                if (! part.empty()) {
+                    if (lower_point(part.front()) < lo) {
+                        part.front() = interval_between(lo, upper_point(part.front()));
+                    }
+                    if (hi < upper_point(part.back())) {
+                        part.back() = interval_between(lower_point(part.back()), hi);
+                    }
+                }
+                return part;
+            };
+
+            auto work = [&] (std::size_t m) {
+                auto pa = slice(a, cuts[m], cuts[m + 1]);
+                auto pb = slice(b, cuts[m], cuts[m + 1]);
+                list out;
+                out.reserve(pa.size() + pb.size());
+                combine(pa.begin(), pa.end(), pb.begin(), pb.end(), std::back_inserter(out));
+                return out;
+            };
+
+            std::vector<std::future<list>> futures;
+
+            for (std::size_t m = 1; m < chunks; ++m) {
+                futures.push_back(std::async(std::launch::async, work, m));
+            }
+
+            std::vector<list> parts;
+            parts.push_back(work(0));
+
+            for (auto& f: futures) {
+                parts.push_back(f.get());
+            }
+
+            std::size_t n = 0;
+
+            for (auto& part: parts) {
+                n += part.size();
+            }
+
+            result.reserve(n);
+
+            for (auto& part: parts) {
+                auto i = part.begin();
+                if (! result.empty() && i != part.end() && result.back().touches(*i)) {
+                    result.back() = result.back().envelope(*i++);
+                }
+                result.insert(result.end(), std::make_move_iterator(i), std::make_move_iterator(part.end()));
+            }
+
+            return result;
+
+        }
+
+
+        // Batch membership tests against an ordered sequence of disjoint
+        // intervals. The keys must be in ascending order for the merged
+        // scan; on random access sequences it gallops past runs of intervals
+        // that lie wholly below the next key.
+
+        template <typename ForwardIterator, typename T>
+        void contains_sorted(ForwardIterator i, ForwardIterator j, std::span<const T> keys, std::span<bool> out) {
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+
+                const auto& key = keys[k];
+
+                if constexpr (std::random_access_iterator<ForwardIterator>) {
+                    std::ptrdiff_t step = 1;
+                    while (step < j - i && i[step].match(key) == Match::high) {
+                        i += step;
+                        step *= 2;
+                    }
+                }
+
+                while (i != j && i->match(key) == Match::high) {
+                    ++i;
+                }
+
+                out[k] = i != j && i->match(key) == Match::ok;
+
+            }
+
+        }
+
+        // Unordered keys against a contiguous array of intervals. Each search
+        // is branchless, finding the last interval whose lower bound value
+        // does not exceed the key, and a group of searches is run in lockstep
+        // so that the memory accesses of different keys overlap. The
+        // candidates for the next probe of each search are prefetched.
+
+        // Only the bound values need to be compared during the search. The
+        // first interval is never probed, so it does not matter if it is
+        // unbounded below. If the search lands on an interval that is open at
+        // the key, the key cannot be in the one before, because a closed
+        // upper bound there would touch it and the two would have been
+        // coalesced.
+
+        template <IntervalCompatible T>
+        void contains_interleaved(const Interval<T>* data, std::size_t n, std::span<const T> keys, std::span<bool> out) {
+
+            static constexpr std::size_t group = 16;
+
+            if (n == 0) {
+                std::ranges::fill(out, false);
+                return;
+            }
+
+            std::array<const Interval<T>*, group> base;
+
+            for (std::size_t k = 0; k < keys.size(); k += group) {
+
+                auto m = std::min(group, keys.size() - k);
+                base.fill(data);
+
+                for (auto len = n; len > 1; len -= len / 2) {
+                    auto half = len / 2;
+                    for (std::size_t g = 0; g < m; ++g) {
+                        #if defined(__GNUC__) || defined(__clang__)
+                            __builtin_prefetch(base[g] + half / 2);
+                            __builtin_prefetch(base[g] + half + half / 2);
+                        #endif
+                        base[g] = keys[k + g] < base[g][half].min() ? base[g] : base[g] + half;
+                    }
+                }
+
+                for (std::size_t g = 0; g < m; ++g) {
+                    out[k + g] = base[g]->match(keys[k + g]) == Match::ok;
+                }
+
+            }
+
+        }
+
+        // Unordered keys against a node based sequence: the keys are sorted
+        // with their original positions, so that the merged scan can be used
+
+        template <typename ForwardIterator, typename T>
+        void contains_unsorted(ForwardIterator i, ForwardIterator j, std::span<const T> keys, std::span<bool> out) {
+
+            std::vector<std::pair<T, std::size_t>> index;
+            index.reserve(keys.size());
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                index.emplace_back(keys[k], k);
+            }
+
+            std::ranges::sort(index, [] (const auto& a, const auto& b) { return a.first < b.first; });
+
+            for (const auto& [key,k]: index) {
+                while (i != j && i->match(key) == Match::high) {
+                    ++i;
+                }
+                out[k] = i != j && i->match(key) == Match::ok;
+            }
+
+        }
+
+    }
+
+}
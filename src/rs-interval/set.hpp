@@ -1,18 +1,36 @@
 #pragma once
 
+#include "rs-interval/frozen-set.hpp"
 #include "rs-interval/interval.hpp"
+#include "rs-interval/ranked-tree.hpp"
+#include "rs-interval/set-algorithms.hpp"
 #include "rs-interval/types.hpp"
 #include <algorithm>
 #include <compare>
+#include <concepts>
 #include <cstddef>
 #include <format>
 #include <initializer_list>
 #include <iterator>
-#include <set>
+#include <memory>
+#include <queue>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace RS::Interval {
 
+    namespace Detail {
+
+        template <IntervalCompatible T>
+        using IntervalSetTree = RankedTree<Interval<T>, Interval<T>,
+            std::conditional_t<Measurable<T>, IntervalWeight<T>, void>>;
+
+    }
+
     // Interval set
 
     template <IntervalCompatible T>
@@ -20,16 +38,19 @@ namespace RS::Interval {
 
     public:
 
-        using iterator = typename std::set<Interval<T>>::const_iterator;
+        using iterator = typename Detail::IntervalSetTree<T>::iterator;
         using interval_type = Interval<T>;
         using value_type = T;
 
         static constexpr auto category = interval_category<T>;
 
         IntervalSet() = default;
-        IntervalSet(const T& t): set_{{t}} {}
+        IntervalSet(const T& t): IntervalSet(interval_type(t)) {}
         IntervalSet(const interval_type& in) { insert(in); }
-        IntervalSet(std::initializer_list<interval_type> list);
+        IntervalSet(std::initializer_list<interval_type> list): IntervalSet(list.begin(), list.end()) {}
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, Interval<T>>
+        IntervalSet(I first, S last) { assign(first, last); }
 
         bool operator[](const T& t) const { return contains(t); }
 
@@ -38,24 +59,42 @@ namespace RS::Interval {
         bool empty() const noexcept { return set_.empty(); }
         std::size_t size() const noexcept { return set_.size(); }
         bool contains(const T& t) const;
-        void clear() noexcept { set_.clear(); }
+        void contains_batch(std::span<const T> keys, std::span<bool> out) const;
+        std::vector<T> filter(std::span<const T> keys) const;
+        std::ranges::subrange<iterator> overlapping(const interval_type& in) const;
+        std::size_t count_overlapping(const interval_type& in) const;
+        iterator nth(std::size_t i) const noexcept { return set_.nth(i); }
+        std::size_t rank(const T& t) const;
+        std::size_t cardinality() const noexcept requires (Integral<T> || Stepwise<T>) { return total_.value(); }
+        std::size_t cardinality(const interval_type& within) const requires (Integral<T> || Stepwise<T>) { return measure_within(within); }
+        T measure() const noexcept requires Continuous<T> { return total_.value(); }
+        T measure(const interval_type& within) const requires Continuous<T> { return measure_within(within); }
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, Interval<T>>
+        void assign(I first, S last);
+        void clear() noexcept { set_.clear(); total_.clear(); }
         void insert(const interval_type& in);
         void erase(const interval_type& in);
-        void swap(IntervalSet& set) noexcept { set_.swap(set.set_); }
+        void swap(IntervalSet& set) noexcept { set_.swap(set.set_); std::swap(total_, set.total_); }
+        auto freeze() const requires Primitive<T> { return FrozenIntervalSet<T>(*this); }
 
         IntervalSet complement() const;
         IntervalSet set_intersection(const IntervalSet& b) const;
         IntervalSet set_intersection(const interval_type& b) const;
         IntervalSet set_intersection(const T& b) const;
+        IntervalSet set_intersection(const IntervalSet& b, std::size_t threads) const;
         IntervalSet set_union(const IntervalSet& b) const;
         IntervalSet set_union(const interval_type& b) const;
         IntervalSet set_union(const T& b) const;
+        IntervalSet set_union(const IntervalSet& b, std::size_t threads) const;
         IntervalSet set_difference(const IntervalSet& b) const;
         IntervalSet set_difference(const interval_type& b) const;
         IntervalSet set_difference(const T& b) const;
+        IntervalSet set_difference(const IntervalSet& b, std::size_t threads) const;
         IntervalSet set_symmetric_difference(const IntervalSet& b) const;
         IntervalSet set_symmetric_difference(const interval_type& b) const;
         IntervalSet set_symmetric_difference(const T& b) const;
+        IntervalSet set_symmetric_difference(const IntervalSet& b, std::size_t threads) const;
 
         IntervalSet& apply_complement();
         IntervalSet& apply_intersection(const IntervalSet& b);
@@ -73,15 +112,33 @@ namespace RS::Interval {
 
     private:
 
-        std::set<Interval<T>> set_;
+        // The intervals are held in a tree that records subtree sizes, so
+        // that they can be found by position, and for measurable types the
+        // total size of each subtree, so that bounded totals can be found
+        // without visiting every interval. The total size of the whole set
+        // is kept up to date by every modifying function, so that it can be
+        // queried in constant time.
+
+        using tree_type = Detail::IntervalSetTree<T>;
+
+        tree_type set_;
+        Detail::IntervalMeasure<T> total_;
+
+        static IntervalSet from_sorted(std::vector<Interval<T>>&& list);
+
+        std::pair<iterator, iterator> do_overlapping(const interval_type& in) const;
+        Detail::measure_type<T> measure_within(const interval_type& within) const;
+        void recount();
+        template <typename Combine> IntervalSet parallel_combine(const IntervalSet& b, std::size_t threads, Combine combine) const;
 
     };
 
         template <IntervalCompatible T>
-        IntervalSet<T>::IntervalSet(std::initializer_list<interval_type> list) {
-            for (const auto& in: list) {
-                insert(in);
-            }
+        template <std::input_iterator I, std::sentinel_for<I> S>
+        requires std::convertible_to<std::iter_reference_t<I>, Interval<T>>
+        void IntervalSet<T>::assign(I first, S last) {
+            set_ = tree_type(Detail::collect_intervals<T>(first, last));
+            recount();
         }
 
         template <IntervalCompatible T>
@@ -107,6 +164,56 @@ namespace RS::Interval {
 
         }
 
+        template <IntervalCompatible T>
+        void IntervalSet<T>::contains_batch(std::span<const T> keys, std::span<bool> out) const {
+
+            if (out.size() != keys.size()) {
+                throw std::invalid_argument("Batch query output size does not match input");
+            }
+
+            if (std::ranges::is_sorted(keys)) {
+                Detail::contains_sorted(set_.begin(), set_.end(), keys, out);
+            } else {
+                Detail::contains_unsorted(set_.begin(), set_.end(), keys, out);
+            }
+
+        }
+
+        template <IntervalCompatible T>
+        std::vector<T> IntervalSet<T>::filter(std::span<const T> keys) const {
+
+            auto flags = std::make_unique<bool[]>(keys.size());
+            contains_batch(keys, {flags.get(), keys.size()});
+            std::vector<T> result;
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                if (flags[k]) {
+                    result.push_back(keys[k]);
+                }
+            }
+
+            return result;
+
+        }
+
+        template <IntervalCompatible T>
+        std::ranges::subrange<typename IntervalSet<T>::iterator> IntervalSet<T>::overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return {i, j};
+        }
+
+        template <IntervalCompatible T>
+        std::size_t IntervalSet<T>::count_overlapping(const interval_type& in) const {
+            auto [i,j] = do_overlapping(in);
+            return static_cast<std::size_t>(std::distance(i, j));
+        }
+
+        template <IntervalCompatible T>
+        std::size_t IntervalSet<T>::rank(const T& t) const {
+            auto i = set_.partition_point([&t] (const interval_type& in) { return in.match(t) == Match::high; });
+            return set_.position(i);
+        }
+
         template <IntervalCompatible T>
         void IntervalSet<T>::insert(const interval_type& in) {
 
@@ -130,47 +237,150 @@ namespace RS::Interval {
                 auto j = i++;
                 if (ord <= Order::b_touches_a) {
                     add = add.envelope(*j);
+                    total_.subtract(*j);
                     set_.erase(j);
                 }
             }
 
             set_.insert(add);
+            total_.add(add);
 
         }
 
         template <IntervalCompatible T>
         void IntervalSet<T>::erase(const interval_type& in) {
 
-            if (empty() || in.empty()) {
+            // [i,j) is the run of intervals that overlap the erased one
+
+            auto [i,j] = do_overlapping(in);
+
+            if (i == j) {
                 return;
             }
 
+            // Only the first and last intervals in the run can survive in part.
+            // Their nodes are trimmed and reused; a new node is only needed
+            // when a single interval is split in two.
+
+            auto lower = Detail::lower_remainder(*i, in);
+            auto upper = Detail::upper_remainder(*std::prev(j), in);
+            typename tree_type::node_type lower_node, upper_node;
+
+            for (auto k = i; k != j; ++k) {
+                total_.subtract(*k);
+            }
+
+            total_.add(lower);
+            total_.add(upper);
+
+            if (! lower.empty()) {
+                lower_node = set_.extract(i++);
+                lower_node.value() = lower;
+            }
+
+            if (! upper.empty() && i != j) {
+                auto k = std::prev(j);
+                if (k == i) {
+                    ++i;
+                }
+                upper_node = set_.extract(k);
+                upper_node.value() = upper;
+            }
+
+            set_.erase(i, j);
+
+            if (lower_node) {
+                set_.insert(j, std::move(lower_node));
+            }
+
+            if (upper_node) {
+                set_.insert(j, std::move(upper_node));
+            } else if (! upper.empty()) {
+                set_.insert(j, upper);
+            }
+
+        }
+
+        template <IntervalCompatible T>
+        std::pair<typename IntervalSet<T>::iterator, typename IntervalSet<T>::iterator>
+        IntervalSet<T>::do_overlapping(const interval_type& in) const {
+
+            if (empty() || in.empty()) {
+                return {end(), end()};
+            }
+
+            // Of the intervals that start below this one, only the last can
+            // overlap it
+
             auto i = set_.lower_bound(in);
 
             if (i != set_.begin()) {
                 --i;
             }
 
-            IntervalSet temp;
-            std::vector<interval_type> vec;
+            while (i != set_.end() && in.order(*i) >= Order::b_touches_a) {
+                ++i;
+            }
 
-            while (i != set_.end()) {
-                auto ord = in.order(*i);
-                if (ord <= Order::a_touches_b) {
-                    break;
-                }
-                auto j = i++;
-                if (ord <= Order::b_overlaps_a) {
-                    temp = j->set_difference(in);
-                    std::copy(temp.begin(), temp.end(), std::back_inserter(vec));
-                    set_.erase(j);
-                }
+            auto j = i;
+
+            while (j != set_.end() && in.order(*j) > Order::a_touches_b) {
+                ++j;
+            }
+
+            return {i, j};
+
+        }
+
+        template <IntervalCompatible T>
+        Detail::measure_type<T> IntervalSet<T>::measure_within(const interval_type& within) const {
+
+            // Only the first and last intervals in the overlapping run can be
+            // cut short by the bounding interval; the ones between them are
+            // counted in full from the subtree totals.
+
+            if (within.empty()) {
+                return {};
+            }
+
+            auto i = set_.partition_point([&within] (const interval_type& x) { return within.order(x) >= Order::b_touches_a; });
+            auto j = set_.partition_point([&within] (const interval_type& x) { return within.order(x) > Order::a_touches_b; });
+
+            if (i == j) {
+                return {};
             }
 
-            set_.insert(vec.begin(), vec.end());
+            auto first = i->set_intersection(within);
+            auto last = std::prev(j)->set_intersection(within);
+
+            if (first.is_infinite() || last.is_infinite()) {
+                return Detail::infinite_measure<T>();
+            } else if (std::next(i) == j) {
+                return Detail::finite_measure(first);
+            }
+
+            auto inner = set_.weight_before(std::prev(j)) - set_.weight_before(std::next(i));
+
+            return Detail::finite_measure(first) + inner + Detail::finite_measure(last);
 
         }
 
+        template <IntervalCompatible T>
+        IntervalSet<T> IntervalSet<T>::from_sorted(std::vector<Interval<T>>&& list) {
+            IntervalSet result;
+            result.set_ = tree_type(std::move(list));
+            result.recount();
+            return result;
+        }
+
+        template <IntervalCompatible T>
+        void IntervalSet<T>::recount() {
+            total_.clear();
+            for (auto& in: set_) {
+                total_.add(in);
+            }
+        }
+
         template <IntervalCompatible T>
         IntervalSet<T> IntervalSet<T>::complement() const {
 
@@ -178,28 +388,30 @@ namespace RS::Interval {
                 return interval_type::all();
             }
 
-            IntervalSet result;
+            std::vector<Interval<T>> list;
             auto i = set_.begin();
 
             if (i->is_left_bounded()) {
-                result.set_.insert({{}, i->min(), Bound::unbound, ~ i->left()});
+                list.push_back({{}, i->min(), Bound::unbound, ~ i->left()});
             }
 
             for (auto j = std::next(i), end = set_.end(); j != end; i = j++) {
-                result.set_.insert({i->max(), j->min(), ~ i->right(), ~ j->left()});
+                list.push_back({i->max(), j->min(), ~ i->right(), ~ j->left()});
             }
 
             if (i->is_right_bounded()) {
-                result.set_.insert({i->max(), {}, ~ i->right(), Bound::unbound});
+                list.push_back({i->max(), {}, ~ i->right(), Bound::unbound});
             }
 
-            return result;
+            return from_sorted(std::move(list));
 
         }
 
         template <IntervalCompatible T>
         IntervalSet<T> IntervalSet<T>::set_intersection(const IntervalSet& b) const {
-            return complement().set_union(b.complement()).complement();
+            std::vector<Interval<T>> list;
+            Detail::intersect_intervals(begin(), end(), b.begin(), b.end(), std::back_inserter(list));
+            return from_sorted(std::move(list));
         }
 
         template <IntervalCompatible T>
@@ -212,13 +424,18 @@ namespace RS::Interval {
             return set_intersection(IntervalSet{b});
         }
 
+        template <IntervalCompatible T>
+        IntervalSet<T> IntervalSet<T>::set_intersection(const IntervalSet& b, std::size_t threads) const {
+            return parallel_combine(b, threads, [] (auto i, auto j, auto k, auto l, auto out) {
+                return Detail::intersect_intervals(i, j, k, l, out);
+            });
+        }
+
         template <IntervalCompatible T>
         IntervalSet<T> IntervalSet<T>::set_union(const IntervalSet& b) const {
-            auto result = *this;
-            for (const auto& in: b) {
-                result.insert(in);
-            }
-            return result;
+            std::vector<Interval<T>> list;
+            Detail::unite_intervals(begin(), end(), b.begin(), b.end(), std::back_inserter(list));
+            return from_sorted(std::move(list));
         }
 
         template <IntervalCompatible T>
@@ -231,13 +448,18 @@ namespace RS::Interval {
             return set_union(IntervalSet{b});
         }
 
+        template <IntervalCompatible T>
+        IntervalSet<T> IntervalSet<T>::set_union(const IntervalSet& b, std::size_t threads) const {
+            return parallel_combine(b, threads, [] (auto i, auto j, auto k, auto l, auto out) {
+                return Detail::unite_intervals(i, j, k, l, out);
+            });
+        }
+
         template <IntervalCompatible T>
         IntervalSet<T> IntervalSet<T>::set_difference(const IntervalSet& b) const {
-            auto result = *this;
-            for (const auto& in: b) {
-                result.erase(in);
-            }
-            return result;
+            std::vector<Interval<T>> list;
+            Detail::subtract_intervals(begin(), end(), b.begin(), b.end(), std::back_inserter(list));
+            return from_sorted(std::move(list));
         }
 
         template <IntervalCompatible T>
@@ -250,11 +472,18 @@ namespace RS::Interval {
             return set_difference(IntervalSet{b});
         }
 
+        template <IntervalCompatible T>
+        IntervalSet<T> IntervalSet<T>::set_difference(const IntervalSet& b, std::size_t threads) const {
+            return parallel_combine(b, threads, [] (auto i, auto j, auto k, auto l, auto out) {
+                return Detail::subtract_intervals(i, j, k, l, out);
+            });
+        }
+
         template <IntervalCompatible T>
         IntervalSet<T> IntervalSet<T>::set_symmetric_difference(const IntervalSet& b) const {
-            auto set1 = set_difference(b);
-            auto set2 = b.set_difference(*this);
-            return set1.set_union(set2);
+            std::vector<Interval<T>> list;
+            Detail::exclusive_intervals(begin(), end(), b.begin(), b.end(), std::back_inserter(list));
+            return from_sorted(std::move(list));
         }
 
         template <IntervalCompatible T>
@@ -267,6 +496,28 @@ namespace RS::Interval {
             return set_symmetric_difference(IntervalSet{b});
         }
 
+        template <IntervalCompatible T>
+        IntervalSet<T> IntervalSet<T>::set_symmetric_difference(const IntervalSet& b, std::size_t threads) const {
+            return parallel_combine(b, threads, [] (auto i, auto j, auto k, auto l, auto out) {
+                return Detail::exclusive_intervals(i, j, k, l, out);
+            });
+        }
+
+        template <IntervalCompatible T>
+        template <typename Combine>
+        IntervalSet<T> IntervalSet<T>::parallel_combine(const IntervalSet& b, std::size_t threads, Combine combine) const {
+
+            // The tree cannot be split without walking it, so both sets are
+            // copied into contiguous storage first. The result is sorted,
+            // which lets the tree be built in linear time.
+
+            std::vector<Interval<T>> va(begin(), end());
+            std::vector<Interval<T>> vb(b.begin(), b.end());
+
+            return from_sorted(Detail::parallel_combine<T>(va, vb, threads, combine));
+
+        }
+
         template <IntervalCompatible T>
         IntervalSet<T>& IntervalSet<T>::apply_complement() {
             auto set = complement();
@@ -293,10 +544,55 @@ namespace RS::Interval {
 
         template <IntervalCompatible T>
         IntervalSet<T>& IntervalSet<T>::apply_union(const IntervalSet& b) {
-            for (const auto& in: b) {
-                insert(in);
+
+            // Merge b into this set in one ordered pass. Surviving nodes are
+            // extracted, widened, and reinserted in place; new nodes are only
+            // allocated for intervals of b that do not touch this set.
+
+            if (&b == this) {
+                return *this;
+            }
+
+            auto i = set_.begin();
+            auto k = b.begin();
+
+            while (k != b.end()) {
+
+                while (i != set_.end() && k->order(*i) == Order::b_below_a) {
+                    ++i;
+                }
+
+                if (i == set_.end() || k->order(*i) <= Order::a_below_b) {
+                    total_.add(*k);
+                    set_.insert(i, *k++);
+                    continue;
+                }
+
+                auto add = k->envelope(*i);
+                total_.subtract(*i);
+                auto node = set_.extract(i++);
+                ++k;
+
+                for (;;) {
+                    if (i != set_.end() && add.order(*i) > Order::a_below_b) {
+                        add = add.envelope(*i);
+                        total_.subtract(*i);
+                        i = set_.erase(i);
+                    } else if (k != b.end() && add.order(*k) > Order::a_below_b) {
+                        add = add.envelope(*k++);
+                    } else {
+                        break;
+                    }
+                }
+
+                node.value() = add;
+                total_.add(add);
+                set_.insert(i, std::move(node));
+
             }
+
             return *this;
+
         }
 
         template <IntervalCompatible T>
@@ -311,9 +607,8 @@ namespace RS::Interval {
 
         template <IntervalCompatible T>
         IntervalSet<T>& IntervalSet<T>::apply_difference(const IntervalSet& b) {
-            for (const auto& in: b) {
-                erase(in);
-            }
+            auto set = set_difference(b);
+            swap(set);
             return *this;
         }
 
@@ -329,10 +624,8 @@ namespace RS::Interval {
 
         template <IntervalCompatible T>
         IntervalSet<T>& IntervalSet<T>::apply_symmetric_difference(const IntervalSet& b) {
-            auto set1 = set_difference(b);
-            auto set2 = b.set_difference(*this);
-            auto set3 = set1.set_union(set2);
-            swap(set3);
+            auto set = set_symmetric_difference(b);
+            swap(set);
             return *this;
         }
 
@@ -382,6 +675,7 @@ namespace RS::Interval {
     }
 
     template <IntervalCompatible T> auto set_intersection(const IntervalSet<T>& a, const IntervalSet<T>& b) { return a.set_intersection(b); }
+    template <IntervalCompatible T> auto set_intersection(const IntervalSet<T>& a, const IntervalSet<T>& b, std::size_t threads) { return a.set_intersection(b, threads); }
     template <IntervalCompatible T> auto set_intersection(const IntervalSet<T>& a, const Interval<T>& b) { return a.set_intersection(b); }
     template <IntervalCompatible T> auto set_intersection(const Interval<T>& a, const IntervalSet<T>& b) { return a.set_intersection(b); }
     template <IntervalCompatible T> auto set_intersection(const IntervalSet<T>& a, const T& b) { return IntervalSet<T>(a).set_intersection(b); }
@@ -392,6 +686,7 @@ namespace RS::Interval {
     template <IntervalCompatible T> auto set_intersection(const T& a, const T& b) { return IntervalSet<T>(a).set_intersection(b); }
 
     template <IntervalCompatible T> auto set_union(const IntervalSet<T>& a, const IntervalSet<T>& b) { return a.set_union(b); }
+    template <IntervalCompatible T> auto set_union(const IntervalSet<T>& a, const IntervalSet<T>& b, std::size_t threads) { return a.set_union(b, threads); }
     template <IntervalCompatible T> auto set_union(const IntervalSet<T>& a, const Interval<T>& b) { return a.set_union(b); }
     template <IntervalCompatible T> auto set_union(const Interval<T>& a, const IntervalSet<T>& b) { return a.set_union(b); }
     template <IntervalCompatible T> auto set_union(const IntervalSet<T>& a, const T& b) { return IntervalSet<T>(a).set_union(b); }
@@ -402,6 +697,7 @@ namespace RS::Interval {
     template <IntervalCompatible T> auto set_union(const T& a, const T& b) { return IntervalSet<T>(a).set_union(b); }
 
     template <IntervalCompatible T> auto set_difference(const IntervalSet<T>& a, const IntervalSet<T>& b) { return a.set_difference(b); }
+    template <IntervalCompatible T> auto set_difference(const IntervalSet<T>& a, const IntervalSet<T>& b, std::size_t threads) { return a.set_difference(b, threads); }
     template <IntervalCompatible T> auto set_difference(const IntervalSet<T>& a, const Interval<T>& b) { return a.set_difference(b); }
     template <IntervalCompatible T> auto set_difference(const Interval<T>& a, const IntervalSet<T>& b) { return a.set_difference(b); }
     template <IntervalCompatible T> auto set_difference(const IntervalSet<T>& a, const T& b) { return IntervalSet<T>(a).set_difference(b); }
@@ -412,6 +708,7 @@ namespace RS::Interval {
     template <IntervalCompatible T> auto set_difference(const T& a, const T& b) { return IntervalSet<T>(a).set_difference(b); }
 
     template <IntervalCompatible T> auto set_symmetric_difference(const IntervalSet<T>& a, const IntervalSet<T>& b) { return a.set_symmetric_difference(b); }
+    template <IntervalCompatible T> auto set_symmetric_difference(const IntervalSet<T>& a, const IntervalSet<T>& b, std::size_t threads) { return a.set_symmetric_difference(b, threads); }
     template <IntervalCompatible T> auto set_symmetric_difference(const IntervalSet<T>& a, const Interval<T>& b) { return a.set_symmetric_difference(b); }
     template <IntervalCompatible T> auto set_symmetric_difference(const Interval<T>& a, const IntervalSet<T>& b) { return a.set_symmetric_difference(b); }
     template <IntervalCompatible T> auto set_symmetric_difference(const IntervalSet<T>& a, const T& b) { return IntervalSet<T>(a).set_symmetric_difference(b); }
@@ -421,6 +718,115 @@ namespace RS::Interval {
     template <IntervalCompatible T> auto set_symmetric_difference(const T& a, const Interval<T>& b) { return IntervalSet<T>(a).set_symmetric_difference(b); }
     template <IntervalCompatible T> auto set_symmetric_difference(const T& a, const T& b) { return IntervalSet<T>(a).set_symmetric_difference(b); }
 
+    // Queries over multiple sets
+
+    template <std::ranges::forward_range R, Primitive T = typename std::ranges::range_value_t<R>::value_type>
+    Interval<T> find_common_gap(const R& sets, const std::type_identity_t<T>& from,
+            Detail::measure_type<T> length, std::size_t k) {
+
+        using P = Detail::SweepPoint<T>;
+        using set_iterator = std::ranges::iterator_t<const std::ranges::range_value_t<R>>;
+
+        if (length <= Detail::measure_type<T>() || k == 0) {
+            throw std::invalid_argument("Common gap length and count must be positive");
+        }
+
+        // Each cursor walks the gaps between one set's intervals, clipped to
+        // the search range, without building the complement
+
+        struct cursor {
+            set_iterator next;
+            set_iterator end;
+            P start;
+            bool done;
+        };
+
+        Interval<T> floor(from, T(), Bound::closed, Bound::unbound);
+        std::vector<cursor> cursors;
+
+        for (auto& set: sets) {
+            cursors.push_back({std::ranges::begin(set), std::ranges::end(set), {{}, -1, false}, false});
+        }
+
+        auto next_gap = [&floor] (cursor& c, Interval<T>& gap) {
+            while (! c.done) {
+                auto stop = c.next == c.end ? P{{}, 1, false} : Detail::lower_point(*c.next);
+                gap = c.start < stop ? Detail::interval_between(c.start, stop).set_intersection(floor) : Interval<T>();
+                if (c.next == c.end) {
+                    c.done = true;
+                } else {
+                    c.start = Detail::upper_point(*c.next++);
+                    c.done = c.start.rank > 0;
+                }
+                if (! gap.empty()) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // The gaps from all the sets are visited in order of their lower
+        // bounds. The best window can always start at the start of a gap:
+        // when a window starting there is not contained in the gap itself,
+        // it was already available at an earlier start. The second heap
+        // holds the upper bounds of the gaps that might still contain a
+        // window; once a gap ends below the current window it ends below
+        // every later one too, and can be discarded.
+
+        using candidate = std::pair<Interval<T>, std::size_t>;
+
+        auto later_start = [] (const candidate& a, const candidate& b) { return Detail::lower_point(b.first) < Detail::lower_point(a.first); };
+        auto earlier_end = [] (const P& a, const P& b) { return b < a; };
+        std::priority_queue<candidate, std::vector<candidate>, decltype(later_start)> gaps(later_start);
+        std::priority_queue<P, std::vector<P>, decltype(earlier_end)> ends(earlier_end);
+        Interval<T> gap;
+
+        for (std::size_t r = 0; r < cursors.size(); ++r) {
+            if (next_gap(cursors[r], gap)) {
+                gaps.push({gap, r});
+            }
+        }
+
+        while (! gaps.empty()) {
+
+            auto [current, r] = gaps.top();
+            gaps.pop();
+
+            if (next_gap(cursors[r], gap)) {
+                gaps.push({gap, r});
+            }
+
+            if (current.size() < length) {
+                continue;
+            }
+
+            Interval<T> window;
+
+            if constexpr (Integral<T>) {
+                using U = std::make_unsigned_t<T>;
+                auto lo = current.is_left_open() ? static_cast<T>(current.min() + 1) : current.min();
+                window = Interval<T>(lo, static_cast<T>(static_cast<U>(static_cast<U>(lo) + static_cast<U>(length - 1))));
+            } else {
+                window = Interval<T>(current.min(), current.min() + length, current.left(), Bound::open);
+            }
+
+            auto top = Detail::upper_point(window);
+            ends.push(Detail::upper_point(current));
+
+            while (ends.top() < top) {
+                ends.pop();
+            }
+
+            if (ends.size() >= k) {
+                return window;
+            }
+
+        }
+
+        return {};
+
+    }
+
 }
 
 template <RS::Interval::IntervalCompatible T>
@@ -0,0 +1,252 @@
+#pragma once
+
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Assumed size of a cache line, used to keep data guarded by
+        // different locks apart
+
+        inline constexpr std::size_t cache_line_size = 64;
+
+    }
+
+    // Sharded interval set
+
+    template <IntervalCompatible T>
+    class ShardedIntervalSet {
+
+    public:
+
+        class iterator;
+
+        using interval_type = Interval<T>;
+        using value_type = T;
+
+        static constexpr auto category = interval_category<T>;
+
+        ShardedIntervalSet(): ShardedIntervalSet(std::vector<T>()) {}
+        explicit ShardedIntervalSet(const std::vector<T>& splits);
+        ShardedIntervalSet(const ShardedIntervalSet&) = delete;
+        ShardedIntervalSet(ShardedIntervalSet&&) = delete;
+        ~ShardedIntervalSet() = default;
+        ShardedIntervalSet& operator=(const ShardedIntervalSet&) = delete;
+        ShardedIntervalSet& operator=(ShardedIntervalSet&&) = delete;
+
+        bool operator[](const T& t) const { return contains(t); }
+
+        iterator begin() const;
+        iterator end() const { return {}; }
+        bool empty() const;
+        std::size_t shards() const noexcept { return shards_.size(); }
+        interval_type shard_range(std::size_t i) const { return shards_[i].range; }
+        bool contains(const T& t) const;
+        IntervalSet<T> to_set() const;
+        void clear();
+        void insert(const interval_type& in);
+        void erase(const interval_type& in);
+
+    private:
+
+        // Each shard covers a fixed range of the key domain, and holds the
+        // parts of the set's intervals that lie in that range. An interval
+        // that crosses a shard boundary is stored as one piece in each shard.
+        // Operations that touch several shards lock them in ascending order,
+        // so they cannot deadlock. The shards are aligned to cache lines so
+        // that writers on different shards do not share one.
+
+        struct alignas(Detail::cache_line_size) shard {
+            mutable std::mutex mutex;
+            IntervalSet<T> set;
+            interval_type range;
+        };
+
+        std::vector<T> splits_;
+        std::vector<shard> shards_;
+
+        std::vector<interval_type> coalesced() const;
+        std::size_t shard_index(const T& t) const;
+        std::pair<std::size_t, std::size_t> shards_overlapping(const interval_type& in) const;
+        std::vector<std::unique_lock<std::mutex>> lock_shards(std::size_t i, std::size_t j) const;
+
+    };
+
+        template <IntervalCompatible T>
+        class ShardedIntervalSet<T>::iterator {
+
+        public:
+
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::forward_iterator_tag;
+            using pointer = const Interval<T>*;
+            using reference = const Interval<T>&;
+            using value_type = Interval<T>;
+
+            iterator() = default;
+
+            reference operator*() const noexcept { return (*list_)[pos_]; }
+            pointer operator->() const noexcept { return &**this; }
+            iterator& operator++() noexcept { ++pos_; return *this; }
+            iterator operator++(int) noexcept { auto i = *this; ++*this; return i; }
+
+            friend bool operator==(const iterator& i, const iterator& j) noexcept {
+                return i.at_end() || j.at_end() ? i.at_end() == j.at_end() : i.list_ == j.list_ && i.pos_ == j.pos_;
+            }
+
+        private:
+
+            friend class ShardedIntervalSet;
+
+            // The iterator walks a coalesced snapshot of the set, taken
+            // under every shard's lock when iteration begins, so writers on
+            // other threads cannot invalidate it
+
+            std::shared_ptr<const std::vector<Interval<T>>> list_;
+            std::size_t pos_ = 0;
+
+            explicit iterator(std::shared_ptr<const std::vector<Interval<T>>> list) noexcept: list_(std::move(list)) {}
+
+            bool at_end() const noexcept { return ! list_ || pos_ == list_->size(); }
+
+        };
+
+        template <IntervalCompatible T>
+        ShardedIntervalSet<T>::ShardedIntervalSet(const std::vector<T>& splits):
+        splits_(splits), shards_(splits.size() + 1) {
+
+            if (std::ranges::adjacent_find(splits_, std::ranges::greater_equal()) != splits_.end()) {
+                throw std::invalid_argument("Shard boundaries are not in ascending order");
+            }
+
+            auto n = splits_.size();
+
+            if (n == 0) {
+                shards_[0].range = interval_type::all();
+                return;
+            }
+
+            shards_[0].range = interval_type(splits_[0], splits_[0], "<");
+
+            for (std::size_t k = 1; k < n; ++k) {
+                shards_[k].range = interval_type(splits_[k - 1], splits_[k], "[)");
+            }
+
+            shards_[n].range = interval_type(splits_[n - 1], splits_[n - 1], ">=");
+
+        }
+
+        template <IntervalCompatible T>
+        typename ShardedIntervalSet<T>::iterator ShardedIntervalSet<T>::begin() const {
+            return iterator(std::make_shared<const std::vector<interval_type>>(coalesced()));
+        }
+
+        template <IntervalCompatible T>
+        bool ShardedIntervalSet<T>::empty() const {
+            auto locks = lock_shards(0, shards_.size());
+            return std::ranges::all_of(shards_, [] (const shard& s) { return s.set.empty(); });
+        }
+
+        template <IntervalCompatible T>
+        bool ShardedIntervalSet<T>::contains(const T& t) const {
+            auto& s = shards_[shard_index(t)];
+            std::lock_guard lock(s.mutex);
+            return s.set.contains(t);
+        }
+
+        template <IntervalCompatible T>
+        IntervalSet<T> ShardedIntervalSet<T>::to_set() const {
+            auto list = coalesced();
+            return IntervalSet<T>(list.begin(), list.end());
+        }
+
+        template <IntervalCompatible T>
+        void ShardedIntervalSet<T>::clear() {
+            auto locks = lock_shards(0, shards_.size());
+            for (auto& s: shards_) {
+                s.set.clear();
+            }
+        }
+
+        template <IntervalCompatible T>
+        void ShardedIntervalSet<T>::insert(const interval_type& in) {
+            auto [i,j] = shards_overlapping(in);
+            auto locks = lock_shards(i, j);
+            for (auto k = i; k < j; ++k) {
+                shards_[k].set.insert(in.set_intersection(shards_[k].range));
+            }
+        }
+
+        template <IntervalCompatible T>
+        void ShardedIntervalSet<T>::erase(const interval_type& in) {
+            auto [i,j] = shards_overlapping(in);
+            auto locks = lock_shards(i, j);
+            for (auto k = i; k < j; ++k) {
+                shards_[k].set.erase(in);
+            }
+        }
+
+        template <IntervalCompatible T>
+        std::vector<Interval<T>> ShardedIntervalSet<T>::coalesced() const {
+
+            // The pieces of an interval that crosses shard boundaries touch
+            // each other across the boundaries, and are joined again here
+
+            auto locks = lock_shards(0, shards_.size());
+            std::vector<interval_type> list;
+
+            for (auto& s: shards_) {
+                for (auto& in: s.set) {
+                    if (! list.empty() && list.back().touches(in)) {
+                        list.back() = list.back().envelope(in);
+                    } else {
+                        list.push_back(in);
+                    }
+                }
+            }
+
+            return list;
+
+        }
+
+        template <IntervalCompatible T>
+        std::size_t ShardedIntervalSet<T>::shard_index(const T& t) const {
+            return static_cast<std::size_t>(std::ranges::upper_bound(splits_, t) - splits_.begin());
+        }
+
+        template <IntervalCompatible T>
+        std::pair<std::size_t, std::size_t> ShardedIntervalSet<T>::shards_overlapping(const interval_type& in) const {
+
+            if (in.empty()) {
+                return {0, 0};
+            }
+
+            auto i = std::ranges::partition_point(shards_, [&in] (const shard& s) { return in.order(s.range) >= Order::b_touches_a; });
+            auto j = std::ranges::partition_point(shards_, [&in] (const shard& s) { return in.order(s.range) > Order::a_touches_b; });
+
+            return {static_cast<std::size_t>(i - shards_.begin()), static_cast<std::size_t>(j - shards_.begin())};
+
+        }
+
+        template <IntervalCompatible T>
+        std::vector<std::unique_lock<std::mutex>> ShardedIntervalSet<T>::lock_shards(std::size_t i, std::size_t j) const {
+            std::vector<std::unique_lock<std::mutex>> locks;
+            locks.reserve(j - i);
+            for (auto k = i; k < j; ++k) {
+                locks.emplace_back(shards_[k].mutex);
+            }
+            return locks;
+        }
+
+}
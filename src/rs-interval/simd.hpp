@@ -0,0 +1,237 @@
+// This header is private to the implementation and should not be included by users
+
+#pragma once
+
+#include "rs-interval/eytzinger.hpp"
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define RS_INTERVAL_SIMD_X86 1
+    #include <immintrin.h>
+#else
+    #define RS_INTERVAL_SIMD_X86 0
+#endif
+
+namespace RS::Interval {
+
+    namespace Detail {
+
+        // Cache line aligned storage for the structure-of-arrays layouts
+
+        inline constexpr std::size_t simd_alignment = 64;
+
+        template <typename T>
+        struct AlignedAllocator {
+
+            using value_type = T;
+
+            AlignedAllocator() = default;
+            template <typename U> AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+            T* allocate(std::size_t n) {
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(simd_alignment)));
+            }
+
+            void deallocate(T* p, std::size_t /*n*/) noexcept {
+                ::operator delete(p, std::align_val_t(simd_alignment));
+            }
+
+            template <typename U> bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+
+        };
+
+        template <typename T>
+        using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+        // Membership tables over inclusive bounds. Interval i covers x if
+        // lo[i] <= x <= hi[i], with lo strictly ascending. The intervals are
+        // divided into fixed size blocks, and the first lower bound of each
+        // block is indexed in Eytzinger order, alongside the block number of
+        // each slot. Both bound arrays are followed by at least one block of
+        // padding, with lo padded with the largest value of the type, so that
+        // a kernel can always read a whole block.
+
+        inline constexpr std::size_t membership_block = 32;
+
+        template <typename T>
+        struct MembershipTable {
+            const T* lo = nullptr;
+            const T* hi = nullptr;
+            std::size_t size = 0;
+            const T* index = nullptr;
+            const std::size_t* block = nullptr;
+            std::size_t blocks = 0;
+        };
+
+        template <typename T>
+        using MembershipKernel = void (*)(const MembershipTable<T>& table, const T* keys, bool* out, std::size_t m);
+
+        template <typename T>
+        concept SimdElement = (std::signed_integral<T> && (sizeof(T) == 4 || sizeof(T) == 8))
+            || std::same_as<T, float> || std::same_as<T, double>;
+
+        template <typename T>
+        void build_membership_index(const T* lo, std::size_t n, AlignedVector<T>& index, AlignedVector<std::size_t>& block) {
+
+            auto blocks = (n + membership_block - 1) / membership_block;
+            auto layout = eytzinger_layout(blocks);
+
+            index.assign(blocks + 1, T());
+            block.assign(blocks + 1, 0);
+
+            for (std::size_t k = 1; k <= blocks; ++k) {
+                index[k] = lo[layout[k] * membership_block];
+                block[k] = layout[k];
+            }
+
+        }
+
+        // Find the block in which the last interval starting at or below x
+        // lies, returning false if there is none
+
+        template <typename T>
+        bool find_block(const MembershipTable<T>& table, T x, std::size_t& base) noexcept {
+            auto k = eytzinger_upper_bound(table.index, table.blocks, x);
+            auto next = k == 0 ? table.blocks : table.block[k];
+            base = next == 0 ? 0 : (next - 1) * membership_block;
+            return next != 0;
+        }
+
+        // Given the number of lower bounds in the block that are <= x,
+        // check the upper bound of the last one. Counting past the end of
+        // the intervals is safe, since the padding is discounted by clamping
+        // the count to the size.
+
+        template <typename T>
+        bool check_block(const MembershipTable<T>& table, T x, std::size_t base, std::size_t count) noexcept {
+            count = std::min(base + count, table.size);
+            return count > base && x <= table.hi[count - 1];
+        }
+
+        template <typename T>
+        void membership_scalar(const MembershipTable<T>& table, const T* keys, bool* out, std::size_t m) {
+            for (std::size_t k = 0; k < m; ++k) {
+                auto x = keys[k];
+                std::size_t base = 0;
+                std::size_t count = 0;
+                if (find_block(table, x, base)) {
+                    for (std::size_t i = 0; i < membership_block; ++i) {
+                        count += static_cast<std::size_t>(table.lo[base + i] <= x);
+                    }
+                }
+                out[k] = check_block(table, x, base, count);
+            }
+        }
+
+        #if RS_INTERVAL_SIMD_X86
+
+            template <SimdElement T>
+            __attribute__((target("avx2")))
+            void membership_avx2(const MembershipTable<T>& table, const T* keys, bool* out, std::size_t m) {
+
+                static constexpr std::size_t lanes = 32 / sizeof(T);
+
+                for (std::size_t k = 0; k < m; ++k) {
+
+                    auto x = keys[k];
+                    std::size_t base = 0;
+                    std::size_t count = 0;
+
+                    if (find_block(table, x, base)) {
+                        for (std::size_t i = 0; i < membership_block; i += lanes) {
+                            auto p = table.lo + base + i;
+                            if constexpr (std::same_as<T, float>) {
+                                auto le = _mm256_cmp_ps(_mm256_loadu_ps(p), _mm256_set1_ps(x), _CMP_LE_OQ);
+                                count += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(le)));
+                            } else if constexpr (std::same_as<T, double>) {
+                                auto le = _mm256_cmp_pd(_mm256_loadu_pd(p), _mm256_set1_pd(x), _CMP_LE_OQ);
+                                count += std::popcount(static_cast<unsigned>(_mm256_movemask_pd(le)));
+                            } else if constexpr (sizeof(T) == 4) {
+                                auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                                auto gt = _mm256_cmpgt_epi32(v, _mm256_set1_epi32(static_cast<int>(x)));
+                                count += lanes - std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(gt))));
+                            } else {
+                                auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                                auto gt = _mm256_cmpgt_epi64(v, _mm256_set1_epi64x(static_cast<long long>(x)));
+                                count += lanes - std::popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(gt))));
+                            }
+                        }
+                    }
+
+                    out[k] = check_block(table, x, base, count);
+
+                }
+
+            }
+
+            template <SimdElement T>
+            __attribute__((target("avx512f")))
+            void membership_avx512(const MembershipTable<T>& table, const T* keys, bool* out, std::size_t m) {
+
+                static constexpr std::size_t lanes = 64 / sizeof(T);
+
+                for (std::size_t k = 0; k < m; ++k) {
+
+                    auto x = keys[k];
+                    std::size_t base = 0;
+                    std::size_t count = 0;
+
+                    if (find_block(table, x, base)) {
+                        for (std::size_t i = 0; i < membership_block; i += lanes) {
+                            auto p = table.lo + base + i;
+                            if constexpr (std::same_as<T, float>) {
+                                count += std::popcount(static_cast<unsigned>(
+                                    _mm512_cmp_ps_mask(_mm512_loadu_ps(p), _mm512_set1_ps(x), _CMP_LE_OQ)));
+                            } else if constexpr (std::same_as<T, double>) {
+                                count += std::popcount(static_cast<unsigned>(
+                                    _mm512_cmp_pd_mask(_mm512_loadu_pd(p), _mm512_set1_pd(x), _CMP_LE_OQ)));
+                            } else if constexpr (sizeof(T) == 4) {
+                                count += std::popcount(static_cast<unsigned>(
+                                    _mm512_cmple_epi32_mask(_mm512_loadu_si512(p), _mm512_set1_epi32(static_cast<int>(x)))));
+                            } else {
+                                count += std::popcount(static_cast<unsigned>(
+                                    _mm512_cmple_epi64_mask(_mm512_loadu_si512(p), _mm512_set1_epi64(static_cast<long long>(x)))));
+                            }
+                        }
+                    }
+
+                    out[k] = check_block(table, x, base, count);
+
+                }
+
+            }
+
+        #endif
+
+        // Select the best kernel the processor supports, once per type
+
+        template <typename T>
+        MembershipKernel<T> membership_kernel() {
+
+            static const auto kernel = [] () -> MembershipKernel<T> {
+                #if RS_INTERVAL_SIMD_X86
+                    if constexpr (SimdElement<T>) {
+                        __builtin_cpu_init();
+                        if (__builtin_cpu_supports("avx512f")) {
+                            return membership_avx512<T>;
+                        } else if (__builtin_cpu_supports("avx2")) {
+                            return membership_avx2<T>;
+                        }
+                    }
+                #endif
+                return membership_scalar<T>;
+            }();
+
+            return kernel;
+
+        }
+
+    }
+
+}
@@ -172,6 +172,37 @@ namespace RS::Interval {
     template <typename T> concept Arithmetic = Continuous<T> || Integral<T>;
     template <typename T> concept IntervalCompatible = Continuous<T> || Integral<T> || Ordered<T> || Stepwise<T>;
     template <typename T> concept Scalar = Continuous<T> && std::constructible_from<T, int>;
+    template <typename T> concept Primitive = Arithmetic<T> && std::is_arithmetic_v<T>;
+
+    // Combination policies for interval maps. These are called with the
+    // existing value and the inserted value, where an inserted interval
+    // overlaps an existing one.
+
+    struct Overwrite {
+        template <typename T> const T& operator()(const T& /*a*/, const T& b) const noexcept { return b; }
+    };
+
+    struct Sum {
+        template <typename T> T operator()(const T& a, const T& b) const { return a + b; }
+    };
+
+    struct Maximum {
+        template <typename T> const T& operator()(const T& a, const T& b) const { return a < b ? b : a; }
+    };
+
+    struct Minimum {
+        template <typename T> const T& operator()(const T& a, const T& b) const { return b < a ? b : a; }
+    };
+
+    struct BitOr {
+        template <typename T> T operator()(const T& a, const T& b) const { return a | b; }
+    };
+
+    template <typename C, typename T>
+    concept CombinePolicy = std::default_initializable<C> && std::copy_constructible<C>
+        && requires (const C& c, const T& a, const T& b) {
+            { c(a, b) } -> std::convertible_to<T>;
+        };
 
     namespace Detail {
 
@@ -0,0 +1,227 @@
+#include "rs-interval/flat-set.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <print>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<double>;
+using Flat = FlatIntervalSet<double>;
+using Set = IntervalSet<double>;
+
+void test_rs_interval_continuous_flat_set_construct_insert_erase() {
+
+    Flat set, com;
+    std::string str;
+
+    TRY((set = {}));                                  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{}");
+    TRY((set = {{1,2,"()"}}));                        TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{(1,2)}");
+    TRY((set = {{1,2,"()"},{3,4,"()"},{5,6,"()"}}));  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{(1,2),(3,4),(5,6)}");
+    TRY((set = {{1,2,"[)"},{2,3,"[]"},{5,6,"()"}}));  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[1,3],(5,6)}");
+
+    TRY((set = {{1,2,"[)"},{3,4,"(]"},{5,6,"()"}}));
+    TRY(com = set.complement());
+    TRY(str = std::format("{}", set));
+    TEST_EQUAL(str, "{[1,2),(3,4],(5,6)}");
+    TRY(str = std::format("{}", com));
+    TEST_EQUAL(str, "{<1,[2,3],(4,5],>=6}");
+
+    TEST(! set.contains(0.5));  TEST(com.contains(0.5));
+    TEST(set.contains(1.0));    TEST(! com.contains(1.0));
+    TEST(set.contains(1.5));    TEST(! com.contains(1.5));
+    TEST(! set.contains(2.0));  TEST(com.contains(2.0));
+    TEST(! set.contains(2.5));  TEST(com.contains(2.5));
+    TEST(! set.contains(3.0));  TEST(com.contains(3.0));
+    TEST(set.contains(3.5));    TEST(! com.contains(3.5));
+    TEST(set.contains(4.0));    TEST(! com.contains(4.0));
+    TEST(! set.contains(4.5));  TEST(com.contains(4.5));
+    TEST(! set.contains(5.0));  TEST(com.contains(5.0));
+    TEST(set.contains(5.5));    TEST(! com.contains(5.5));
+    TEST(! set.contains(6.0));  TEST(com.contains(6.0));
+    TEST(! set.contains(6.5));  TEST(com.contains(6.5));
+
+    TRY(set.clear());
+    TEST(set.empty());
+
+    TRY((set.insert({10,20})));       TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[10,20]}");
+    TRY((set.insert({20,30,"()"})));  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[10,30)}");
+    TRY((set.erase({5,10,"()"})));    TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[10,30)}");
+    TRY((set.erase({5,10})));         TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{(10,30)}");
+    TRY((set.erase({12,14})));        TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{(10,12),(14,30)}");
+    TRY((set.erase({16,18,"()"})));   TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{(10,12),(14,16],[18,30)}");
+    TRY((set.insert({9,11})));        TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[9,12),(14,16],[18,30)}");
+    TRY((set.insert({29,31,"()"})));  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[9,12),(14,16],[18,31)}");
+
+}
+
+void test_rs_interval_continuous_flat_set_operations() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Flat flat[2], i_flat, u_flat, d_flat, sd_flat;
+    Set set[2], i_set, u_set, d_set, sd_set;
+    std::vector<std::pair<Itv, bool>> ops[2];
+    Itv in;
+    std::minstd_rand rng(42);
+
+    static constexpr int iterations = 1000;
+    static constexpr int max_size = 10;
+    static constexpr int max_value = 50;
+
+    for (int i = 0; i < iterations; ++i) {
+
+        for (int j = 0; j < 2; ++j) {
+
+            TRY(flat[j].clear());
+            TRY(set[j].clear());
+            ops[j].clear();
+            int size = random_int(1, max_size)(rng);
+
+            for (int k = 0; k < size; ++k) {
+
+                auto a = double(random_int(1, max_value)(rng));
+                auto b = double(random_int(1, max_value)(rng));
+                auto l = Bound(random_int(0, 3)(rng));
+                auto r = Bound(random_int(0, 3)(rng));
+
+                if ((l == Bound::empty) == (r == Bound::empty)) {
+                    TRY(in = Itv(a, b, l, r));
+                    bool add = random_int(0, 3)(rng) != 0;
+                    ops[j].push_back({in, add});
+                    if (! add) {
+                        TRY(flat[j].erase(in));
+                        TRY(set[j].erase(in));
+                    } else {
+                        TRY(flat[j].insert(in));
+                        TRY(set[j].insert(in));
+                    }
+                }
+
+            }
+
+            TEST(std::equal(set[j].begin(), set[j].end(), flat[j].begin(), flat[j].end()));
+
+        }
+
+        TRY(i_flat = set_intersection(flat[0], flat[1]));
+        TRY(u_flat = set_union(flat[0], flat[1]));
+        TRY(d_flat = set_difference(flat[0], flat[1]));
+        TRY(sd_flat = set_symmetric_difference(flat[0], flat[1]));
+        TRY(i_set = set_intersection(set[0], set[1]));
+        TRY(u_set = set_union(set[0], set[1]));
+        TRY(d_set = set_difference(set[0], set[1]));
+        TRY(sd_set = set_symmetric_difference(set[0], set[1]));
+
+        TEST_EQUAL(std::format("{}", i_flat), std::format("{}", i_set));
+        TEST_EQUAL(std::format("{}", u_flat), std::format("{}", u_set));
+        TEST_EQUAL(std::format("{}", d_flat), std::format("{}", d_set));
+        TEST_EQUAL(std::format("{}", sd_flat), std::format("{}", sd_set));
+
+        for (int y = 0; y <= 2 * max_value + 2; ++y) {
+
+            auto x = y / 2.0;
+            bool member[2];
+
+            for (int j = 0; j < 2; ++j) {
+                member[j] = false;
+                for (const auto& [item,add]: ops[j]) {
+                    if (item(x)) {
+                        member[j] = add;
+                    }
+                }
+            }
+
+            TEST_EQUAL(flat[0][x], member[0]);
+            TEST_EQUAL(flat[1][x], member[1]);
+            TEST_EQUAL(i_flat[x], member[0] && member[1]);
+            TEST_EQUAL(u_flat[x], member[0] || member[1]);
+            TEST_EQUAL(d_flat[x], member[0] && ! member[1]);
+            TEST_EQUAL(sd_flat[x], member[0] != member[1]);
+
+        }
+
+    }
+
+}
+
+void test_rs_interval_continuous_flat_set_batch_query() {
+
+    Flat set = {{0, 0, "<"}, {1, 2, "()"}, {3, 4, "[]"}, {5, 6, "(]"}, {8, 8, ">="}};
+    std::vector<double> keys = {1, 1.5, 2, 3, 5, 6, -1, 0, 4.5, 100, 7, 8, -0.0, 4};
+    std::vector<double> expect = {1.5, 3, 6, -1, 100, 8, 4};
+    std::vector<double> members;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            std::ranges::sort(keys);
+            std::ranges::sort(expect);
+        }
+        TRY(members = set.filter(keys));
+        TEST(members == expect);
+    }
+
+}
+
+void test_rs_interval_continuous_flat_set_measure() {
+
+    static constexpr auto inf = std::numeric_limits<double>::infinity();
+
+    Flat set;
+
+    TEST_EQUAL(set.measure(), 0.0);
+    TEST_EQUAL(set.measure(Itv::all()), 0.0);
+
+    TRY((set = {{1,2,"()"}, {3,5.5,"[]"}, {7,7}, {8,9.5}}));
+    TEST_EQUAL(set.measure(), 5.0);
+    TEST_EQUAL(set.measure(Itv(1.5,4)), 1.5);
+    TEST_EQUAL(set.measure(Itv(1.5,9)), 4.0);
+    TEST_EQUAL(set.measure(Itv(6,7.5)), 0.0);
+    TEST_EQUAL(set.measure(Itv()), 0.0);
+
+    TRY(set.insert(Itv(1.5,3.25)));
+    TEST_EQUAL(set.measure(), 6.0);
+    TRY(set.erase(Itv(2,3,"()")));
+    TEST_EQUAL(set.measure(), 5.0);
+    TRY(set.insert(Itv(10,10,">")));
+    TEST_EQUAL(set.measure(), inf);
+    TEST_EQUAL(set.measure(Itv(0,12.5)), 7.5);
+    TEST_EQUAL(set.measure(Itv(0,0,">")), inf);
+    TRY(set.apply_complement());
+    TEST_EQUAL(set.measure(), inf);
+    TEST_EQUAL(set.measure(Itv(0,10)), 5.0);
+
+    Set ref(set.begin(), set.end());
+    TEST_EQUAL(ref.measure(Itv(0,10)), set.measure(Itv(0,10)));
+    TEST_EQUAL(Flat(ref).measure(Itv(-5,5)), set.measure(Itv(-5,5)));
+
+}
+
+void test_rs_interval_continuous_flat_set_measure_cancellation() {
+
+    // The total within a bounding interval is taken from the difference of
+    // two prefix sums, which must not lose the small lengths that follow a
+    // huge interval
+
+    Flat set;
+
+    TRY((set = {{-1e20,-10}, {0,0.125}, {1,1.25}, {2,2.5}, {3,3.5}}));
+    TEST_EQUAL(set.measure(Itv(-1,4)), 1.375);
+    TEST_EQUAL(set.measure(Itv(0.0625,3.25)), 1.0625);
+    TEST_EQUAL(set.measure(Itv(1.125,2.25)), 0.375);
+
+    TRY(set.insert(Itv(10,1e20)));
+    TEST_EQUAL(set.measure(Itv(-1,4)), 1.375);
+    TRY(set.erase(Itv(10,1e20)));
+    TRY(set.erase(Itv(-1e20,-10)));
+    TEST_EQUAL(set.measure(), 1.375);
+
+}
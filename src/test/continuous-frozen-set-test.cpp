@@ -0,0 +1,93 @@
+#include "rs-interval/frozen-set.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/simd.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace RS::Interval;
+
+namespace {
+
+    template <typename T>
+    void check_frozen_set() {
+
+        using random_int = std::uniform_int_distribution<int>;
+
+        static constexpr T inf = std::numeric_limits<T>::infinity();
+
+        std::minstd_rand rng(42);
+
+        for (int size: {0, 1, 2, 5, 20, 100, 300, 1000}) {
+
+            IntervalSet<T> set;
+
+            for (int k = 0; k < size; ++k) {
+                T a = static_cast<T>(random_int(-2000, 2000)(rng)) / 4;
+                T b = a + static_cast<T>(random_int(0, 8)(rng)) / 4;
+                int mode = random_int(0, 49)(rng);
+                if (mode == 0) {
+                    set.insert(Interval<T>(a, Bound::unbound, Bound(random_int(1, 2)(rng))));
+                } else if (mode == 1) {
+                    set.insert(Interval<T>(a, Bound(random_int(1, 2)(rng)), Bound::unbound));
+                } else {
+                    set.insert(Interval<T>(a, b, Bound(random_int(1, 2)(rng)), Bound(random_int(1, 2)(rng))));
+                }
+            }
+
+            std::vector<T> keys = {-inf, inf, T(-0.0), T(0)};
+
+            for (int k = 0; k < 1000; ++k) {
+                T x = static_cast<T>(random_int(-2100, 2100)(rng)) / 8;
+                keys.push_back(x);
+                keys.push_back(std::nextafter(x, inf));
+                keys.push_back(std::nextafter(x, - inf));
+            }
+
+            FrozenIntervalSet<T> frozen(set);
+            TEST(! frozen.contains(std::numeric_limits<T>::quiet_NaN()));
+            TEST_EQUAL(std::format("{}", frozen), std::format("{}", set));
+            TEST(frozen.to_set() == set);
+
+            auto out = std::make_unique<bool[]>(keys.size());
+            TRY(frozen.contains_batch(keys, {out.get(), keys.size()}));
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                TEST_EQUAL(out[k], set.contains(keys[k]));
+            }
+
+        }
+
+    }
+
+}
+
+void test_rs_interval_continuous_frozen_set_construction() {
+
+    IntervalSet<double> set;
+    FrozenIntervalSet<double> frozen;
+    std::string str;
+
+    TRY((set = {{1,2,"()"}, {3,4,"[)"}, {5,5,">"}}));
+    TRY(frozen = FrozenIntervalSet<double>(set));
+    TEST_EQUAL(frozen.size(), 3u);
+    TRY(str = std::format("{}", frozen));
+    TEST_EQUAL(str, "{(1,2),[3,4),>5}");
+
+}
+
+void test_rs_interval_continuous_frozen_set_membership() {
+
+    check_frozen_set<float>();
+    check_frozen_set<double>();
+    check_frozen_set<long double>();
+
+}
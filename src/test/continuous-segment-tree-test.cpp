@@ -0,0 +1,48 @@
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/segment-tree.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <format>
+#include <stdexcept>
+
+using namespace RS::Interval;
+
+using Itv = Interval<double>;
+using Tree = IntervalSegmentTree<double, int>;
+
+void test_rs_interval_continuous_segment_tree() {
+
+    Tree tree;
+
+    TEST_EQUAL(tree.size(), 1u);
+    TEST_EQUAL(tree[42], 0);
+
+    TRY(tree.add(Itv(0,10,"[)"), 2));
+    TRY(tree.add(Itv(5,15,"[]"), 3));
+    TRY(tree.add(Itv(20,20,">"), 1));
+    TEST_EQUAL(std::format("{}", tree.to_map()), "{[0,5):2,[5,10):5,[10,15]:3,>20:1}");
+    TEST_EQUAL(tree[-1], 0);
+    TEST_EQUAL(tree[0], 2);
+    TEST_EQUAL(tree[4.999], 2);
+    TEST_EQUAL(tree[5], 5);
+    TEST_EQUAL(tree[10], 3);
+    TEST_EQUAL(tree[15], 3);
+    TEST_EQUAL(tree[15.001], 0);
+    TEST_EQUAL(tree[20], 0);
+    TEST_EQUAL(tree[20.001], 1);
+
+    TEST_EQUAL(tree.sum(Itv(0,20)), 10.0 + 25.0 + 15.0);
+    TEST_EQUAL(tree.sum(Itv(2.5,7.5)), 5.0 + 12.5);
+    TEST_EQUAL(tree.sum(Itv(10,10)), 0.0);
+    TEST_EQUAL(tree.sum(Itv(19,21)), 1.0);
+    TEST_EQUAL(tree.max(Itv(0,20)), 5);
+    TEST_EQUAL(tree.max(Itv(10,20,"(]")), 3);
+    TEST_EQUAL(tree.max(Itv(10,20,"()")), 3);
+    TEST_EQUAL(tree.max(Itv(15,20,"(]")), 0);
+    TEST_EQUAL(tree.min(Itv(0,15)), 2);
+    TEST_EQUAL(tree.min(Itv::all()), 0);
+    TEST_EQUAL(tree.max(Itv::all()), 5);
+    TEST_THROW(tree.sum(Itv(0,0,">=")), std::invalid_argument, "unbounded");
+
+}
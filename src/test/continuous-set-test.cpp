@@ -3,6 +3,7 @@
 #include "rs-interval/types.hpp"
 #include "test/unit-test.hpp"
 #include <format>
+#include <limits>
 #include <print>
 #include <random>
 #include <string>
@@ -231,3 +232,161 @@ void test_rs_interval_continuous_set_operations() {
     }
 
 }
+
+void test_rs_interval_continuous_set_bulk_construction() {
+
+    Set set;
+    std::vector<Itv> vec = {
+        {5, 6, "()"},
+        {1, 2, "[)"},
+        {2, 3, "()"},
+        {3, 4, "[]"},
+        {6, 7, "()"},
+        {10, 10, "[]"},
+        {0, 0, "<"},
+        {},
+    };
+
+    TRY(set = Set(vec.begin(), vec.end()));
+    TEST_EQUAL(std::format("{}", set), "{<0,[1,2),(2,4],(5,6),(6,7),10}");
+
+}
+
+void test_rs_interval_continuous_set_bulk_construction_large() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Set expect, set;
+    std::vector<Itv> vec;
+    Itv in;
+    std::minstd_rand rng(86);
+
+    static constexpr int iterations = 20;
+    static constexpr int size = 2000;
+    static constexpr int max_value = 1000;
+
+    for (int i = 0; i < iterations; ++i) {
+
+        TRY(expect.clear());
+        vec.clear();
+
+        for (int k = 0; k < size; ++k) {
+            double a = random_int(- max_value, max_value)(rng) / 4.0;
+            double b = a + random_int(0, 4)(rng) / 4.0;
+            if (a == 0 && random_int(0, 1)(rng) == 0) {
+                a = -0.0;
+            }
+            int mode = random_int(0, 99)(rng);
+            if (mode == 0) {
+                TRY(in = Itv(a, Bound::unbound, Bound(random_int(1, 2)(rng))));
+            } else if (mode == 1) {
+                TRY(in = Itv(a, Bound(random_int(1, 2)(rng)), Bound::unbound));
+            } else {
+                TRY(in = Itv(a, b, Bound(random_int(1, 2)(rng)), Bound(random_int(1, 2)(rng))));
+            }
+            vec.push_back(in);
+            TRY(expect.insert(in));
+        }
+
+        TRY(set = Set(vec.begin(), vec.end()));
+        TEST_EQUAL(set, expect);
+
+    }
+
+}
+
+void test_rs_interval_continuous_set_measure() {
+
+    static constexpr auto inf = std::numeric_limits<double>::infinity();
+
+    Set set;
+
+    TEST_EQUAL(set.measure(), 0.0);
+    TEST_EQUAL(set.measure(Itv::all()), 0.0);
+
+    TRY((set = {{1,2,"()"}, {3,5.5,"[]"}, {7,7}}));
+    TEST_EQUAL(set.measure(), 3.5);
+    TEST_EQUAL(set.measure(Itv(1.5,4)), 1.5);
+    TEST_EQUAL(set.measure(Itv(6,10)), 0.0);
+    TEST_EQUAL(set.measure(Itv()), 0.0);
+
+    TRY(set.insert(Itv(1.5,3.25)));
+    TEST_EQUAL(set.measure(), 4.5);
+    TRY(set.erase(Itv(2,3,"()")));
+    TEST_EQUAL(set.measure(), 3.5);
+    TRY(set.insert(Itv(10,10,">")));
+    TEST_EQUAL(set.measure(), inf);
+    TEST_EQUAL(set.measure(Itv(0,12.5)), 6.0);
+    TEST_EQUAL(set.measure(Itv(0,0,">")), inf);
+    TRY(set.apply_difference(Itv(10,10,">")));
+    TEST_EQUAL(set.measure(), 3.5);
+    TRY(set.apply_union(Set{{2,3}, {20,21}}));
+    TEST_EQUAL(set.measure(), 5.5);
+    TRY(set.apply_complement());
+    TEST_EQUAL(set.measure(), inf);
+    TEST_EQUAL(set.measure(Itv(0,10)), 5.5);
+
+}
+
+void test_rs_interval_continuous_set_common_gap() {
+
+    std::vector<Set> busy = {
+        {{0,10,"[)"}, {20,30,"[)"}},
+        {{5,15,"[)"}, {25,35,"[)"}},
+    };
+
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 5, 1)), "[0,5)");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 5.5, 1)), "[10,15.5)");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 5, 2)), "[15,20)");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 10, 2)), "[35,45)");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, -2.5, 2.5, 2)), "[-2.5,0)");
+
+    std::vector<Set> open = {{{0,10,"[]"}}, {{0,10,"[)"}}};
+    TEST_EQUAL(std::format("{}", find_common_gap(open, 0, 1, 2)), "(10,11)");
+
+}
+
+void test_rs_interval_continuous_set_measure_cancellation() {
+
+    // Adding and removing a huge interval must not wipe out the length of
+    // the small ones around it
+
+    Set set;
+
+    TRY(set.insert(Itv(0,0.1)));
+    TEST_EQUAL(set.measure(), 0.1);
+    TRY(set.insert(Itv(10,1e20)));
+    TEST_EQUAL(set.measure(), 1e20);
+    TRY(set.erase(Itv(10,1e20)));
+    TEST_EQUAL(set.measure(), 0.1);
+
+    for (int i = 0; i < 100; ++i) {
+        TRY(set.insert(Itv(- 1e20 - i, -10)));
+        TRY(set.insert(Itv(1,1.5)));
+        TRY(set.erase(Itv(- 2e20, -5)));
+        TRY(set.erase(Itv(1,1.5)));
+    }
+
+    // Only rounding errors on the scale of the small lengths remain
+
+    TEST_NEAR(set.measure(), 0.1, 1e-15);
+    TRY(set.clear());
+    TRY(set.insert(Itv(0,0.1)));
+    TRY(set.insert(Itv(-1e20,-10)));
+    TRY(set.insert(Itv(1,1.25)));
+    TEST_EQUAL(set.measure(Itv(-1,2)), 0.1 + 0.25);
+    TRY(set.apply_difference(Itv(-1e20,-10)));
+    TEST_EQUAL(set.measure(), 0.1 + 0.25);
+
+    // The total within a bounding interval is taken from the subtree
+    // totals, which must not lose the small lengths beside a huge interval
+
+    TRY((set = {{-1e20,-10}, {0,0.125}, {1,1.25}, {2,2.5}, {3,3.5}, {10,1e20}}));
+    TEST_EQUAL(set.measure(Itv(-1,4)), 1.375);
+    TEST_EQUAL(set.measure(Itv(0.0625,3.25)), 1.0625);
+    TEST_EQUAL(set.measure(Itv(1.125,2.25)), 0.375);
+    TRY(set.erase(Itv(10,1e20)));
+    TRY(set.erase(Itv(-1e20,-10)));
+    TEST_EQUAL(set.measure(Itv(-1,4)), 1.375);
+
+}
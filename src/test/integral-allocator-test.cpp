@@ -0,0 +1,165 @@
+#include "rs-interval/allocator.hpp"
+#include "rs-interval/flat-set.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <random>
+#include <string>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Set = IntervalSet<int>;
+using Alloc = IntervalAllocator<int>;
+
+void test_rs_interval_integral_allocator_basics() {
+
+    Alloc alloc;
+    Itv in;
+
+    TEST(alloc.empty());
+    TEST_EQUAL(alloc.size(), 0u);
+    TEST(alloc.largest_gap().empty());
+    TEST(alloc.first_fit(1).empty());
+    TEST(alloc.best_fit(1).empty());
+    TEST(alloc.allocate(1).empty());
+
+    TRY((alloc = Alloc(Set{{0,9}, {20,23}, {30,49}, {60,65}})));
+    TEST_EQUAL(alloc.size(), 4u);
+    TEST_EQUAL(std::format("{}", alloc.to_set()), "{[0,9],[20,23],[30,49],[60,65]}");
+    TEST_EQUAL(std::format("{}", alloc.largest_gap()), "[30,49]");
+    TEST_EQUAL(std::format("{}", alloc.first_fit(1)), "[0,9]");
+    TEST_EQUAL(std::format("{}", alloc.first_fit(10)), "[0,9]");
+    TEST_EQUAL(std::format("{}", alloc.first_fit(11)), "[30,49]");
+    TEST(alloc.first_fit(21).empty());
+    TEST_EQUAL(std::format("{}", alloc.best_fit(1)), "[20,23]");
+    TEST_EQUAL(std::format("{}", alloc.best_fit(5)), "[60,65]");
+    TEST_EQUAL(std::format("{}", alloc.best_fit(7)), "[0,9]");
+    TEST(alloc.best_fit(21).empty());
+
+    TRY(in = alloc.allocate(4));
+    TEST_EQUAL(std::format("{}", in), "[0,3]");
+    TRY(in = alloc.allocate(4, Fit::best));
+    TEST_EQUAL(std::format("{}", in), "[20,23]");
+    TRY(in = alloc.allocate(15));
+    TEST_EQUAL(std::format("{}", in), "[30,44]");
+    TEST_EQUAL(std::format("{}", alloc.to_set()), "{[4,9],[45,49],[60,65]}");
+    TEST(alloc.allocate(7).empty());
+    TEST(alloc.allocate(0).empty());
+    TEST_EQUAL(alloc.size(), 3u);
+
+    TRY(alloc.insert(Itv(0,3)));
+    TRY(alloc.insert(Itv(10,44)));
+    TEST_EQUAL(std::format("{}", alloc.to_set()), "{[0,49],[60,65]}");
+    TEST_EQUAL(std::format("{}", alloc.largest_gap()), "[0,49]");
+    TRY(alloc.erase(Itv(5,62)));
+    TEST_EQUAL(std::format("{}", alloc.to_set()), "{[0,4],[63,65]}");
+    TEST_EQUAL(std::format("{}", alloc.best_fit(1)), "[63,65]");
+    TRY(alloc.clear());
+    TEST(alloc.empty());
+
+    TRY(alloc.insert(Itv(100,100,">=")));
+    TEST_EQUAL(std::format("{}", alloc.largest_gap()), ">=100");
+    TRY(in = alloc.allocate(10, Fit::best));
+    TEST_EQUAL(std::format("{}", in), "[100,109]");
+    TEST_EQUAL(std::format("{}", alloc.to_set()), "{>=110}");
+
+    IntervalAllocator<std::uint8_t> small(IntervalSet<std::uint8_t>(Interval<std::uint8_t>::all()));
+    TEST(small.first_fit(256) == Interval<std::uint8_t>::all());
+    TEST(small.first_fit(257).empty());
+    TRY(small.allocate(200));
+    TRY(small.allocate(56));
+    TEST(small.empty());
+
+    IntervalAllocator<std::uint64_t> wide(FlatIntervalSet<std::uint64_t>(Interval<std::uint64_t>::all()));
+    TEST_EQUAL(std::format("{}", wide.allocate(npos)), std::format("[0,{}]", npos - 1));
+    TEST_EQUAL(wide.size(), 1u);
+    TEST_EQUAL(std::format("{}", wide.largest_gap()), std::format(">={}", npos));
+
+}
+
+void test_rs_interval_integral_allocator_random() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 10'000;
+    static constexpr int range = 1000;
+
+    Alloc alloc;
+    Set ref;
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 50)(rng);
+        auto n = static_cast<std::size_t>(random_int(1, 60)(rng));
+
+        switch (random_int(0, 3)(rng)) {
+
+            case 0: {
+                TRY(alloc.erase(Itv(a, b)));
+                TRY(ref.erase(Itv(a, b)));
+                break;
+            }
+
+            case 1: {
+
+                // Allocation takes the bottom of the chosen gap
+
+                auto fit = random_int(0, 1)(rng) == 0 ? Fit::first : Fit::best;
+                Itv expect;
+
+                for (auto& x: ref) {
+                    if (x.size() >= n && (expect.empty() || (fit == Fit::best && x.size() < expect.size()))) {
+                        expect = x;
+                        if (fit == Fit::first) {
+                            break;
+                        }
+                    }
+                }
+
+                Itv block;
+                TRY(block = alloc.allocate(n, fit));
+
+                if (expect.empty()) {
+                    TEST(block.empty());
+                } else {
+                    TEST_EQUAL(block, Itv(expect.min(), expect.min() + static_cast<int>(n) - 1));
+                    TRY(ref.erase(block));
+                }
+
+                break;
+
+            }
+
+            default: {
+                TRY(alloc.insert(Itv(a, b)));
+                TRY(ref.insert(Itv(a, b)));
+                break;
+            }
+
+        }
+
+        TEST_EQUAL(alloc.size(), ref.size());
+
+        std::size_t largest = 0;
+
+        for (auto& x: ref) {
+            largest = std::max(largest, x.size());
+        }
+
+        TEST_EQUAL(alloc.largest_gap().size(), largest);
+
+        if (i % 100 == 0) {
+            TEST_EQUAL(alloc.to_set(), ref);
+        }
+
+    }
+
+}
@@ -0,0 +1,136 @@
+#include "rs-interval/concurrent-map.hpp"
+#include "rs-interval/frozen-map.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <atomic>
+#include <format>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Map = IntervalMap<int, std::string>;
+using Concurrent = ConcurrentIntervalMap<int, std::string>;
+
+void test_rs_interval_integral_concurrent_map_basics() {
+
+    static_assert(std::same_as<Concurrent::snapshot_type, FrozenIntervalMap<int, std::string>>);
+
+    Concurrent map("x");
+    std::shared_ptr<const Concurrent::snapshot_type> snap;
+
+    TEST_EQUAL(map.version(), 1u);
+    TEST_EQUAL(map[42], "x");
+    TEST(! map.contains(42));
+    TRY(snap = map.snapshot());
+    TEST(snap->empty());
+
+    // Changes are not visible until they are published
+
+    TRY(map.insert(Itv(1,10), "a"));
+    TRY(map.insert(Itv(21,30), "b"));
+    TEST_EQUAL(map[5], "x");
+    TEST_EQUAL(map.version(), 1u);
+    TRY(map.publish());
+    TEST_EQUAL(map.version(), 2u);
+    TEST_EQUAL(map[5], "a");
+    TEST_EQUAL(map[25], "b");
+    TEST(map.contains(30));
+    TEST(! map.contains(31));
+    TEST(snap->empty());
+
+    TRY(map.erase(Itv(5,25)));
+    TRY(map.update([] (Map& m) { m.insert(Itv(40,50), "c"); }));
+    TEST_EQUAL(map.version(), 3u);
+    TRY(snap = map.snapshot());
+    TEST_EQUAL(std::format("{}", snap->to_map()), "{[1,4]:a,[26,30]:b,[40,50]:c}");
+    TEST_EQUAL(snap->default_value(), "x");
+
+    auto found = map.find(27);
+    TEST(found);
+    TEST_EQUAL(std::format("{}", found->first), "[26,30]");
+    TEST_EQUAL(found->second, "b");
+    TEST(! map.find(31));
+
+    Concurrent::reader reader(map);
+    TEST_EQUAL(reader[3], "a");
+    auto held = reader[45];
+    TEST_EQUAL(held, "c");
+    TEST(! reader.contains(6));
+    TRY(found = reader.find(42));
+    TEST(found);
+    TEST_EQUAL(std::format("{}", found->first), "[40,50]");
+    TEST(! reader.find(6));
+
+    // Results copied out of a reader survive the snapshot being replaced
+
+    TRY(map.update([] (Map& m) { m.insert(Itv(1,100), "d"); }));
+    TEST_EQUAL(reader[3], "d");
+    TEST_EQUAL(held, "c");
+    TEST_EQUAL(found->second, "c");
+    TRY(found = reader.find(6));
+    TEST(found);
+    TEST_EQUAL(std::format("{}", found->first), "[1,100]");
+    TEST_EQUAL(reader.snapshot().size(), 1u);
+    TEST_EQUAL(snap->size(), 3u);
+
+    Concurrent copy(Map{{{1,2}, "e"}});
+    TEST_EQUAL(copy[1], "e");
+    TEST_EQUAL(copy[3], "");
+
+}
+
+void test_rs_interval_integral_concurrent_map_threads() {
+
+    // Each version maps the whole key range to the version number, so a
+    // reader can check that every snapshot it sees is consistent, and that
+    // versions never go backwards
+
+    static constexpr int readers = 4;
+    static constexpr int updates = 200;
+    static constexpr int range = 1000;
+
+    ConcurrentIntervalMap<int, int> map;
+    std::atomic<bool> done = false;
+    std::atomic<int> failures = 0;
+    std::vector<std::thread> threads;
+
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&map, &done, &failures, r] {
+            ConcurrentIntervalMap<int, int>::reader reader(map);
+            std::minstd_rand rng(r);
+            std::uniform_int_distribution<int> dist(0, range - 1);
+            int last = 0;
+            while (! done) {
+                auto& snap = reader.snapshot();
+                auto v = snap[dist(rng)];
+                if (v < last || snap[dist(rng)] != v || (v != 0 && snap.size() != 1)) {
+                    ++failures;
+                }
+                last = v;
+            }
+        });
+    }
+
+    for (int i = 1; i <= updates; ++i) {
+        map.update([i] (IntervalMap<int, int>& m) { m.insert(Itv(0, range - 1), i); });
+    }
+
+    done = true;
+
+    for (auto& t: threads) {
+        t.join();
+    }
+
+    TEST_EQUAL(failures.load(), 0);
+    TEST_EQUAL(map[0], updates);
+    TEST_EQUAL(map.version(), static_cast<unsigned>(updates + 1));
+
+}
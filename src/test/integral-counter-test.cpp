@@ -0,0 +1,132 @@
+#include "rs-interval/counter.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Counter = IntervalCounter<int>;
+
+void test_rs_interval_integral_counter_basics() {
+
+    Counter counter;
+
+    TEST(counter.empty());
+    TEST_EQUAL(counter.depth(42), 0);
+    TEST_EQUAL(counter.max_depth(Itv::all()), 0);
+    TEST_EQUAL(std::format("{}", counter.at_least(1)), "{}");
+    TEST_EQUAL(std::format("{}", counter.at_least(0)), "{*}");
+
+    TRY(counter.add(Itv(1,10)));
+    TRY(counter.add(Itv(5,15)));
+    TRY(counter.add(Itv(8,12)));
+    TRY(counter.add(Itv(5,15)));
+    TEST(! counter.empty());
+    TEST_EQUAL(counter.depth(0), 0);
+    TEST_EQUAL(counter.depth(1), 1);
+    TEST_EQUAL(counter[5], 3);
+    TEST_EQUAL(counter[8], 4);
+    TEST_EQUAL(counter[11], 3);
+    TEST_EQUAL(counter[13], 2);
+    TEST_EQUAL(counter[16], 0);
+
+    TEST_EQUAL(counter.max_depth(Itv(0,4)), 1);
+    TEST_EQUAL(counter.max_depth(Itv(0,5)), 3);
+    TEST_EQUAL(counter.max_depth(Itv(10,20)), 4);
+    TEST_EQUAL(counter.max_depth(Itv(11,20)), 3);
+    TEST_EQUAL(counter.max_depth(Itv(13,13)), 2);
+    TEST_EQUAL(counter.max_depth(Itv(20,20,">=")), 0);
+    TEST_EQUAL(counter.max_depth(Itv::all()), 4);
+    TEST_THROW(counter.max_depth(Itv()), std::invalid_argument, "empty");
+
+    TEST_EQUAL(std::format("{}", counter.at_least(1)), "{[1,15]}");
+    TEST_EQUAL(std::format("{}", counter.at_least(2)), "{[5,15]}");
+    TEST_EQUAL(std::format("{}", counter.at_least(3)), "{[5,12]}");
+    TEST_EQUAL(std::format("{}", counter.at_least(4)), "{[8,10]}");
+    TEST_EQUAL(std::format("{}", counter.at_least(5)), "{}");
+
+    TRY(counter.remove(Itv(5,15)));
+    TRY(counter.remove(Itv(8,12)));
+    TEST_EQUAL(std::format("{}", counter.at_least(2)), "{[5,10]}");
+    TRY(counter.add(Itv(0,0,">=")));
+    TEST_EQUAL(counter[1'000'000], 1);
+    TEST_EQUAL(std::format("{}", counter.at_least(1)), "{>=0}");
+    TEST_EQUAL(std::format("{}", counter.at_least(3)), "{[5,10]}");
+
+    TRY(counter.remove(Itv(0,0,">=")));
+    TRY(counter.remove(Itv(5,15)));
+    TRY(counter.remove(Itv(1,10)));
+    TEST(counter.empty());
+    TRY(counter.add(Itv(1,2)));
+    TRY(counter.clear());
+    TEST(counter.empty());
+
+}
+
+void test_rs_interval_integral_counter_random() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 100;
+
+    Counter counter;
+    std::vector<Itv> added;
+    std::vector<int> expect(range + 31, 0);
+    std::minstd_rand rng(42);
+
+    auto apply = [&] (const Itv& in, int delta) {
+        for (int k = 0; k < static_cast<int>(expect.size()); ++k) {
+            if (in.contains(k)) {
+                expect[static_cast<std::size_t>(k)] += delta;
+            }
+        }
+    };
+
+    for (int i = 0; i < iterations; ++i) {
+
+        if (random_int(0, 2)(rng) == 0 && ! added.empty()) {
+            auto j = static_cast<std::size_t>(random_int(0, static_cast<int>(added.size()) - 1)(rng));
+            TRY(counter.remove(added[j]));
+            apply(added[j], -1);
+            added.erase(added.begin() + static_cast<std::ptrdiff_t>(j));
+        } else {
+            int a = random_int(0, range)(rng);
+            int b = a + random_int(0, 30)(rng);
+            auto mode = random_int(0, 3)(rng);
+            Itv in(a, b, mode == 0 ? "()" : mode == 1 ? "[)" : mode == 2 ? "(]" : "[]");
+            TRY(counter.add(in));
+            apply(in, 1);
+            added.push_back(in);
+        }
+
+        auto key = random_int(0, range + 30)(rng);
+        TEST_EQUAL(counter.depth(key), expect[static_cast<std::size_t>(key)]);
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 30)(rng);
+        auto high = *std::max_element(expect.begin() + a, expect.begin() + b + 1);
+        TEST_EQUAL(counter.max_depth(Itv(a, b)), high);
+
+        auto k = random_int(1, 5)(rng);
+        IntervalSet<int> covered;
+
+        for (int x = 0; x < static_cast<int>(expect.size()); ++x) {
+            if (expect[static_cast<std::size_t>(x)] >= k) {
+                covered.insert(x);
+            }
+        }
+
+        TEST_EQUAL(counter.at_least(k), covered);
+
+    }
+
+}
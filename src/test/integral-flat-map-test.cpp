@@ -0,0 +1,316 @@
+#include "rs-interval/flat-map.hpp"
+#include "rs-interval/frozen-map.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Flat = FlatIntervalMap<int, std::string>;
+using Map = IntervalMap<int, std::string>;
+
+void test_rs_interval_integral_flat_map_construct_insert_erase() {
+
+    Flat map;
+    Flat::iterator it;
+
+    TEST(std::random_access_iterator<Flat::iterator>);
+    TEST(map.empty());
+    TEST_EQUAL(map.size(), 0u);
+    TEST_EQUAL(map.default_value(), "");
+    TEST_EQUAL(map[42], "");
+    TEST_EQUAL(std::format("{}", map), "{}");
+
+    TRY(map.insert(Itv(2,2,"<="), "alpha"));
+    TRY(map.insert(Itv(3,7,"()"), "bravo"));
+    TRY(map.insert(Itv(8,8,">="), "charlie"));
+    TEST_EQUAL(map.size(), 3u);
+    TEST_EQUAL(map[1], "alpha");
+    TEST_EQUAL(map[2], "alpha");
+    TEST_EQUAL(map[3], "");
+    TEST_EQUAL(map[4], "bravo");
+    TEST_EQUAL(map[6], "bravo");
+    TEST_EQUAL(map[7], "");
+    TEST_EQUAL(map[8], "charlie");
+    TEST_EQUAL(map[9], "charlie");
+    TRY(map.default_value("nil"));
+    TEST_EQUAL(map[3], "nil");
+    TEST_EQUAL(map[7], "nil");
+    TEST_EQUAL(std::format("{}", map), "{<=2:alpha,[4,6]:bravo,>=8:charlie}");
+
+    TEST(map.contains(2));
+    TEST(! map.contains(3));
+    TEST(map.contains(4));
+    TEST(! map.contains(7));
+    TEST(map.contains(8));
+
+    TRY(it = map.find(2));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "alpha");
+    TRY(it = map.find(3));  TEST(it == map.end());
+    TRY(it = map.find(5));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "bravo");
+    TEST_EQUAL(std::format("{}", it->first), "[4,6]");
+    TRY(it = map.find(7));  TEST(it == map.end());
+    TRY(it = map.find(9));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "charlie");
+
+    TRY(it = map.lower_bound(2));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "alpha");
+    TRY(it = map.lower_bound(3));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "bravo");
+    TRY(it = map.lower_bound(7));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "charlie");
+    TRY(it = map.lower_bound(9));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "charlie");
+
+    TRY(it = map.upper_bound(2));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "bravo");
+    TRY(it = map.upper_bound(3));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "bravo");
+    TRY(it = map.upper_bound(4));  REQUIRE(it != map.end());  TEST_EQUAL(it->second, "charlie");
+    TRY(it = map.upper_bound(8));  TEST(it == map.end());
+
+    TRY(map.clear());
+    TEST(map.empty());
+    TRY((map = {
+        {Itv(20,20,"<="), "alpha"},
+        {Itv(30,70,"()"), "bravo"},
+        {Itv(80,80,">="), "charlie"},
+    }));
+    TEST_EQUAL(map.size(), 3u);
+    TEST_EQUAL(std::format("{}", map), "{<=20:alpha,[31,69]:bravo,>=80:charlie}");
+
+    TRY(map.clear());
+    TRY(map.insert(Itv(10,10,"<="), "alpha"));
+    TRY(map.insert(Itv(1,5,"[]"), "bravo"));
+    TRY(map.insert(Itv(5,6,"[]"), "charlie"));
+    TRY(map.insert(Itv(2,3,"[]"), "delta"));
+    TRY(map.insert(Itv(7,8,"[]"), "charlie"));
+    TEST_EQUAL(map.size(), 6u);
+    TEST_EQUAL(std::format("{}", map),
+        "{<=0:alpha,"
+        "1:bravo,"
+        "[2,3]:delta,"
+        "4:bravo,"
+        "[5,8]:charlie,"
+        "[9,10]:alpha}");
+
+    TRY(map.erase(Itv(1,2,"[]")));
+    TRY(map.erase(Itv(6,7,"[]")));
+    TRY(map.erase(Itv(10,10,">=")));
+    TEST_EQUAL(map.size(), 6u);
+    TEST_EQUAL(std::format("{}", map),
+        "{<=0:alpha,"
+        "3:delta,"
+        "4:bravo,"
+        "5:charlie,"
+        "8:charlie,"
+        "9:alpha}");
+
+    TRY(map.insert(Itv(3,9,"[]"), "delta"));
+    TEST_EQUAL(std::format("{}", map), "{<=0:alpha,[3,9]:delta}");
+    TRY(map.insert(Itv(5,6,"[]"), "echo"));
+    TEST_EQUAL(std::format("{}", map), "{<=0:alpha,[3,4]:delta,[5,6]:echo,[7,9]:delta}");
+    TRY(map.insert(Itv(1,2,"[]"), "alpha"));
+    TEST_EQUAL(std::format("{}", map), "{<=2:alpha,[3,4]:delta,[5,6]:echo,[7,9]:delta}");
+
+    TRY(map.erase(Itv(0,8,"[]")));
+    TEST_EQUAL(map.size(), 2u);
+    TEST_EQUAL(std::format("{}", map), "{<=-1:alpha,9:delta}");
+    TRY(map.erase(Itv(9,9,"<=")));
+    TEST(map.empty());
+
+}
+
+void test_rs_interval_integral_flat_map_conversion() {
+
+    Map map;
+    Flat flat;
+    std::string str;
+
+    TRY((map = {{{5,10}, "a"}, {{15,20}, "b"}, {{25,30}, "c"}}));
+    TRY(map.default_value("nil"));
+    TRY(flat = Flat(map));
+    TEST_EQUAL(flat.size(), 3u);
+    TEST_EQUAL(flat.default_value(), "nil");
+    TRY(str = std::format("{}", flat));
+    TEST_EQUAL(str, "{[5,10]:a,[15,20]:b,[25,30]:c}");
+    TEST(std::equal(map.begin(), map.end(), flat.begin(), flat.end(),
+        [] (const auto& x, const auto& y) { return x.first == y.first && x.second == y.second; }));
+
+    FrozenIntervalMap<int, std::string> frozen;
+    TRY(frozen = flat.freeze());
+    TRY(str = std::format("{}", frozen));
+    TEST_EQUAL(str, "{[5,10]:a,[15,20]:b,[25,30]:c}");
+    TEST_EQUAL(frozen.default_value(), "nil");
+    TEST_EQUAL(frozen[17], "b");
+    TEST_EQUAL(frozen[21], "nil");
+
+    TRY(map = Map(flat.begin(), flat.end()));
+    TRY(str = std::format("{}", map));
+    TEST_EQUAL(str, "{[5,10]:a,[15,20]:b,[25,30]:c}");
+
+    std::vector<std::pair<Itv, std::string>> vec;
+    TRY(vec.assign(flat.begin(), flat.end()));
+    TEST_EQUAL(vec.size(), 3u);
+    TEST_EQUAL(vec[1].second, "b");
+
+    FlatIntervalMap<int, bool> flags;
+    TRY(flags.insert(Itv(1,5), true));
+    TRY(flags.insert(Itv(3,4), false));
+    TEST_EQUAL(std::format("{}", flags), "{[1,2]:true,[3,4]:false,5:true}");
+    TEST(flags[2]);
+    TEST(! flags[3]);
+    TEST(! flags[6]);
+    TEST(flags.begin()->second);
+
+}
+
+void test_rs_interval_integral_flat_map_bulk_construction() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Flat map;
+    Map expect;
+    std::vector<std::pair<Itv, std::string>> vec;
+    std::string str;
+    std::minstd_rand rng(42);
+
+    vec = {
+        {{7,9}, "b"},
+        {{1,2}, "a"},
+        {{3,4}, "a"},
+        {{5,6}, "b"},
+        {{10,10}, "b"},
+    };
+
+    TRY(map = Flat(vec.begin(), vec.end()));
+    TRY(str = std::format("{}", map));
+    TEST_EQUAL(str, "{[1,4]:a,[5,10]:b}");
+
+    vec = {
+        {{1,10}, "a"},
+        {{3,4}, "b"},
+        {{2,6}, "c"},
+    };
+
+    TRY(map.assign(vec.begin(), vec.end()));
+    TRY(str = std::format("{}", map));
+    TEST_EQUAL(str, "{1:a,[2,6]:c,[7,10]:a}");
+
+    static constexpr int iterations = 20;
+    static constexpr int size = 1000;
+
+    for (int i = 0; i < iterations; ++i) {
+
+        vec.clear();
+        int limit = i % 2 == 0 ? 1'000'000 : 1000;
+
+        for (int k = 0; k < size; ++k) {
+            int a = random_int(- limit, limit)(rng);
+            int b = a + random_int(0, 10)(rng);
+            vec.push_back({{a, b}, std::string(1, char('a' + random_int(0, 2)(rng)))});
+        }
+
+        TRY(expect = Map(vec.begin(), vec.end()));
+        TRY(map = Flat(vec.begin(), vec.end()));
+        TEST(map == Flat(expect));
+
+    }
+
+}
+
+void test_rs_interval_integral_flat_map_random_updates() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 10'000;
+    static constexpr int range = 100;
+
+    Flat map;
+    Map expect;
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 10)(rng);
+        auto mode = random_int(0, 3)(rng);
+        Itv in(a, b, mode == 0 ? "()" : mode == 1 ? "[)" : mode == 2 ? "(]" : "[]");
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(map.erase(in));
+            TRY(expect.erase(in));
+        } else {
+            auto t = std::string(1, char('a' + random_int(0, 2)(rng)));
+            TRY(map.insert(in, t));
+            TRY(expect.insert(in, t));
+        }
+
+        if (! (map == Flat(expect))) {
+            TEST_EQUAL(std::format("{}", map), std::format("{}", expect));
+            break;
+        }
+
+        auto key = random_int(- 1, range + 11)(rng);
+        TEST_EQUAL(map[key], expect[key]);
+        TEST_EQUAL(map.count_overlapping(in), expect.count_overlapping(in));
+        TEST_EQUAL(map.overlapping(in).begin() - map.begin(),
+            std::distance(expect.begin(), expect.overlapping(in).begin()));
+        TEST_EQUAL(map.lower_bound(key) - map.begin(), std::distance(expect.begin(), expect.lower_bound(key)));
+        TEST_EQUAL(map.upper_bound(key) - map.begin(), std::distance(expect.begin(), expect.upper_bound(key)));
+
+    }
+
+}
+
+void test_rs_interval_integral_flat_map_move_insert() {
+
+    using Vec = std::vector<int>;
+
+    FlatIntervalMap<int, Vec> map;
+    Vec v {1, 2, 3};
+    auto data = v.data();
+
+    TRY(map.insert(Itv(1,10), std::move(v)));
+    TRY(map.emplace(Itv(20,30), 4u, 5));
+    TEST_EQUAL(map.size(), 2u);
+    TEST(map[5] == Vec({1, 2, 3}));
+    TEST(map[25] == Vec({5, 5, 5, 5}));
+    TEST(map.begin()->second.data() == data);
+
+    TRY(map.emplace(Itv(5,25), Vec{6}));
+    TEST_EQUAL(map.size(), 3u);
+    TEST(map[4] == Vec({1, 2, 3}));
+    TEST(map[5] == Vec({6}));
+    TEST(map[26] == Vec({5, 5, 5, 5}));
+    TEST(map.begin()->second.data() == data);
+
+}
+
+void test_rs_interval_integral_flat_map_nth_rank() {
+
+    Flat map;
+    Map ref;
+
+    TEST(map.nth(0) == map.end());
+    TEST_EQUAL(map.rank(42), 0u);
+
+    TRY((map = {{{1,5}, "a"}, {{10,15}, "b"}, {{20,25}, "c"}}));
+    TRY(ref = Map(map.begin(), map.end()));
+
+    for (std::size_t i = 0; i <= 4; ++i) {
+        TEST_EQUAL(map.nth(i) - map.begin(), static_cast<std::ptrdiff_t>(std::min(i, map.size())));
+        TEST_EQUAL(std::distance(ref.begin(), ref.nth(i)), static_cast<std::ptrdiff_t>(std::min(i, ref.size())));
+    }
+
+    TEST_EQUAL(map.nth(1)->second, "b");
+    TEST_EQUAL(ref.nth(2)->second, "c");
+
+    for (int key = -1; key <= 30; ++key) {
+        auto expect = key <= 5 ? 0u : key <= 15 ? 1u : key <= 25 ? 2u : 3u;
+        TEST_EQUAL(map.rank(key), expect);
+        TEST_EQUAL(ref.rank(key), expect);
+    }
+
+}
@@ -0,0 +1,503 @@
+#include "rs-interval/flat-set.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <memory>
+#include <print>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Flat = FlatIntervalSet<int>;
+using Set = IntervalSet<int>;
+
+void test_rs_interval_integral_flat_set_construct_insert_erase() {
+
+    Flat set, com;
+    Flat::iterator it;
+    Itv in;
+    std::string str;
+
+    TEST(set.empty());
+    TRY(set = 42);
+    TEST_EQUAL(set.size(), 1u);
+    TRY(it = set.begin());
+    TEST_EQUAL(std::format("{}", *it), "42");
+    TRY(++it);
+    TEST(it == set.end());
+    TRY((set = {{5,10},{15,20},{25,30}}));
+    TEST_EQUAL(set.size(), 3u);
+    TRY(str = std::format("{}", set));
+    TEST_EQUAL(str, "{[5,10],[15,20],[25,30]}");
+
+    TRY((set = {}));                                      TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{}");
+    TRY((set = {{3,6,"()"}}));                            TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[4,5]}");
+    TRY((set = {{0,5,"()"},{10,15,"()"},{20,25,"()"}}));  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[1,4],[11,14],[21,24]}");
+    TRY((set = {{20,25},{1,5},{10,15},{6,9}}));           TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[1,15],[20,25]}");
+
+    TRY((set = {{3,6},{9,12},{15,18}}));
+    TRY(com = set.complement());
+    TRY(str = std::format("{}", com));
+    TEST_EQUAL(str, "{<=2,[7,8],[13,14],>=19}");
+
+    for (int i = 0; i <= 20; ++i) {
+        bool expect = (i >= 3 && i <= 6) || (i >= 9 && i <= 12) || (i >= 15 && i <= 18);
+        TEST_EQUAL(set.contains(i), expect);
+        TEST_EQUAL(com.contains(i), ! expect);
+    }
+
+    TRY(set.clear());
+    TEST(set.empty());
+
+    TRY((set.insert({10,20})));       TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[10,20]}");
+    TRY((set.insert({20,30,"()"})));  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[10,29]}");
+    TRY((set.erase({5,10,"()"})));    TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[10,29]}");
+    TRY((set.erase({5,10})));         TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[11,29]}");
+    TRY((set.erase({12,14})));        TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{11,[15,29]}");
+    TRY((set.erase({16,18,"()"})));   TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{11,[15,16],[18,29]}");
+    TRY((set.insert({9,11})));        TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[9,11],[15,16],[18,29]}");
+    TRY((set.insert({29,31,"()"})));  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[9,11],[15,16],[18,30]}");
+    TRY((set.insert({12,17})));       TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[9,30]}");
+    TRY((set.erase({0,9,"<="})));     TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[10,30]}");
+    TRY((set.erase({20,20,">="})));   TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[10,19]}");
+    TRY((set.erase(Itv::all())));     TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{}");
+
+}
+
+void test_rs_interval_integral_flat_set_conversion() {
+
+    Set set;
+    Flat flat;
+    std::string str;
+
+    TRY((set = {{5,10},{15,20},{25,30}}));
+    TRY(flat = Flat(set));
+    TEST_EQUAL(flat.size(), 3u);
+    TRY(str = std::format("{}", flat));
+    TEST_EQUAL(str, "{[5,10],[15,20],[25,30]}");
+    TEST(std::equal(set.begin(), set.end(), flat.begin(), flat.end()));
+
+}
+
+void test_rs_interval_integral_flat_set_bulk_construction() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Flat flat;
+    Set set;
+    std::vector<Itv> vec;
+    Itv in;
+    std::minstd_rand rng(42);
+
+    static constexpr int iterations = 1000;
+    static constexpr int max_size = 20;
+    static constexpr int max_value = 100;
+
+    for (int i = 0; i < iterations; ++i) {
+
+        TRY(set.clear());
+        vec.clear();
+        int size = random_int(1, max_size)(rng);
+
+        for (int k = 0; k < size; ++k) {
+            int a = random_int(1, max_value)(rng);
+            int b = random_int(1, max_value)(rng);
+            auto l = Bound(random_int(0, 3)(rng));
+            auto r = Bound(random_int(0, 3)(rng));
+            if ((l == Bound::empty) == (r == Bound::empty)) {
+                TRY(in = Itv(a, b, l, r));
+                vec.push_back(in);
+                TRY(set.insert(in));
+            }
+        }
+
+        TRY(flat = Flat(vec.begin(), vec.end()));
+        TEST(std::equal(set.begin(), set.end(), flat.begin(), flat.end()));
+
+        TRY(flat.assign(vec.rbegin(), vec.rend()));
+        TEST(std::equal(set.begin(), set.end(), flat.begin(), flat.end()));
+
+    }
+
+}
+
+void test_rs_interval_integral_flat_set_operations() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Flat flat[2], i_flat, u_flat, d_flat, sd_flat;
+    Set set[2], i_set, u_set, d_set, sd_set;
+    std::vector<std::pair<Itv, bool>> ops[2];
+    Itv in;
+    std::minstd_rand rng(42);
+
+    static constexpr int iterations = 1000;
+    static constexpr int max_size = 10;
+    static constexpr int max_value = 50;
+
+    for (int i = 0; i < iterations; ++i) {
+
+        for (int j = 0; j < 2; ++j) {
+
+            TRY(flat[j].clear());
+            TRY(set[j].clear());
+            ops[j].clear();
+            int size = random_int(1, max_size)(rng);
+
+            for (int k = 0; k < size; ++k) {
+
+                int a = random_int(1, max_value)(rng);
+                int b = random_int(1, max_value)(rng);
+                auto l = Bound(random_int(0, 3)(rng));
+                auto r = Bound(random_int(0, 3)(rng));
+
+                if ((l == Bound::empty) == (r == Bound::empty)) {
+                    TRY(in = Itv(a, b, l, r));
+                    bool add = random_int(0, 3)(rng) != 0;
+                    ops[j].push_back({in, add});
+                    if (! add) {
+                        TRY(flat[j].erase(in));
+                        TRY(set[j].erase(in));
+                    } else {
+                        TRY(flat[j].insert(in));
+                        TRY(set[j].insert(in));
+                    }
+                }
+
+            }
+
+            TEST(std::equal(set[j].begin(), set[j].end(), flat[j].begin(), flat[j].end()));
+
+        }
+
+        TRY(i_flat = set_intersection(flat[0], flat[1]));
+        TRY(u_flat = set_union(flat[0], flat[1]));
+        TRY(d_flat = set_difference(flat[0], flat[1]));
+        TRY(sd_flat = set_symmetric_difference(flat[0], flat[1]));
+        TRY(i_set = set_intersection(set[0], set[1]));
+        TRY(u_set = set_union(set[0], set[1]));
+        TRY(d_set = set_difference(set[0], set[1]));
+        TRY(sd_set = set_symmetric_difference(set[0], set[1]));
+
+        TEST_EQUAL(std::format("{}", i_flat), std::format("{}", i_set));
+        TEST_EQUAL(std::format("{}", u_flat), std::format("{}", u_set));
+        TEST_EQUAL(std::format("{}", d_flat), std::format("{}", d_set));
+        TEST_EQUAL(std::format("{}", sd_flat), std::format("{}", sd_set));
+
+        for (int x = 0; x <= max_value + 1; ++x) {
+
+            bool member[2];
+
+            for (int j = 0; j < 2; ++j) {
+                member[j] = false;
+                for (const auto& [item,add]: ops[j]) {
+                    if (item(x)) {
+                        member[j] = add;
+                    }
+                }
+            }
+
+            TEST_EQUAL(flat[0][x], member[0]);
+            TEST_EQUAL(flat[1][x], member[1]);
+            TEST_EQUAL(i_flat[x], member[0] && member[1]);
+            TEST_EQUAL(u_flat[x], member[0] || member[1]);
+            TEST_EQUAL(d_flat[x], member[0] && ! member[1]);
+            TEST_EQUAL(sd_flat[x], member[0] != member[1]);
+
+        }
+
+        TRY(i_flat = flat[0]);
+        TRY(u_flat = flat[0]);
+        TRY(d_flat = flat[0]);
+        TRY(sd_flat = flat[0]);
+        TRY(i_flat.apply_intersection(flat[1]));
+        TRY(u_flat.apply_union(flat[1]));
+        TRY(d_flat.apply_difference(flat[1]));
+        TRY(sd_flat.apply_symmetric_difference(flat[1]));
+
+        TEST_EQUAL(std::format("{}", i_flat), std::format("{}", i_set));
+        TEST_EQUAL(std::format("{}", u_flat), std::format("{}", u_set));
+        TEST_EQUAL(std::format("{}", d_flat), std::format("{}", d_set));
+        TEST_EQUAL(std::format("{}", sd_flat), std::format("{}", sd_set));
+
+    }
+
+}
+
+void test_rs_interval_integral_flat_set_batch_query() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Flat set;
+    std::vector<int> keys, expect, members;
+    std::minstd_rand rng(99);
+    bool flags[1] = {};
+
+    static constexpr int iterations = 100;
+    static constexpr int max_size = 50;
+    static constexpr int max_value = 1000;
+    static constexpr int num_keys = 200;
+
+    TRY(set.contains_batch({}, {}));
+    TEST_THROW(set.contains_batch(std::vector<int>{1, 2}, flags), std::invalid_argument, "size");
+
+    for (int i = 0; i < iterations; ++i) {
+
+        TRY(set.clear());
+        int size = random_int(0, max_size)(rng);
+
+        for (int k = 0; k < size; ++k) {
+            int a = random_int(1, max_value)(rng);
+            int b = a + random_int(0, 30)(rng);
+            TRY(set.insert(Itv(a, b, Bound(random_int(1, 2)(rng)), Bound(random_int(1, 2)(rng)))));
+        }
+
+        keys.clear();
+
+        for (int k = 0; k < num_keys; ++k) {
+            keys.push_back(random_int(- 10, max_value + 50)(rng));
+        }
+
+        for (int pass = 0; pass < 2; ++pass) {
+
+            if (pass == 1) {
+                std::ranges::sort(keys);
+            }
+
+            auto out = std::make_unique<bool[]>(keys.size());
+            expect.clear();
+            TRY(set.contains_batch(keys, {out.get(), keys.size()}));
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                TEST_EQUAL(out[k], set.contains(keys[k]));
+                if (set.contains(keys[k])) {
+                    expect.push_back(keys[k]);
+                }
+            }
+
+            TRY(members = set.filter(keys));
+            TEST(members == expect);
+
+        }
+
+    }
+
+}
+
+void test_rs_interval_integral_flat_set_overlapping() {
+
+    Flat set;
+    std::ranges::subrange<Flat::iterator> range;
+
+    TRY(range = set.overlapping(Itv(1,10)));
+    TEST(range.empty());
+
+    TRY((set = {{1,5}, {10,15}, {20,25}, {30,35}}));
+    TRY(range = set.overlapping(Itv(5,10)));
+    REQUIRE(range.size() == 2u);
+    TEST_EQUAL(std::format("{}", range[0]), "[1,5]");
+    TEST_EQUAL(std::format("{}", range[1]), "[10,15]");
+    TRY(range = set.overlapping(Itv(12,32)));
+    REQUIRE(range.size() == 3u);
+    TEST(range.begin() == set.begin() + 1);
+    TRY(range = set.overlapping(Itv(16,19)));
+    TEST(range.empty());
+    TRY(range = set.overlapping(Itv()));
+    TEST(range.empty());
+
+    TEST_EQUAL(set.count_overlapping(Itv(0,21)), 3u);
+    TEST_EQUAL(set.count_overlapping(Itv(26,26,">=")), 1u);
+    TEST_EQUAL(set.count_overlapping(Itv::all()), 4u);
+    TEST_EQUAL(set.count_overlapping(Itv(36,40)), 0u);
+
+    Set ref(set.begin(), set.end());
+
+    for (int a = 0; a <= 40; a += 3) {
+        for (int b = a; b <= 40; b += 4) {
+            TEST_EQUAL(set.count_overlapping(Itv(a, b)), ref.count_overlapping(Itv(a, b)));
+        }
+    }
+
+}
+
+void test_rs_interval_integral_flat_set_nth_rank() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Flat set;
+
+    TEST(set.nth(0) == set.end());
+    TEST_EQUAL(set.rank(42), 0u);
+
+    TRY((set = {{1,5}, {10,15}, {20,25}, {30,35}}));
+    TEST(set.nth(0) == set.begin());
+    TEST_EQUAL(std::format("{}", *set.nth(2)), "[20,25]");
+    TEST(set.nth(4) == set.end());
+    TEST(set.nth(100) == set.end());
+    TEST_EQUAL(set.rank(0), 0u);
+    TEST_EQUAL(set.rank(1), 0u);
+    TEST_EQUAL(set.rank(5), 0u);
+    TEST_EQUAL(set.rank(6), 1u);
+    TEST_EQUAL(set.rank(12), 1u);
+    TEST_EQUAL(set.rank(29), 3u);
+    TEST_EQUAL(set.rank(36), 4u);
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 200;
+
+    Set ref(set.begin(), set.end());
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 10)(rng);
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(set.erase(Itv(a, b)));
+            TRY(ref.erase(Itv(a, b)));
+        } else {
+            TRY(set.insert(Itv(a, b)));
+            TRY(ref.insert(Itv(a, b)));
+        }
+
+        auto key = random_int(-1, range + 11)(rng);
+        auto expect = static_cast<std::size_t>(std::ranges::count_if(ref, [key] (const Itv& in) { return in.match(key) == Match::high; }));
+        TEST_EQUAL(set.rank(key), expect);
+        TEST_EQUAL(ref.rank(key), expect);
+
+        auto n = static_cast<std::size_t>(random_int(0, static_cast<int>(set.size()))(rng));
+        TEST(set.nth(n) == std::next(set.begin(), static_cast<std::ptrdiff_t>(n)));
+        TEST(ref.nth(n) == std::next(ref.begin(), static_cast<std::ptrdiff_t>(n)));
+
+    }
+
+}
+
+void test_rs_interval_integral_flat_set_cardinality() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Flat set;
+
+    TEST_EQUAL(set.cardinality(), 0u);
+    TEST_EQUAL(set.cardinality(Itv::all()), 0u);
+
+    TRY((set = {{1,5}, {10,15}, {20,25}}));
+    TEST_EQUAL(set.cardinality(), 17u);
+    TEST_EQUAL(set.cardinality(Itv(3,12)), 6u);
+    TEST_EQUAL(set.cardinality(Itv(3,22)), 12u);
+    TEST_EQUAL(set.cardinality(Itv(6,9)), 0u);
+    TEST_EQUAL(set.cardinality(Itv(11,13)), 3u);
+    TEST_EQUAL(set.cardinality(Itv(0,100)), 17u);
+
+    TRY(set.insert(Itv(0,0,"<=")));
+    TEST_EQUAL(set.cardinality(), npos);
+    TEST_EQUAL(set.cardinality(Itv(-10,30)), 28u);
+    TEST_EQUAL(set.cardinality(Itv(12,12,"<=")), npos);
+    TRY(set.apply_complement());
+    TEST_EQUAL(set.cardinality(), npos);
+    TEST_EQUAL(set.cardinality(Itv(0,30)), 13u);
+    TRY(set.clear());
+    TEST_EQUAL(set.cardinality(), 0u);
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 100;
+
+    Set ref;
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 10)(rng);
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(set.erase(Itv(a, b)));
+            TRY(ref.erase(Itv(a, b)));
+        } else {
+            TRY(set.insert(Itv(a, b)));
+            TRY(ref.insert(Itv(a, b)));
+        }
+
+        TEST_EQUAL(set.cardinality(), ref.cardinality());
+
+        a = random_int(0, range)(rng);
+        b = a + random_int(0, 40)(rng);
+        Itv q(a, b);
+        TEST_EQUAL(set.cardinality(q), ref.cardinality(q));
+
+    }
+
+}
+
+void test_rs_interval_integral_flat_set_parallel_operations() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int size = 20'000;
+    static constexpr int max_value = 1'000'000;
+
+    std::minstd_rand rng(123);
+
+    auto make_set = [&rng] (int n, int width) {
+        std::vector<Itv> vec;
+        for (int k = 0; k < n; ++k) {
+            int a = random_int(- max_value, max_value)(rng);
+            int b = a + random_int(0, width)(rng);
+            vec.push_back(Itv(a, b, Bound(random_int(1, 2)(rng)), Bound(random_int(1, 2)(rng))));
+        }
+        return Flat(vec.begin(), vec.end());
+    };
+
+    // The second set has fewer and longer intervals, so that many of them
+    // cross the chunk boundaries taken from the first
+
+    Flat a, b, expect, result;
+
+    TRY(a = make_set(size, 50));
+    TRY(b = make_set(size / 20, 20'000));
+
+    for (auto [x,y]: {std::pair{a, b}, std::pair{b, a}}) {
+
+        TRY(expect = x.set_intersection(y));
+        for (std::size_t threads = 0; threads <= 8; ++threads) {
+            TRY(result = x.set_intersection(y, threads));
+            TEST_EQUAL(result, expect);
+            TEST_EQUAL(result.cardinality(), expect.cardinality());
+        }
+
+        TRY(expect = x.set_union(y));
+        for (std::size_t threads = 0; threads <= 8; ++threads) {
+            TRY(result = set_union(x, y, threads));
+            TEST_EQUAL(result, expect);
+            TEST_EQUAL(result.cardinality(), expect.cardinality());
+        }
+
+        TRY(expect = x.set_difference(y));
+        for (std::size_t threads = 0; threads <= 8; ++threads) {
+            TRY(result = x.set_difference(y, threads));
+            TEST_EQUAL(result, expect);
+            TEST_EQUAL(result.cardinality(), expect.cardinality());
+        }
+
+        TRY(expect = x.set_symmetric_difference(y));
+        for (std::size_t threads = 0; threads <= 8; ++threads) {
+            TRY(result = x.set_symmetric_difference(y, threads));
+            TEST_EQUAL(result, expect);
+            TEST_EQUAL(result.cardinality(), expect.cardinality());
+        }
+
+    }
+
+}
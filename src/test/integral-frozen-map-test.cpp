@@ -0,0 +1,104 @@
+#include "rs-interval/frozen-map.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Map = IntervalMap<int, std::string>;
+using Frozen = FrozenIntervalMap<int, std::string>;
+
+void test_rs_interval_integral_frozen_map_construction() {
+
+    Map map;
+    Frozen frozen;
+    Frozen::iterator it;
+    std::string str;
+
+    TEST(frozen.empty());
+    TEST_EQUAL(frozen.size(), 0u);
+    TEST(! frozen.contains(0));
+    TEST_EQUAL(frozen[0], "");
+    TEST(frozen.find(0) == frozen.end());
+    TRY(str = std::format("{}", frozen));
+    TEST_EQUAL(str, "{}");
+
+    TRY(map.default_value("none"));
+    TRY(map.insert({1,5}, "a"));
+    TRY(map.insert({10,20,"(]"}, "b"));
+    TRY(map.insert({30,30,">="}, "c"));
+    TRY(frozen = map.freeze());
+    TEST_EQUAL(frozen.size(), 3u);
+    TEST_EQUAL(frozen.default_value(), "none");
+    TRY(str = std::format("{}", frozen));
+    TEST_EQUAL(str, "{[1,5]:a,[11,20]:b,>=30:c}");
+    TEST(frozen.to_map() == map);
+
+    TEST_EQUAL(frozen[0], "none");
+    TEST_EQUAL(frozen[1], "a");
+    TEST_EQUAL(frozen[5], "a");
+    TEST_EQUAL(frozen[10], "none");
+    TEST_EQUAL(frozen[11], "b");
+    TEST_EQUAL(frozen[20], "b");
+    TEST_EQUAL(frozen[29], "none");
+    TEST_EQUAL(frozen[std::numeric_limits<int>::max()], "c");
+    TEST(! frozen.contains(std::numeric_limits<int>::lowest()));
+    TEST(frozen.contains(1000));
+
+    TRY(it = frozen.find(15));
+    REQUIRE(it != frozen.end());
+    TEST_EQUAL(std::format("{}", it->first), "[11,20]");
+    TEST_EQUAL(it->second, "b");
+    TRY(it = frozen.find(25));
+    TEST(it == frozen.end());
+
+}
+
+void test_rs_interval_integral_frozen_map_lookup() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    std::minstd_rand rng(42);
+
+    for (int size: {1, 2, 3, 7, 8, 9, 100, 1000, 10000}) {
+
+        IntervalMap<std::uint32_t, int> map(-1);
+
+        for (int k = 0; k < size; ++k) {
+            auto a = static_cast<std::uint32_t>(random_int(0, 10 * size)(rng));
+            auto b = a + static_cast<std::uint32_t>(random_int(0, 10)(rng));
+            map.insert({a, b}, random_int(1, 5)(rng));
+        }
+
+        auto frozen = map.freeze();
+        TEST_EQUAL(frozen.size(), map.size());
+        TEST_EQUAL(std::format("{}", frozen), std::format("{}", map));
+
+        for (int k = -5; k < 10 * size + 20; ++k) {
+            auto key = static_cast<std::uint32_t>(k);
+            TEST_EQUAL(frozen[key], map[key]);
+            TEST_EQUAL(frozen.contains(key), map.contains(key));
+        }
+
+    }
+
+    IntervalMap<double, int> dmap;
+    dmap.insert({1, 2, "()"}, 1);
+    dmap.insert({2, 3, "[)"}, 2);
+    auto dfrozen = dmap.freeze();
+
+    TEST_EQUAL(dfrozen[1.0], 0);
+    TEST_EQUAL(dfrozen[1.5], 1);
+    TEST_EQUAL(dfrozen[2.0], 2);
+    TEST_EQUAL(dfrozen[3.0], 0);
+    TEST(! dfrozen.contains(std::numeric_limits<double>::quiet_NaN()));
+
+}
@@ -0,0 +1,187 @@
+#include "rs-interval/flat-set.hpp"
+#include "rs-interval/frozen-set.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/simd.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace RS::Interval;
+
+namespace {
+
+    template <typename T>
+    IntervalSet<T> random_set(std::minstd_rand& rng, int size, T min, T max) {
+
+        using random_value = std::uniform_int_distribution<T>;
+        using random_int = std::uniform_int_distribution<int>;
+
+        IntervalSet<T> set;
+
+        for (int k = 0; k < size; ++k) {
+            T a = random_value(min, max)(rng);
+            T b = a + static_cast<T>(random_int(0, 20)(rng));
+            if (b < a) {
+                b = a;
+            }
+            int mode = random_int(0, 49)(rng);
+            if (mode == 0) {
+                set.insert(Interval<T>(a, Bound::unbound, Bound::closed));
+            } else if (mode == 1) {
+                set.insert(Interval<T>(a, Bound::closed, Bound::unbound));
+            } else {
+                set.insert(Interval<T>(a, b, Bound(random_int(1, 2)(rng)), Bound(random_int(1, 2)(rng))));
+            }
+        }
+
+        return set;
+
+    }
+
+    template <typename T>
+    std::vector<T> random_keys(std::minstd_rand& rng, int size, T min, T max) {
+        std::vector<T> keys = {std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max(), min, max};
+        for (int k = 0; k < size; ++k) {
+            keys.push_back(std::uniform_int_distribution<T>(min, max)(rng));
+        }
+        return keys;
+    }
+
+    template <typename T>
+    void check_frozen_set(T min, T max) {
+
+        std::minstd_rand rng(42);
+        std::string str;
+
+        for (int size: {0, 1, 2, 5, 20, 31, 32, 33, 100, 300, 1000, 5000}) {
+
+            auto set = random_set<T>(rng, size, min, max);
+            auto keys = random_keys<T>(rng, 500, min, max);
+            FrozenIntervalSet<T> frozen;
+            TRY(frozen = set.freeze());
+            TEST_EQUAL(frozen.size(), set.size());
+            TEST_EQUAL(std::format("{}", frozen), std::format("{}", set));
+            TEST(frozen.to_set() == set);
+
+            auto out = std::make_unique<bool[]>(keys.size());
+            TRY(frozen.contains_batch(keys, {out.get(), keys.size()}));
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                TEST_EQUAL(out[k], set.contains(keys[k]));
+                TEST_EQUAL(frozen.contains(keys[k]), set.contains(keys[k]));
+            }
+
+        }
+
+    }
+
+
+    template <typename T>
+        void check_kernels(T min, T max) {
+
+        using namespace RS::Interval::Detail;
+
+        std::minstd_rand rng(42);
+
+        auto set = random_set<T>(rng, 200, min, max);
+        auto keys = random_keys<T>(rng, 1000, min, max);
+        std::vector<T> lo, hi;
+
+        for (const auto& in: set) {
+            lo.push_back(inclusive_lower(in));
+            hi.push_back(inclusive_upper(in));
+        }
+
+        auto n = lo.size();
+        lo.resize(n + membership_block, std::numeric_limits<T>::max());
+        hi.resize(n + membership_block, std::numeric_limits<T>::lowest());
+        AlignedVector<T> index;
+        AlignedVector<std::size_t> block;
+        TRY(build_membership_index(lo.data(), n, index, block));
+        MembershipTable<T> table = {lo.data(), hi.data(), n, index.data(), block.data(), index.size() - 1};
+        std::vector<MembershipKernel<T>> kernels = {membership_scalar<T>};
+
+        #if RS_INTERVAL_SIMD_X86
+            if (__builtin_cpu_supports("avx2")) {
+                kernels.push_back(membership_avx2<T>);
+            }
+            if (__builtin_cpu_supports("avx512f")) {
+                kernels.push_back(membership_avx512<T>);
+            }
+        #endif
+
+        for (auto kernel: kernels) {
+
+            auto out = std::make_unique<bool[]>(keys.size());
+            TRY(kernel(table, keys.data(), out.get(), keys.size()));
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                TEST_EQUAL(out[k], set.contains(keys[k]));
+            }
+
+        }
+
+    }
+
+}
+
+void test_rs_interval_integral_frozen_set_construction() {
+
+    IntervalSet<int> set;
+    FrozenIntervalSet<int> frozen;
+    std::string str;
+
+    TEST(frozen.empty());
+    TEST_EQUAL(frozen.size(), 0u);
+    TEST(! frozen.contains(0));
+    TRY(str = std::format("{}", frozen));
+    TEST_EQUAL(str, "{}");
+
+    TRY((set = {{5,5,"<="}, {10,15,"(]"}, {20}, {30,30,">="}}));
+    TRY(frozen = FrozenIntervalSet<int>(set));
+    TEST(! frozen.empty());
+    TEST_EQUAL(frozen.size(), 4u);
+    TRY(str = std::format("{}", frozen));
+    TEST_EQUAL(str, "{<=5,[11,15],20,>=30}");
+    TRY(str = std::format("{}", FlatIntervalSet<int>(set).freeze()));
+    TEST_EQUAL(str, "{<=5,[11,15],20,>=30}");
+
+    TEST(frozen[std::numeric_limits<int>::lowest()]);
+    TEST(frozen[5]);
+    TEST(! frozen[6]);
+    TEST(! frozen[10]);
+    TEST(frozen[11]);
+    TEST(frozen[20]);
+    TEST(! frozen[29]);
+    TEST(frozen[std::numeric_limits<int>::max()]);
+
+    std::vector<int> keys = {0, 6, 12, 25, 40};
+    std::vector<int> members;
+    TRY(members = frozen.filter(keys));
+    TEST(members == std::vector<int>({0, 12, 40}));
+
+}
+
+void test_rs_interval_integral_frozen_set_membership() {
+
+    check_frozen_set<int>(-10'000, 10'000);
+    check_frozen_set<std::int64_t>(-1'000'000'000'000, 1'000'000'000'000);
+    check_frozen_set<unsigned>(0, 100'000);
+    check_frozen_set<short>(-1000, 1000);
+
+}
+
+void test_rs_interval_integral_frozen_set_kernels() {
+
+    check_kernels<int>(-5000, 5000);
+    check_kernels<std::int64_t>(-5'000'000'000, 5'000'000'000);
+
+}
@@ -3,14 +3,51 @@
 #include "rs-interval/set.hpp"
 #include "rs-interval/types.hpp"
 #include "test/unit-test.hpp"
+#include <algorithm>
+#include <cstddef>
 #include <format>
+#include <iterator>
+#include <random>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace RS::Interval;
 
 using Itv = Interval<int>;
 using Map = IntervalMap<int, std::string>;
 
+namespace {
+
+    struct Tracked {
+
+        static inline int copies = 0;
+
+        std::string value;
+
+        Tracked() = default;
+        Tracked(const char* s): value(s) {}
+        Tracked(const Tracked& t): value(t.value) { ++copies; }
+        Tracked(Tracked&& t) = default;
+        ~Tracked() = default;
+        Tracked& operator=(const Tracked& t) { value = t.value; ++copies; return *this; }
+        Tracked& operator=(Tracked&& t) = default;
+
+        bool operator==(const Tracked& t) const = default;
+
+    };
+
+    template <typename M>
+    std::string entries(const M& map) {
+        std::string str;
+        for (const auto& [in,t]: map) {
+            str += std::format("{}:{};", in, t.value);
+        }
+        return str;
+    }
+
+}
+
 void test_rs_interval_integral_map() {
 
     Map map;
@@ -151,4 +188,389 @@ void test_rs_interval_integral_map() {
     TEST_EQUAL(map[11], "nil");
     TEST_EQUAL(map[12], "nil");
 
+    TRY(map.erase(Itv(0,8,"[]")));
+    TEST_EQUAL(map.size(), 2u);
+    TEST_EQUAL(std::format("{}", map), "{<=-1:alpha,9:alpha}");
+    TRY(map.erase(Itv(9,9,"<=")));
+    TEST(map.empty());
+
+    TRY(map.insert(Itv(55,56,"[]"), "bravo"));
+    TRY(map.insert(Itv(57,58,"[]"), "charlie"));
+    TRY(map.insert(Itv(57,61,"[]"), "bravo"));
+    TEST_EQUAL(map.size(), 1u);
+    TEST_EQUAL(std::format("{}", map), "{[55,61]:bravo}");
+
+}
+
+void test_rs_interval_integral_map_bulk_construction() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Map expect, map;
+    std::vector<std::pair<Itv, std::string>> vec;
+    std::string str;
+    std::minstd_rand rng(42);
+
+    TRY(map = Map(vec.begin(), vec.end()));
+    TEST(map.empty());
+
+    vec = {
+        {{7,9}, "b"},
+        {{1,2}, "a"},
+        {{3,4}, "a"},
+        {{5,6}, "b"},
+        {{10,10}, "b"},
+    };
+
+    TRY(map = Map(vec.begin(), vec.end()));
+    TRY(str = std::format("{}", map));
+    TEST_EQUAL(str, "{[1,4]:a,[5,10]:b}");
+
+    vec = {
+        {{1,10}, "a"},
+        {{3,4}, "b"},
+        {{2,6}, "c"},
+    };
+
+    TRY(map.assign(vec.begin(), vec.end()));
+    TRY(str = std::format("{}", map));
+    TEST_EQUAL(str, "{1:a,[2,6]:c,[7,10]:a}");
+
+    TRY((map = {{{16,17}, "b"}, {{11,14}, "a"}, {15, "b"}}));
+    TRY(str = std::format("{}", map));
+    TEST_EQUAL(str, "{[11,14]:a,[15,17]:b}");
+
+    static constexpr int iterations = 20;
+    static constexpr int size = 1000;
+
+    for (int i = 0; i < iterations; ++i) {
+
+        vec.clear();
+        int limit = i % 2 == 0 ? 1'000'000 : 1000;
+
+        for (int k = 0; k < size; ++k) {
+            int a = random_int(- limit, limit)(rng);
+            int b = a + random_int(0, 10)(rng);
+            vec.push_back({{a, b}, std::string(1, char('a' + random_int(0, 2)(rng)))});
+        }
+
+        // Disjoint inputs in random order take the sorted path, the dense
+        // ones fall back on sequential insertion
+
+        TRY(expect.clear());
+
+        for (const auto& [in,t]: vec) {
+            TRY(expect.insert(in, t));
+        }
+
+        TRY(map = Map(vec.begin(), vec.end()));
+        TEST(map == expect);
+
+        std::ranges::sort(vec);
+        auto end = std::ranges::unique(vec, [] (const auto& a, const auto& b) { return a.first.overlaps(b.first); }).begin();
+        vec.erase(end, vec.end());
+        std::ranges::shuffle(vec, rng);
+
+        TRY(expect.clear());
+
+        for (const auto& [in,t]: vec) {
+            TRY(expect.insert(in, t));
+        }
+
+        TRY(map = Map(vec.begin(), vec.end()));
+        TEST(map == expect);
+
+    }
+
+}
+
+void test_rs_interval_integral_map_move_insert() {
+
+    IntervalMap<int, Tracked> map;
+    Tracked t = "alpha";
+
+    Tracked::copies = 0;
+    TRY(map.insert(Itv(1,10), std::move(t)));
+    TRY(map.insert(Itv(20,30), Tracked("bravo")));
+    TRY(map.emplace(Itv(40,50), "charlie"));
+    TEST_EQUAL(entries(map), "[1,10]:alpha;[20,30]:bravo;[40,50]:charlie;");
+    TEST_EQUAL(Tracked::copies, 0);
+
+    TRY(map.emplace(Itv(5,25), "delta"));
+    TEST_EQUAL(entries(map), "[1,4]:alpha;[5,25]:delta;[26,30]:bravo;[40,50]:charlie;");
+    TEST_EQUAL(Tracked::copies, 0);
+
+    TRY(map.emplace(Itv(0,60), "echo"));
+    TEST_EQUAL(entries(map), "[0,60]:echo;");
+    TEST_EQUAL(Tracked::copies, 0);
+
+    // Splitting a segment in two has to copy its value
+
+    TRY(map.emplace(Itv(10,20), "foxtrot"));
+    TEST_EQUAL(entries(map), "[0,9]:echo;[10,20]:foxtrot;[21,60]:echo;");
+    TEST_EQUAL(Tracked::copies, 1);
+
+    TRY(map.emplace(Itv(21,30), "foxtrot"));
+    TEST_EQUAL(entries(map), "[0,9]:echo;[10,30]:foxtrot;[31,60]:echo;");
+    TEST_EQUAL(Tracked::copies, 1);
+
+}
+
+void test_rs_interval_integral_map_random_updates() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    // The model holds the value at each point in [-1,range+11], offset by 1
+
+    static constexpr int iterations = 10'000;
+    static constexpr int range = 100;
+
+    Map map;
+    std::vector<std::string> model(range + 13);
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 10)(rng);
+        auto mode = random_int(0, 3)(rng);
+        Itv in(a, b, mode == 0 ? "()" : mode == 1 ? "[)" : mode == 2 ? "(]" : "[]");
+        std::string t;
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(map.erase(in));
+        } else {
+            t = std::string(1, char('a' + random_int(0, 2)(rng)));
+            TRY(map.insert(in, t));
+        }
+
+        for (int x = - 1; x <= range + 11; ++x) {
+            if (in.contains(x)) {
+                model[static_cast<std::size_t>(x + 1)] = t;
+            }
+        }
+
+        int errors = 0;
+
+        for (int x = - 1; x <= range + 11; ++x) {
+            errors += int(map[x] != model[static_cast<std::size_t>(x + 1)]);
+        }
+
+        auto it = std::ranges::adjacent_find(map, [] (const auto& p, const auto& q) {
+            return p.second == q.second && p.first.touches(q.first);
+        });
+
+        TEST_EQUAL(errors, 0);
+        TEST(it == map.end());
+
+        if (errors != 0 || it != map.end()) {
+            break;
+        }
+
+    }
+
+}
+
+void test_rs_interval_integral_map_combine() {
+
+    IntervalMap<int, int, Sum> sum;
+    IntervalMap<int, int, Maximum> max;
+    IntervalMap<int, int, Minimum> min;
+    IntervalMap<int, unsigned, BitOr> bits;
+    std::string str;
+
+    TRY(sum.insert(Itv(1,10), 1));
+    TRY(sum.insert(Itv(5,15), 2));
+    TRY(str = std::format("{}", sum));
+    TEST_EQUAL(str, "{[1,4]:1,[5,10]:3,[11,15]:2}");
+    TRY(sum.insert(Itv(0,20), 1));
+    TRY(str = std::format("{}", sum));
+    TEST_EQUAL(str, "{0:1,[1,4]:2,[5,10]:4,[11,15]:3,[16,20]:1}");
+    TRY(sum.insert(Itv(11,15), 1));
+    TRY(str = std::format("{}", sum));
+    TEST_EQUAL(str, "{0:1,[1,4]:2,[5,15]:4,[16,20]:1}");
+    TRY(sum.insert(Itv(21,30), 1));
+    TRY(str = std::format("{}", sum));
+    TEST_EQUAL(str, "{0:1,[1,4]:2,[5,15]:4,[16,30]:1}");
+    TRY(sum.insert(Itv(7,8), -4));
+    TRY(str = std::format("{}", sum));
+    TEST_EQUAL(str, "{0:1,[1,4]:2,[5,6]:4,[7,8]:0,[9,15]:4,[16,30]:1}");
+    TEST_EQUAL(sum[7], 0);
+    TEST(sum.contains(7));
+
+    TRY(max.insert(Itv(1,10), 5));
+    TRY(max.insert(Itv(5,15), 3));
+    TRY(max.insert(Itv(8,12), 7));
+    TRY(str = std::format("{}", max));
+    TEST_EQUAL(str, "{[1,7]:5,[8,12]:7,[13,15]:3}");
+
+    TRY(min.insert(Itv(1,10), 5));
+    TRY(min.insert(Itv(5,15), 3));
+    TRY(min.insert(Itv(8,12), 7));
+    TRY(str = std::format("{}", min));
+    TEST_EQUAL(str, "{[1,4]:5,[5,15]:3}");
+
+    TRY(bits.insert(Itv(1,10), 1u));
+    TRY(bits.insert(Itv(5,15), 2u));
+    TRY(bits.insert(Itv(11,20), 1u));
+    TRY(str = std::format("{}", bits));
+    TEST_EQUAL(str, "{[1,4]:1,[5,15]:3,[16,20]:1}");
+
+    auto cat = [] (const std::string& a, const std::string& b) { return a + b; };
+    IntervalMap<int, std::string, decltype(cat)> strs;
+
+    TRY(strs.insert(Itv(1,10), "a"));
+    TRY(strs.insert(Itv(5,15), "b"));
+    TRY(strs.insert(Itv(3,6), "c"));
+    TRY(str = std::format("{}", strs));
+    TEST_EQUAL(str, "{[1,2]:a,[3,4]:ac,[5,6]:abc,[7,10]:ab,[11,15]:b}");
+
+    TRY((sum = {{Itv(1,5), 1}, {Itv(3,8), 1}, {Itv(3,4), 1}}));
+    TRY(str = std::format("{}", sum));
+    TEST_EQUAL(str, "{[1,2]:1,[3,4]:3,5:2,[6,8]:1}");
+    TRY(sum.erase(Itv(4,6)));
+    TRY(str = std::format("{}", sum));
+    TEST_EQUAL(str, "{[1,2]:1,3:3,[7,8]:1}");
+
+}
+
+void test_rs_interval_integral_map_combine_random() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 10'000;
+    static constexpr int range = 100;
+
+    IntervalMap<int, int, Sum> map;
+    std::vector<int> model(range + 13);
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 10)(rng);
+        auto mode = random_int(0, 3)(rng);
+        Itv in(a, b, mode == 0 ? "()" : mode == 1 ? "[)" : mode == 2 ? "(]" : "[]");
+        bool erase = random_int(0, 4)(rng) == 0;
+        int t = random_int(1, 3)(rng);
+
+        if (erase) {
+            TRY(map.erase(in));
+        } else {
+            TRY(map.insert(in, t));
+        }
+
+        for (int x = - 1; x <= range + 11; ++x) {
+            if (in.contains(x)) {
+                auto& m = model[static_cast<std::size_t>(x + 1)];
+                m = erase ? 0 : m + t;
+            }
+        }
+
+        int errors = 0;
+
+        for (int x = - 1; x <= range + 11; ++x) {
+            errors += int(map[x] != model[static_cast<std::size_t>(x + 1)]);
+        }
+
+        auto it = std::ranges::adjacent_find(map, [] (const auto& p, const auto& q) {
+            return p.second == q.second && p.first.touches(q.first);
+        });
+
+        TEST_EQUAL(errors, 0);
+        TEST(it == map.end());
+
+        if (errors != 0 || it != map.end()) {
+            break;
+        }
+
+    }
+
+}
+
+void test_rs_interval_integral_map_overlapping() {
+
+    Map map;
+
+    auto list = [&] (const Itv& in) {
+        std::string s;
+        for (auto& [key,value]: map.overlapping(in)) {
+            s += std::format("{}:{};", key, value);
+        }
+        return s;
+    };
+
+    TEST_EQUAL(list(Itv(1,10)), "");
+
+    TRY((map = {{{1,5}, "a"}, {{6,9}, "b"}, {{20,25}, "c"}}));
+    TEST_EQUAL(list(Itv(4,7)), "[1,5]:a;[6,9]:b;");
+    TEST_EQUAL(list(Itv(10,19)), "");
+    TEST_EQUAL(list(Itv(9,20)), "[6,9]:b;[20,25]:c;");
+    TEST_EQUAL(list(Itv(0,0,"<=")), "");
+    TEST_EQUAL(list(Itv(1,1,"<=")), "[1,5]:a;");
+    TEST_EQUAL(list(Itv::all()), "[1,5]:a;[6,9]:b;[20,25]:c;");
+    TEST_EQUAL(map.count_overlapping(Itv(5,6)), 2u);
+    TEST_EQUAL(map.count_overlapping(Itv()), 0u);
+
+    // The range refers to the map's own entries
+
+    auto range = map.overlapping(Itv(7,7));
+    REQUIRE(! range.empty());
+    TEST(&*range.begin() == &*map.find(7));
+
+}
+
+void test_rs_interval_integral_map_nth_rank() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Map map;
+
+    TEST(map.nth(0) == map.end());
+    TEST_EQUAL(map.rank(42), 0u);
+
+    TRY((map = {{{1,5}, "a"}, {{10,15}, "b"}, {{20,25}, "c"}}));
+    TEST(map.nth(0) == map.begin());
+    TEST_EQUAL(map.nth(1)->second, "b");
+    TEST_EQUAL(map.nth(2)->second, "c");
+    TEST(map.nth(3) == map.end());
+
+    for (int key = -1; key <= 30; ++key) {
+        auto expect = key <= 5 ? 0u : key <= 15 ? 1u : key <= 25 ? 2u : 3u;
+        TEST_EQUAL(map.rank(key), expect);
+    }
+
+    static constexpr int iterations = 2000;
+    static constexpr int range = 1000;
+
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 20)(rng);
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(map.erase(Itv(a, b)));
+        } else {
+            TRY(map.insert(Itv(a, b), std::string(1, char('a' + random_int(0, 3)(rng)))));
+        }
+
+        auto key = random_int(-1, range + 21)(rng);
+        auto expect = static_cast<std::size_t>(std::distance(map.begin(), map.lower_bound(key)));
+        TEST_EQUAL(map.rank(key), expect);
+
+        auto n = static_cast<std::size_t>(random_int(0, static_cast<int>(map.size()))(rng));
+        TEST(map.nth(n) == std::next(map.begin(), static_cast<std::ptrdiff_t>(n)));
+
+    }
+
+    // Iterators follow their entries when the map is moved
+
+    auto it = map.nth(map.size() / 2);
+    auto key = it->first;
+    Map moved(std::move(map));
+    TEST_EQUAL(it->first, key);
+    TEST(moved.nth(moved.size() / 2) == it);
+
 }
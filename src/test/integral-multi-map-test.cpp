@@ -0,0 +1,194 @@
+#include "rs-interval/interval.hpp"
+#include "rs-interval/multi-map.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Multi = IntervalMultiMap<int, std::string>;
+
+void test_rs_interval_integral_multi_map_basics() {
+
+    Multi map;
+    Multi::iterator it;
+    std::string str;
+
+    auto list = [] (const std::vector<Multi::iterator>& its) {
+        std::string s;
+        for (auto i: its) {
+            s += i->second;
+        }
+        return s;
+    };
+
+    TEST(map.empty());
+    TEST_EQUAL(map.count(42), 0u);
+    TEST_EQUAL(list(map.stab(42)), "");
+    TEST_EQUAL(std::format("{}", map), "{}");
+
+    TRY((map = {{{10,20}, "a"}, {{15,30}, "b"}, {{5,12}, "c"}, {{10,20}, "d"}, {{25,25}, "e"}}));
+    TEST_EQUAL(map.size(), 5u);
+    TEST_EQUAL(std::format("{}", map), "{[5,12]:c,[10,20]:a,[10,20]:d,[15,30]:b,25:e}");
+
+    TEST_EQUAL(list(map.stab(4)), "");
+    TEST_EQUAL(list(map.stab(5)), "c");
+    TEST_EQUAL(list(map.stab(11)), "cad");
+    TEST_EQUAL(list(map.stab(15)), "adb");
+    TEST_EQUAL(list(map.stab(25)), "be");
+    TEST_EQUAL(list(map.stab(31)), "");
+    TEST_EQUAL(map.count(20), 3u);
+    TEST(map.contains(30));
+    TEST(! map.contains(31));
+
+    TEST_EQUAL(list(map.overlapping(Itv(0,9))), "c");
+    TEST_EQUAL(list(map.overlapping(Itv(21,24))), "b");
+    TEST_EQUAL(list(map.overlapping(Itv(12,15,"()"))), "ad");
+    TEST_EQUAL(list(map.overlapping(Itv(26,26,">="))), "b");
+    TEST_EQUAL(list(map.overlapping(Itv::all())), "cadbe");
+    TEST_EQUAL(list(map.overlapping(Itv())), "");
+    TEST_EQUAL(map.count_overlapping(Itv(20,25)), 4u);
+
+    TRY(it = map.insert(Itv(10,20), "f"));
+    TEST_EQUAL(it->second, "f");
+    TEST_EQUAL(list(map.stab(15)), "adfb");
+    TRY(it = map.insert(Itv(), "g"));
+    TEST(it == map.end());
+    TEST_EQUAL(map.size(), 6u);
+
+    TEST_EQUAL(map.erase({Itv(10,20), "a"}), 1u);
+    TEST_EQUAL(map.erase({Itv(10,20), "x"}), 0u);
+    TEST_EQUAL(list(map.stab(15)), "dfb");
+    TRY(it = map.erase(map.begin()));
+    TEST_EQUAL(it->second, "d");
+    TEST_EQUAL(std::format("{}", map), "{[10,20]:d,[10,20]:f,[15,30]:b,25:e}");
+
+    TRY(map.clear());
+    TEST(map.empty());
+    TEST_EQUAL(list(map.stab(15)), "");
+
+}
+
+void test_rs_interval_integral_multi_map_random() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 200;
+
+    IntervalMultiMap<int, int> map;
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 30)(rng);
+
+        if (random_int(0, 4)(rng) == 0 && ! map.empty()) {
+            auto n = random_int(0, static_cast<int>(map.size()) - 1)(rng);
+            TRY(map.erase(std::next(map.begin(), n)));
+        } else {
+            TRY(map.insert(Itv(a, b), i));
+        }
+
+        a = random_int(- 10, range + 10)(rng);
+        b = a + random_int(0, 10)(rng);
+        Itv q(a, b);
+        std::vector<IntervalMultiMap<int, int>::iterator> expect;
+
+        for (auto j = map.begin(); j != map.end(); ++j) {
+            if (j->first.overlaps(q)) {
+                expect.push_back(j);
+            }
+        }
+
+        TEST(map.overlapping(q) == expect);
+        TEST_EQUAL(map.count_overlapping(q), expect.size());
+
+        std::size_t count = 0;
+
+        for (auto& [in,t]: map) {
+            if (in.contains(a)) {
+                ++count;
+            }
+        }
+
+        TEST_EQUAL(map.count(a), count);
+
+        std::vector<std::pair<Itv, int>> forward(map.begin(), map.end());
+        std::vector<std::pair<Itv, int>> backward;
+
+        for (auto j = map.end(); j != map.begin();) {
+            backward.push_back(*--j);
+        }
+
+        std::ranges::reverse(backward);
+        TEST_EQUAL(forward.size(), map.size());
+        TEST(forward == backward);
+        TEST(std::ranges::is_sorted(forward, [] (auto& x, auto& y) {
+            return x.first.min() < y.first.min() || (x.first.min() == y.first.min() && x.first.max() < y.first.max());
+        }));
+
+    }
+
+}
+
+void test_rs_interval_integral_multi_map_large() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int size = 100'000;
+    static constexpr int range = 1'000'000;
+
+    // Built one entry at a time, which would take quadratic time if each
+    // insertion rebuilt the search structure
+
+    IntervalMultiMap<int, int> map, bulk;
+    std::vector<std::pair<Itv, int>> entries;
+    std::minstd_rand rng(86);
+
+    for (int i = 0; i < size; ++i) {
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 100)(rng);
+        entries.push_back({Itv(a, b), i});
+        TRY(map.insert(Itv(a, b), i));
+    }
+
+    TRY(bulk.assign(entries.begin(), entries.end()));
+    TEST_EQUAL(map.size(), std::size_t(size));
+    TEST(map == bulk);
+
+    for (int i = 0; i < 100; ++i) {
+        int a = random_int(0, range)(rng);
+        Itv q(a, a + random_int(0, 1000)(rng));
+        auto n = static_cast<std::size_t>(std::ranges::count_if(entries, [&q] (auto& e) { return e.first.overlaps(q); }));
+        TEST_EQUAL(map.count_overlapping(q), n);
+        TEST_EQUAL(bulk.count_overlapping(q), n);
+    }
+
+    for (int i = 0; i < size; i += 2) {
+        TEST_EQUAL(map.erase(entries[static_cast<std::size_t>(i)]), 1u);
+    }
+
+    TEST_EQUAL(map.size(), std::size_t(size / 2));
+
+    for (int i = 0; i < 100; ++i) {
+        int a = random_int(0, range)(rng);
+        Itv q(a, a + random_int(0, 1000)(rng));
+        std::size_t n = 0;
+        for (std::size_t k = 1; k < entries.size(); k += 2) {
+            if (entries[k].first.overlaps(q)) {
+                ++n;
+            }
+        }
+        TEST_EQUAL(map.count_overlapping(q), n);
+    }
+
+}
@@ -0,0 +1,129 @@
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/persistent-map.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <cstddef>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Map = IntervalMap<int, std::string>;
+using Persistent = PersistentIntervalMap<int, std::string>;
+
+void test_rs_interval_integral_persistent_map_basics() {
+
+    Persistent map;
+
+    TEST(map.empty());
+    TEST_EQUAL(map.size(), 0u);
+    TEST_EQUAL(map[42], "");
+    TEST(map.find(42) == map.end());
+    TEST_EQUAL(std::format("{}", map), "{}");
+
+    TRY((map = {{{1,10}, "a"}, {{11,20}, "a"}, {{25,30}, "b"}, {{40,50}, "c"}}));
+    TEST_EQUAL(map.size(), 3u);
+    TEST_EQUAL(std::format("{}", map), "{[1,20]:a,[25,30]:b,[40,50]:c}");
+    TEST_EQUAL(map[0], "");
+    TEST_EQUAL(map[15], "a");
+    TEST_EQUAL(map[25], "b");
+    TEST_EQUAL(map[35], "");
+    TEST(map.contains(50));
+    TEST(! map.contains(51));
+    TEST_EQUAL(map.find(45)->second, "c");
+    TEST_EQUAL(map.rank(22), 1u);
+    TEST_EQUAL(map.nth(1)->second, "b");
+    TEST_EQUAL(map.count_overlapping(Itv(20,40)), 3u);
+    TEST_EQUAL(map.overlapping(Itv(21,26)).begin()->second, "b");
+
+    TRY((map = {{{1,10}, "a"}, {{5,15}, "b"}}));
+    TEST_EQUAL(std::format("{}", map), "{[1,4]:a,[5,15]:b}");
+
+    Persistent other("x");
+    TEST_EQUAL(other[42], "x");
+    TEST_EQUAL(other.default_value(), "x");
+    TEST_EQUAL(other.insert(Itv(1,2), "y").default_value(), "x");
+
+    Map source("z");
+    TRY(source.insert(Itv(1,5), "p"));
+    TRY(source.insert(Itv(7,9), "q"));
+    Persistent copy(source);
+    TEST_EQUAL(std::format("{}", copy), "{[1,5]:p,[7,9]:q}");
+    TEST_EQUAL(copy[6], "z");
+    TEST(copy.to_map() == source);
+    TEST_EQUAL(copy.to_map().default_value(), "z");
+
+}
+
+void test_rs_interval_integral_persistent_map_versions() {
+
+    Persistent v0 = {{{0,9}, "a"}, {{20,29}, "b"}, {{40,49}, "c"}};
+    Persistent v1, v2, v3, v4;
+
+    TRY(v1 = v0.insert(Itv(5,24), "d"));
+    TRY(v2 = v1.insert(Itv(25,45), "b"));
+    TRY(v3 = v2.erase(Itv(10,30)));
+    TRY(v4 = v3.insert(Itv(3,3), "e"));
+
+    TEST_EQUAL(std::format("{}", v0), "{[0,9]:a,[20,29]:b,[40,49]:c}");
+    TEST_EQUAL(std::format("{}", v1), "{[0,4]:a,[5,24]:d,[25,29]:b,[40,49]:c}");
+    TEST_EQUAL(std::format("{}", v2), "{[0,4]:a,[5,24]:d,[25,45]:b,[46,49]:c}");
+    TEST_EQUAL(std::format("{}", v3), "{[0,4]:a,[5,9]:d,[31,45]:b,[46,49]:c}");
+    TEST_EQUAL(std::format("{}", v4), "{[0,2]:a,3:e,4:a,[5,9]:d,[31,45]:b,[46,49]:c}");
+
+    TEST(v0.insert(Itv(2,3), "a") == v0);
+    TEST(v0.insert(Itv(), "x") == v0);
+    TEST(v0.erase(Itv(10,19)) == v0);
+    TEST(v0 != v1);
+    TEST(v4.erase(Itv::all()).empty());
+
+}
+
+void test_rs_interval_integral_persistent_map_random() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 200;
+
+    std::vector<Persistent> versions(1);
+    std::vector<Map> expect(1);
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        auto k = static_cast<std::size_t>(random_int(0, static_cast<int>(versions.size()) - 1)(rng));
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 20)(rng);
+        Itv in(a, b);
+        auto map = expect[k];
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(versions.push_back(versions[k].erase(in)));
+            TRY(map.erase(in));
+        } else {
+            std::string value(1, static_cast<char>('a' + random_int(0, 3)(rng)));
+            TRY(versions.push_back(versions[k].insert(in, value)));
+            TRY(map.insert(in, value));
+        }
+
+        expect.push_back(map);
+        auto& p = versions.back();
+        TEST(p.to_map() == map);
+        TEST_EQUAL(p.size(), map.size());
+
+        int x = random_int(- 10, range + 30)(rng);
+        TEST_EQUAL(p[x], map[x]);
+        TEST_EQUAL(p.rank(x), map.rank(x));
+
+    }
+
+    for (std::size_t k = 0; k < versions.size(); ++k) {
+        TEST(versions[k].to_map() == expect[k]);
+    }
+
+}
@@ -0,0 +1,125 @@
+#include "rs-interval/interval.hpp"
+#include "rs-interval/persistent-set.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <cstddef>
+#include <format>
+#include <random>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Set = IntervalSet<int>;
+using Persistent = PersistentIntervalSet<int>;
+
+void test_rs_interval_integral_persistent_set_basics() {
+
+    Persistent set;
+
+    TEST(set.empty());
+    TEST_EQUAL(set.size(), 0u);
+    TEST(! set[42]);
+    TEST(set.begin() == set.end());
+    TEST_EQUAL(std::format("{}", set), "{}");
+
+    TRY((set = {{10,19}, {30,39}, {25,25}, {0,5}, {6,8}}));
+    TEST_EQUAL(set.size(), 4u);
+    TEST_EQUAL(std::format("{}", set), "{[0,8],[10,19],25,[30,39]}");
+    TEST_EQUAL(std::format("{}", Persistent(42)), "{42}");
+    TEST_EQUAL(std::format("{}", Persistent(Itv(1,5))), "{[1,5]}");
+    TEST_EQUAL(std::format("{}", Persistent(Itv())), "{}");
+    TEST_EQUAL(std::format("{}", Persistent(Set{{1,2}, {4,5}})), "{[1,2],[4,5]}");
+
+    TEST(set[0]);
+    TEST(set[8]);
+    TEST(! set[9]);
+    TEST(set[25]);
+    TEST(! set[26]);
+    TEST(! set[40]);
+    TEST_EQUAL(set.rank(-1), 0u);
+    TEST_EQUAL(set.rank(9), 1u);
+    TEST_EQUAL(set.rank(25), 2u);
+    TEST_EQUAL(set.rank(99), 4u);
+    TEST_EQUAL(std::format("{}", *set.nth(2)), "25");
+    TEST(set.nth(4) == set.end());
+    TEST_EQUAL(set.count_overlapping(Itv(8,25)), 3u);
+    TEST_EQUAL(set.count_overlapping(Itv(20,24)), 0u);
+    TEST_EQUAL(std::format("{}", Persistent(set.overlapping(Itv(18,30)).begin(), set.overlapping(Itv(18,30)).end())),
+        "{[10,19],25,[30,39]}");
+    TEST_EQUAL(set.to_set(), (Set{{0,8}, {10,19}, {25,25}, {30,39}}));
+
+}
+
+void test_rs_interval_integral_persistent_set_versions() {
+
+    Persistent v0 = {{0,9}, {20,29}, {40,49}};
+    Persistent v1, v2, v3;
+
+    TRY(v1 = v0.insert(Itv(10,15)));
+    TRY(v2 = v1.erase(Itv(5,24)));
+    TRY(v3 = v2.insert(Itv(30,39)));
+
+    TEST_EQUAL(std::format("{}", v0), "{[0,9],[20,29],[40,49]}");
+    TEST_EQUAL(std::format("{}", v1), "{[0,15],[20,29],[40,49]}");
+    TEST_EQUAL(std::format("{}", v2), "{[0,4],[25,29],[40,49]}");
+    TEST_EQUAL(std::format("{}", v3), "{[0,4],[25,49]}");
+
+    TEST(v0 != v1);
+    TEST(v0.insert(Itv(2,3)) == v0);
+    TEST(v0.insert(Itv()) == v0);
+    TEST(v0.erase(Itv(10,19)) == v0);
+    TEST(v1.erase(Itv(10,15)) == v0);
+    TEST(v3.erase(Itv::all()).empty());
+    TEST_EQUAL(std::format("{}", v3.insert(Itv(0,0,">="))), "{>=0}");
+    TEST_EQUAL(std::format("{}", v3.erase(Itv(2,2))), "{[0,1],[3,4],[25,49]}");
+
+}
+
+void test_rs_interval_integral_persistent_set_random() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 200;
+
+    std::vector<Persistent> versions(1);
+    std::vector<Set> expect(1);
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        // Each update is applied to a randomly chosen earlier version
+
+        auto k = static_cast<std::size_t>(random_int(0, static_cast<int>(versions.size()) - 1)(rng));
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 20)(rng);
+        Itv in(a, b);
+        auto set = expect[k];
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(versions.push_back(versions[k].erase(in)));
+            TRY(set.erase(in));
+        } else {
+            TRY(versions.push_back(versions[k].insert(in)));
+            TRY(set.insert(in));
+        }
+
+        expect.push_back(set);
+        auto& p = versions.back();
+        TEST_EQUAL(p.to_set(), set);
+        TEST_EQUAL(p.size(), set.size());
+
+        int x = random_int(- 10, range + 30)(rng);
+        TEST_EQUAL(p[x], set[x]);
+        TEST_EQUAL(p.rank(x), set.rank(x));
+        TEST_EQUAL(p.count_overlapping(Itv(x, x + 10)), set.count_overlapping(Itv(x, x + 10)));
+
+    }
+
+    for (std::size_t k = 0; k < versions.size(); ++k) {
+        TEST_EQUAL(versions[k].to_set(), expect[k]);
+    }
+
+}
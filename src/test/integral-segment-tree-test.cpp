@@ -0,0 +1,261 @@
+#include "rs-interval/flat-map.hpp"
+#include "rs-interval/interval.hpp"
+#include "rs-interval/map.hpp"
+#include "rs-interval/segment-tree.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Map = IntervalMap<int, int>;
+using Tree = IntervalSegmentTree<int, int>;
+
+void test_rs_interval_integral_segment_tree_basics() {
+
+    Tree tree;
+
+    TEST_EQUAL(tree.size(), 1u);
+    TEST_EQUAL(tree[42], 0);
+    TEST_EQUAL(tree.sum(Itv(1,10)), 0);
+    TEST_EQUAL(tree.max(Itv::all()), 0);
+    TEST_EQUAL(std::format("{}", tree.to_map()), "{}");
+
+    TRY(tree.add(Itv(1,10), 2));
+    TRY(tree.add(Itv(5,15), 3));
+    TRY(tree.add(Itv(8,8), -10));
+    TEST_EQUAL(tree.size(), 7u);
+    TEST_EQUAL(tree[0], 0);
+    TEST_EQUAL(tree[1], 2);
+    TEST_EQUAL(tree[5], 5);
+    TEST_EQUAL(tree[8], -5);
+    TEST_EQUAL(tree[11], 3);
+    TEST_EQUAL(tree[16], 0);
+    TEST_EQUAL(std::format("{}", tree.to_map()), "{[1,4]:2,[5,7]:5,8:-5,[9,10]:5,[11,15]:3}");
+
+    TEST_EQUAL(tree.sum(Itv(1,4)), 8);
+    TEST_EQUAL(tree.sum(Itv(0,20)), 8 + 15 - 5 + 10 + 15);
+    TEST_EQUAL(tree.sum(Itv(3,6)), 2 + 2 + 5 + 5);
+    TEST_EQUAL(tree.min(Itv(1,20)), -5);
+    TEST_EQUAL(tree.min(Itv(1,7)), 2);
+    TEST_EQUAL(tree.max(Itv(1,20)), 5);
+    TEST_EQUAL(tree.max(Itv(11,20)), 3);
+    TEST_EQUAL(tree.max(Itv(9,9)), 5);
+    TEST_EQUAL(tree.max(Itv(16,16,">=")), 0);
+    TEST_EQUAL(tree.min(Itv::all()), -5);
+
+    TEST_EQUAL(tree.sum(Itv()), 0);
+    TEST_THROW(tree.sum(Itv(1,1,">=")), std::invalid_argument, "unbounded");
+    TEST_THROW(tree.min(Itv()), std::invalid_argument, "empty");
+    TEST_THROW(tree.max(Itv()), std::invalid_argument, "empty");
+
+    TRY(tree.add(Itv(10,10,"<="), -2));
+    TRY(tree.add(Itv(5,5,">="), 2));
+    TEST_EQUAL(std::format("{}", tree.to_map()), "{<=0:-2,[5,7]:5,8:-5,[9,15]:5,>=16:2}");
+    TEST_EQUAL(tree[-1'000'000], -2);
+    TEST_EQUAL(tree[1'000'000], 2);
+    TEST_EQUAL(tree.min(Itv::all()), -5);
+    TEST_EQUAL(tree.max(Itv(16,16,">=")), 2);
+
+}
+
+void test_rs_interval_integral_segment_tree_from_map() {
+
+    Map map(1);
+    TRY((map = {{{5,10}, 4}, {{15,20}, 7}}));
+    TRY(map.default_value(1));
+
+    Tree tree(map);
+    TEST_EQUAL(tree.size(), 5u);
+    TEST_EQUAL(tree.default_value(), 1);
+    TEST_EQUAL(tree[0], 1);
+    TEST_EQUAL(tree[5], 4);
+    TEST_EQUAL(tree[12], 1);
+    TEST_EQUAL(tree[20], 7);
+    TEST_EQUAL(tree[21], 1);
+    TEST_EQUAL(tree.sum(Itv(0,30)), 5 + 24 + 4 + 42 + 10);
+    TEST_EQUAL(std::format("{}", tree.to_map()), "{[5,10]:4,[15,20]:7}");
+
+    TRY(tree.add(Itv(8,16), 3));
+    TEST_EQUAL(tree.max(Itv(0,30)), 10);
+    TEST_EQUAL(tree.max(Itv(11,14)), 4);
+    TEST_EQUAL(std::format("{}", tree.to_map()), "{[5,7]:4,[8,10]:7,[11,14]:4,[15,16]:10,[17,20]:7}");
+
+    Tree flat(FlatIntervalMap<int, int>(tree.to_map()));
+    TEST_EQUAL(flat.sum(Itv(0,30)), tree.sum(Itv(0,30)));
+    TEST_EQUAL(flat.max(Itv::all()), 10);
+
+    IntervalSegmentTree<int, double> real;
+    TRY(real.add(Itv(1,4), 0.5));
+    TEST_EQUAL(real.sum(Itv(0,10)), 2.0);
+    TEST_EQUAL(real.max(Itv(0,10)), 0.5);
+
+}
+
+void test_rs_interval_integral_segment_tree_random_updates() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 10'000;
+    static constexpr int range = 100;
+    static constexpr int margin = 10;
+
+    Tree tree;
+    std::vector<int> expect(range + 2 * margin + 1, 0);
+    std::minstd_rand rng(42);
+
+    auto make_interval = [&] (int a, int b) {
+        auto mode = random_int(0, 3)(rng);
+        return Itv(a, b, mode == 0 ? "()" : mode == 1 ? "[)" : mode == 2 ? "(]" : "[]");
+    };
+
+    auto slice = [&] (const Itv& in, auto f) {
+        for (int k = - margin; k <= range + margin; ++k) {
+            if (in.contains(k)) {
+                f(expect[static_cast<std::size_t>(k + margin)]);
+            }
+        }
+    };
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, margin)(rng);
+        auto delta = random_int(-5, 5)(rng);
+        auto in = make_interval(a, b);
+        TRY(tree.add(in, delta));
+        slice(in, [=] (int& x) { x += delta; });
+
+        a = random_int(- margin, range)(rng);
+        b = a + random_int(0, 30)(rng);
+        auto q = make_interval(a, std::min(b, range + margin));
+
+        if (q.empty()) {
+            continue;
+        }
+
+        int sum = 0;
+        int low = std::numeric_limits<int>::max();
+        int high = std::numeric_limits<int>::min();
+        slice(q, [&] (int x) { sum += x; low = std::min(low, x); high = std::max(high, x); });
+        TEST_EQUAL(tree.sum(q), sum);
+        TEST_EQUAL(tree.min(q), low);
+        TEST_EQUAL(tree.max(q), high);
+
+        auto key = random_int(- margin, range + margin)(rng);
+        TEST_EQUAL(tree[key], expect[static_cast<std::size_t>(key + margin)]);
+
+    }
+
+    std::size_t changes = expect.back() != 0;
+    for (std::size_t k = 1; k < expect.size(); ++k) {
+        changes += expect[k] != expect[k - 1];
+    }
+    TEST_EQUAL(tree.size(), changes + 1);
+
+    Map map;
+    TRY(map = tree.to_map());
+    int total = 0;
+    for (auto& [in,t]: map) {
+        total += t * static_cast<int>(in.size());
+    }
+    TEST_EQUAL(total, std::accumulate(expect.begin(), expect.end(), 0));
+
+}
+
+void test_rs_interval_integral_segment_tree_coalescing() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int cycles = 1000;
+    static constexpr int reservations = 20;
+    static constexpr int range = 1000;
+
+    Tree tree;
+
+    TRY(tree.add(Itv(1,10), 2));
+    TRY(tree.add(Itv(11,20), 2));
+    TEST_EQUAL(tree.size(), 3u);
+    TEST_EQUAL(std::format("{}", tree.to_map()), "{[1,20]:2}");
+    TRY(tree.add(Itv(5,15), 3));
+    TEST_EQUAL(tree.size(), 5u);
+    TRY(tree.add(Itv(5,15), -3));
+    TEST_EQUAL(tree.size(), 3u);
+    TRY(tree.add(Itv(1,20), -2));
+    TEST_EQUAL(tree.size(), 1u);
+    TEST_EQUAL(std::format("{}", tree.to_map()), "{}");
+
+    Map map;
+    TRY((map = {{{1,5}, 0}, {{6,10}, 3}, {{11,15}, 3}}));
+    Tree from_map(map);
+    TEST_EQUAL(from_map.size(), 3u);
+    TEST_EQUAL(std::format("{}", from_map.to_map()), "{[6,15]:3}");
+
+    // Reserve and release load over varying ranges; the tree must return
+    // to a single segment at the end of every cycle
+
+    std::vector<std::pair<Itv, int>> active;
+    std::minstd_rand rng(42);
+    std::size_t peak = 0;
+
+    for (int i = 0; i < cycles; ++i) {
+
+        for (int j = 0; j < reservations; ++j) {
+            int a = random_int(0, range)(rng);
+            int b = a + random_int(0, 100)(rng);
+            auto& [in, load] = active.emplace_back(Itv(a, b), random_int(1, 10)(rng));
+            TRY(tree.add(in, load));
+            TEST(tree.size() <= 2u * active.size() + 1u);
+        }
+
+        peak = std::max(peak, tree.size());
+        std::shuffle(active.begin(), active.end(), rng);
+
+        for (auto& [in, load]: active) {
+            TRY(tree.add(in, - load));
+        }
+
+        active.clear();
+        TEST_EQUAL(tree.size(), 1u);
+        TEST_EQUAL(tree.max(Itv::all()), 0);
+
+    }
+
+    TEST(peak <= 2u * reservations + 1u);
+
+}
+
+void test_rs_interval_integral_segment_tree_unsigned_keys() {
+
+    using UItv = Interval<unsigned>;
+    using UTree = IntervalSegmentTree<unsigned, int>;
+
+    static_assert(std::same_as<UTree::sum_type, std::intmax_t>);
+    static_assert(std::same_as<IntervalSegmentTree<int, unsigned>::sum_type, std::uintmax_t>);
+    static_assert(std::same_as<IntervalSegmentTree<unsigned, float>::sum_type, double>);
+
+    UTree tree;
+
+    TRY(tree.add(UItv(10u, 19u), -5));
+    TEST_EQUAL(tree[15u], -5);
+    TEST_EQUAL(tree.sum(UItv(10u, 19u)), -50);
+    TEST_EQUAL(tree.sum(UItv(0u, 100u)), -50);
+    TEST_EQUAL(tree.sum(UItv(15u, 24u)), -25);
+    TEST_EQUAL(tree.min(UItv(0u, 100u)), -5);
+
+    TRY(tree.add(UItv(15u, 29u), 2));
+    TEST_EQUAL(tree.sum(UItv(0u, 100u)), -20);
+    TEST_EQUAL(tree.sum(UItv(10u, 14u)), -25);
+    TEST_EQUAL(tree.sum(UItv(15u, 19u)), -15);
+    TEST_EQUAL(tree.sum(UItv(20u, 29u)), 20);
+
+}
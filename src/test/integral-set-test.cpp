@@ -2,9 +2,14 @@
 #include "rs-interval/set.hpp"
 #include "rs-interval/types.hpp"
 #include "test/unit-test.hpp"
+#include <algorithm>
+#include <cstddef>
 #include <format>
+#include <iterator>
+#include <memory>
 #include <print>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -87,6 +92,14 @@ void test_rs_interval_integral_set_construct_insert_erase() {
     TRY((set.erase({16,18,"()"})));   TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{11,[15,16],[18,29]}");
     TRY((set.insert({9,11})));        TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[9,11],[15,16],[18,29]}");
     TRY((set.insert({29,31,"()"})));  TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[9,11],[15,16],[18,30]}");
+    TRY(set.apply_union(set));        TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[9,11],[15,16],[18,30]}");
+    TRY((com = {{1,3},{5,8},{12,14},{17,17},{25,40}}));
+    TRY(set.apply_union(com));        TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{[1,3],[5,40]}");
+    TRY((com = {{2,6},{10,10},{40,45}}));
+    TRY(set.apply_difference(com));   TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{1,[7,9],[11,39]}");
+    TEST_EQUAL(set.cardinality(), 33u);
+    TRY(set.apply_difference(set));   TRY(str = std::format("{}", set));  TEST_EQUAL(str, "{}");
+    TEST_EQUAL(set.cardinality(), 0u);
 
 }
 
@@ -233,3 +246,490 @@ void test_rs_interval_integral_set_operations() {
     }
 
 }
+
+void test_rs_interval_integral_set_bulk_construction() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Set expect, set;
+    std::vector<Itv> vec;
+    Itv in;
+    std::minstd_rand rng(42);
+
+    static constexpr int iterations = 1000;
+    static constexpr int max_size = 20;
+    static constexpr int max_value = 100;
+
+    TRY(set = Set(vec.begin(), vec.end()));
+    TEST(set.empty());
+
+    for (int i = 0; i < iterations; ++i) {
+
+        TRY(expect.clear());
+        vec.clear();
+        int size = random_int(1, max_size)(rng);
+
+        for (int k = 0; k < size; ++k) {
+            int a = random_int(1, max_value)(rng);
+            int b = random_int(1, max_value)(rng);
+            auto l = Bound(random_int(0, 3)(rng));
+            auto r = Bound(random_int(0, 3)(rng));
+            if ((l == Bound::empty) == (r == Bound::empty)) {
+                TRY(in = Itv(a, b, l, r));
+                vec.push_back(in);
+                TRY(expect.insert(in));
+            }
+        }
+
+        TRY(set = Set(vec.begin(), vec.end()));
+        TEST_EQUAL(set, expect);
+        TEST_EQUAL(std::format("{}", set), std::format("{}", expect));
+
+        TRY(set.assign(vec.rbegin(), vec.rend()));
+        TEST_EQUAL(set, expect);
+
+    }
+
+    std::vector<int> values = {10, 3, 4, 2, 9, 5, 20, 3};
+
+    TRY(set = Set(values.begin(), values.end()));
+    TEST_EQUAL(std::format("{}", set), "{[2,5],[9,10],20}");
+
+    TRY(set.assign(values.begin(), values.begin()));
+    TEST(set.empty());
+
+}
+
+void test_rs_interval_integral_set_bulk_construction_large() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Set expect, set;
+    std::vector<Itv> vec;
+    Itv in;
+    std::minstd_rand rng(86);
+
+    static constexpr int iterations = 20;
+    static constexpr int size = 2000;
+    static constexpr int max_value = 100'000;
+
+    for (int i = 0; i < iterations; ++i) {
+
+        TRY(expect.clear());
+        vec.clear();
+
+        for (int k = 0; k < size; ++k) {
+            int a = random_int(- max_value, max_value)(rng);
+            int b = a + random_int(0, 100)(rng);
+            int mode = random_int(0, 99)(rng);
+            if (mode == 0) {
+                TRY(in = Itv(a, Bound::unbound, Bound::closed));
+            } else if (mode == 1) {
+                TRY(in = Itv(a, Bound::closed, Bound::unbound));
+            } else {
+                TRY(in = Itv(a, b, Bound(random_int(1, 2)(rng)), Bound(random_int(1, 2)(rng))));
+            }
+            vec.push_back(in);
+            TRY(expect.insert(in));
+        }
+
+        TRY(set = Set(vec.begin(), vec.end()));
+        TEST_EQUAL(set, expect);
+
+    }
+
+}
+
+void test_rs_interval_integral_set_batch_query() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Set set;
+    std::vector<int> keys, expect, members;
+    std::minstd_rand rng(99);
+    bool flags[1] = {};
+
+    static constexpr int iterations = 100;
+    static constexpr int max_size = 50;
+    static constexpr int max_value = 1000;
+    static constexpr int num_keys = 200;
+
+    TRY(set.contains_batch({}, {}));
+    TEST_THROW(set.contains_batch(std::vector<int>{1, 2}, flags), std::invalid_argument, "size");
+
+    for (int i = 0; i < iterations; ++i) {
+
+        TRY(set.clear());
+        int size = random_int(0, max_size)(rng);
+
+        for (int k = 0; k < size; ++k) {
+            int a = random_int(1, max_value)(rng);
+            int b = a + random_int(0, 30)(rng);
+            TRY(set.insert(Itv(a, b, Bound(random_int(1, 2)(rng)), Bound(random_int(1, 2)(rng)))));
+        }
+
+        keys.clear();
+
+        for (int k = 0; k < num_keys; ++k) {
+            keys.push_back(random_int(- 10, max_value + 50)(rng));
+        }
+
+        for (int pass = 0; pass < 2; ++pass) {
+
+            if (pass == 1) {
+                std::ranges::sort(keys);
+            }
+
+            auto out = std::make_unique<bool[]>(keys.size());
+            expect.clear();
+            TRY(set.contains_batch(keys, {out.get(), keys.size()}));
+
+            for (std::size_t k = 0; k < keys.size(); ++k) {
+                TEST_EQUAL(out[k], set.contains(keys[k]));
+                if (set.contains(keys[k])) {
+                    expect.push_back(keys[k]);
+                }
+            }
+
+            TRY(members = set.filter(keys));
+            TEST(members == expect);
+
+        }
+
+    }
+
+}
+
+void test_rs_interval_integral_set_overlapping() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Set set;
+    std::string str;
+
+    auto list = [&] (const Itv& in) {
+        std::string s;
+        for (auto& x: set.overlapping(in)) {
+            s += std::format("{};", x);
+        }
+        return s;
+    };
+
+    TEST_EQUAL(list(Itv(1,10)), "");
+    TEST_EQUAL(set.count_overlapping(Itv::all()), 0u);
+
+    TRY((set = {{1,5}, {10,15}, {20,25}, {30,35}}));
+    TEST_EQUAL(list(Itv(6,9)), "");
+    TEST_EQUAL(list(Itv(5,9)), "[1,5];");
+    TEST_EQUAL(list(Itv(5,10)), "[1,5];[10,15];");
+    TEST_EQUAL(list(Itv(12,32)), "[10,15];[20,25];[30,35];");
+    TEST_EQUAL(list(Itv(16,19)), "");
+    TEST_EQUAL(list(Itv(26,26,">=")), "[30,35];");
+    TEST_EQUAL(list(Itv::all()), "[1,5];[10,15];[20,25];[30,35];");
+    TEST_EQUAL(list(Itv()), "");
+    TEST_EQUAL(set.count_overlapping(Itv(0,21)), 3u);
+    TEST_EQUAL(set.count_overlapping(Itv(36,40)), 0u);
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 100;
+
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 10)(rng);
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(set.erase(Itv(a, b)));
+        } else {
+            TRY(set.insert(Itv(a, b)));
+        }
+
+        a = random_int(0, range)(rng);
+        b = a + random_int(0, 20)(rng);
+        Itv q(a, b);
+        std::string expect;
+        std::size_t count = 0;
+
+        for (auto& x: set) {
+            if (x.overlaps(q)) {
+                expect += std::format("{};", x);
+                ++count;
+            }
+        }
+
+        TEST_EQUAL(list(q), expect);
+        TEST_EQUAL(set.count_overlapping(q), count);
+
+    }
+
+}
+
+void test_rs_interval_integral_set_nth_rank() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Set set;
+
+    TEST(set.nth(0) == set.end());
+    TEST_EQUAL(set.rank(42), 0u);
+
+    TRY((set = {{1,5}, {10,15}, {20,25}, {30,35}}));
+    TEST(set.nth(0) == set.begin());
+    TEST_EQUAL(std::format("{}", *set.nth(2)), "[20,25]");
+    TEST(set.nth(4) == set.end());
+    TEST(set.nth(100) == set.end());
+    TEST_EQUAL(set.rank(0), 0u);
+    TEST_EQUAL(set.rank(5), 0u);
+    TEST_EQUAL(set.rank(6), 1u);
+    TEST_EQUAL(set.rank(29), 3u);
+    TEST_EQUAL(set.rank(36), 4u);
+
+    // Check every position against a walk from each end after each change
+
+    static constexpr int iterations = 2000;
+    static constexpr int range = 2000;
+
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 10)(rng);
+
+        switch (random_int(0, 3)(rng)) {
+            case 0:   TRY(set.erase(Itv(a, b))); break;
+            case 1:   TRY(set.apply_union(Set{Itv(a, b), Itv(b + 5, b + 8)})); break;
+            default:  TRY(set.insert(Itv(a, b))); break;
+        }
+
+        auto key = random_int(-1, range + 11)(rng);
+        auto expect = static_cast<std::size_t>(std::ranges::count_if(set, [key] (const Itv& in) { return in.match(key) == Match::high; }));
+        TEST_EQUAL(set.rank(key), expect);
+
+        if (i % 100 == 0) {
+            std::size_t n = 0;
+            for (auto it = set.begin(); it != set.end(); ++it, ++n) {
+                TEST(set.nth(n) == it);
+            }
+            TEST_EQUAL(n, set.size());
+            for (auto it = set.end(); it != set.begin(); ) {
+                --it;
+                --n;
+                TEST(set.nth(n) == it);
+            }
+        }
+
+    }
+
+    // Iterators follow their intervals when sets are swapped
+
+    Set other = {{1,2}};
+    auto it = set.nth(3);
+    auto in = *it;
+    TRY(set.swap(other));
+    TEST_EQUAL(*it, in);
+    TEST(other.nth(3) == it);
+    TEST_EQUAL(set.size(), 1u);
+
+}
+
+void test_rs_interval_integral_set_cardinality() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    Set set;
+
+    TEST_EQUAL(set.cardinality(), 0u);
+    TEST_EQUAL(set.cardinality(Itv::all()), 0u);
+
+    TRY((set = {{1,5}, {10,15}, {20,25}}));
+    TEST_EQUAL(set.cardinality(), 17u);
+    TEST_EQUAL(set.cardinality(Itv(3,12)), 6u);
+    TEST_EQUAL(set.cardinality(Itv(6,9)), 0u);
+    TEST_EQUAL(set.cardinality(Itv(0,100)), 17u);
+    TEST_EQUAL(set.cardinality(Itv()), 0u);
+
+    TRY(set.insert(Itv(4,11)));
+    TEST_EQUAL(set.cardinality(), 21u);
+    TRY(set.erase(Itv(12,21)));
+    TEST_EQUAL(set.cardinality(), 15u);
+    TRY(set.insert(Itv(30,30,">=")));
+    TEST_EQUAL(set.cardinality(), npos);
+    TEST_EQUAL(set.cardinality(Itv(0,40)), 26u);
+    TEST_EQUAL(set.cardinality(Itv(0,0,">=")), npos);
+    TRY(set.erase(Itv(30,30,">=")));
+    TEST_EQUAL(set.cardinality(), 15u);
+    TRY(set.apply_complement());
+    TEST_EQUAL(set.cardinality(), npos);
+    TEST_EQUAL(set.cardinality(Itv(0,30)), 16u);
+    TRY(set.clear());
+    TEST_EQUAL(set.cardinality(), 0u);
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 1000;
+
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(0, range)(rng);
+        int b = a + random_int(0, 10)(rng);
+        Itv in(a, b);
+
+        switch (random_int(0, 3)(rng)) {
+            case 0:   TRY(set.erase(in)); break;
+            case 1:   TRY(set.apply_union(Set{in, Itv(b + 5, b + 8)})); break;
+            case 2:   TRY(set.apply_difference(Set{in, Itv(b + 5, b + 8)})); break;
+            default:  TRY(set.insert(in)); break;
+        }
+
+        std::size_t total = 0;
+
+        for (auto& x: set) {
+            total += x.size();
+        }
+
+        TEST_EQUAL(set.cardinality(), total);
+
+        a = random_int(0, range)(rng);
+        b = a + random_int(0, 300)(rng);
+        Itv q(a, b);
+        total = 0;
+
+        for (auto& x: set) {
+            total += x.set_intersection(q).size();
+        }
+
+        TEST_EQUAL(set.cardinality(q), total);
+
+    }
+
+}
+
+void test_rs_interval_integral_set_common_gap() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    std::vector<Set> busy = {
+        {{0,9}, {20,29}},
+        {{5,14}, {25,34}},
+        {{10,19}, {40,49}},
+    };
+
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 5, 1)), "[0,4]");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 6, 1)), "[0,5]");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 5, 2)), "[0,4]");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 5, 3)), "[35,39]");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 0, 10, 2)), "[30,39]");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, -100, 5, 3)), "[-100,-96]");
+    TEST_EQUAL(std::format("{}", find_common_gap(busy, 12, 3, 1)), "[12,14]");
+    TEST(find_common_gap(busy, 0, 1, 4).empty());
+    TEST_THROW(find_common_gap(busy, 0, 0, 1), std::invalid_argument, "positive");
+    TEST_THROW(find_common_gap(busy, 0, 1, 0), std::invalid_argument, "positive");
+
+    std::vector<Set> unbounded = {{{10,10,">="}}, {{0,0,"<="}}};
+    TEST_EQUAL(std::format("{}", find_common_gap(unbounded, -5, 5, 1)), "[-5,-1]");
+    TEST_EQUAL(std::format("{}", find_common_gap(unbounded, -5, 9, 2)), "[1,9]");
+    TEST(find_common_gap(unbounded, -5, 10, 2).empty());
+
+    static constexpr int iterations = 100;
+    static constexpr int range = 200;
+
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        auto m = random_int(1, 6)(rng);
+        std::vector<Set> sets(static_cast<std::size_t>(m));
+
+        for (auto& set: sets) {
+            for (int j = random_int(0, 15)(rng); j > 0; --j) {
+                int a = random_int(0, range)(rng);
+                set.insert(Itv(a, a + random_int(0, 20)(rng)));
+            }
+        }
+
+        auto from = random_int(-10, range)(rng);
+        auto length = random_int(1, 20)(rng);
+        auto k = static_cast<std::size_t>(random_int(1, m)(rng));
+        Itv expect;
+
+        for (int t = from; expect.empty(); ++t) {
+            Itv window(t, t + length - 1);
+            auto count = std::ranges::count_if(sets, [&window] (const Set& set) { return set.count_overlapping(window) == 0; });
+            if (static_cast<std::size_t>(count) >= k) {
+                expect = window;
+            }
+        }
+
+        TEST_EQUAL(find_common_gap(sets, from, static_cast<std::size_t>(length), k), expect);
+
+    }
+
+}
+
+void test_rs_interval_integral_set_parallel_operations() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int size = 10'000;
+    static constexpr int max_value = 1'000'000;
+
+    std::minstd_rand rng(99);
+
+    auto make_set = [&rng] {
+        std::vector<Itv> vec;
+        for (int k = 0; k < size; ++k) {
+            int a = random_int(- max_value, max_value)(rng);
+            int b = a + random_int(0, 50)(rng);
+            vec.push_back(Itv(a, b, Bound(random_int(1, 2)(rng)), Bound(random_int(1, 2)(rng))));
+        }
+        vec.push_back(Itv(- max_value, Bound::unbound, Bound::open));
+        return Set(vec.begin(), vec.end());
+    };
+
+    Set a, b, expect, result;
+
+    TRY(a = make_set());
+    TRY(b = make_set());
+    TEST(a.size() > 5000u);
+    TEST(b.size() > 5000u);
+
+    TRY(expect = a.set_intersection(b));
+    for (std::size_t threads = 0; threads <= 8; ++threads) {
+        TRY(result = a.set_intersection(b, threads));
+        TEST_EQUAL(result, expect);
+        TEST_EQUAL(result.cardinality(), expect.cardinality());
+    }
+
+    TRY(expect = a.set_union(b));
+    for (std::size_t threads = 0; threads <= 8; ++threads) {
+        TRY(result = a.set_union(b, threads));
+        TEST_EQUAL(result, expect);
+        TEST_EQUAL(result.cardinality(), expect.cardinality());
+    }
+
+    TRY(expect = a.set_difference(b));
+    for (std::size_t threads = 0; threads <= 8; ++threads) {
+        TRY(result = a.set_difference(b, threads));
+        TEST_EQUAL(result, expect);
+        TEST_EQUAL(result.cardinality(), expect.cardinality());
+    }
+
+    TRY(expect = a.set_symmetric_difference(b));
+    for (std::size_t threads = 0; threads <= 8; ++threads) {
+        TRY(result = set_symmetric_difference(a, b, threads));
+        TEST_EQUAL(result, expect);
+        TEST_EQUAL(result.cardinality(), expect.cardinality());
+    }
+
+    TRY(result = Set().set_union(Set(), 4));
+    TEST(result.empty());
+    TRY(result = a.set_difference(a, 4));
+    TEST(result.empty());
+    TRY(result = a.set_union(a, 4));
+    TEST_EQUAL(result, a);
+
+}
@@ -0,0 +1,207 @@
+#include "rs-interval/interval.hpp"
+#include "rs-interval/set.hpp"
+#include "rs-interval/sharded-set.hpp"
+#include "rs-interval/types.hpp"
+#include "test/unit-test.hpp"
+#include <atomic>
+#include <format>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RS::Interval;
+
+using Itv = Interval<int>;
+using Set = IntervalSet<int>;
+using Sharded = ShardedIntervalSet<int>;
+
+namespace {
+
+    std::string list(const Sharded& set) {
+        std::string s;
+        for (auto& in: set) {
+            s += std::format("{};", in);
+        }
+        return s;
+    }
+
+}
+
+void test_rs_interval_integral_sharded_set_basics() {
+
+    Sharded set({10, 20, 30});
+
+    TEST_EQUAL(set.shards(), 4u);
+    TEST_EQUAL(std::format("{}", set.shard_range(0)), "<=9");
+    TEST_EQUAL(std::format("{}", set.shard_range(1)), "[10,19]");
+    TEST_EQUAL(std::format("{}", set.shard_range(3)), ">=30");
+    TEST(set.empty());
+    TEST(set.begin() == set.end());
+    TEST_EQUAL(list(set), "");
+
+    TRY(set.insert(Itv(5,25)));
+    TRY(set.insert(Itv(27,28)));
+    TRY(set.insert(Itv(40,50)));
+    TEST(! set.empty());
+    TEST_EQUAL(list(set), "[5,25];[27,28];[40,50];");
+    TEST(! set[4]);
+    TEST(set[5]);
+    TEST(set[10]);
+    TEST(set[19]);
+    TEST(set[20]);
+    TEST(! set[26]);
+    TEST(set[45]);
+
+    TRY(set.insert(Itv(26,26)));
+    TEST_EQUAL(list(set), "[5,28];[40,50];");
+    TRY(set.insert(Itv(29,29)));
+    TEST_EQUAL(list(set), "[5,29];[40,50];");
+    TRY(set.insert(Itv(30,39)));
+    TEST_EQUAL(list(set), "[5,50];");
+    TRY(set.erase(Itv(15,15)));
+    TEST_EQUAL(list(set), "[5,14];[16,50];");
+    TRY(set.erase(Itv(19,31)));
+    TEST_EQUAL(list(set), "[5,14];[16,18];[32,50];");
+    TEST_EQUAL(set.to_set(), (Set{{5,14}, {16,18}, {32,50}}));
+    TRY(set.insert(Itv::all()));
+    TEST_EQUAL(list(set), "*;");
+    TRY(set.clear());
+    TEST(set.empty());
+
+    Sharded single;
+    TEST_EQUAL(single.shards(), 1u);
+    TRY(single.insert(Itv(1,5)));
+    TEST_EQUAL(list(single), "[1,5];");
+
+    TEST_THROW(Sharded({10, 10}), std::invalid_argument, "ascending");
+    TEST_THROW(Sharded({20, 10}), std::invalid_argument, "ascending");
+
+}
+
+void test_rs_interval_integral_sharded_set_random() {
+
+    using random_int = std::uniform_int_distribution<int>;
+
+    static constexpr int iterations = 1000;
+    static constexpr int range = 200;
+
+    Sharded set({25, 50, 75, 100, 125, 150, 175});
+    Set expect;
+    std::minstd_rand rng(42);
+
+    for (int i = 0; i < iterations; ++i) {
+
+        int a = random_int(- 10, range)(rng);
+        int b = a + random_int(0, 60)(rng);
+
+        if (random_int(0, 2)(rng) == 0) {
+            TRY(set.erase(Itv(a, b)));
+            TRY(expect.erase(Itv(a, b)));
+        } else {
+            TRY(set.insert(Itv(a, b)));
+            TRY(expect.insert(Itv(a, b)));
+        }
+
+        TEST_EQUAL(set.to_set(), expect);
+        int x = random_int(- 20, range + 70)(rng);
+        TEST_EQUAL(set[x], expect[x]);
+
+    }
+
+}
+
+void test_rs_interval_integral_sharded_set_threads() {
+
+    // Each thread inserts its own interleaved time ranges, which cross
+    // shard boundaries and together cover the whole domain
+
+    static constexpr int threads = 4;
+    static constexpr int blocks = 500;
+    static constexpr int width = 7;
+
+    Sharded set({100, 1000, 2000, 3000});
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&set, t] {
+            for (int b = t; b < blocks; b += threads) {
+                set.insert(Itv(b * width, b * width + width - 1));
+                set.erase(Itv(b * width + 2, b * width + 3));
+                set.insert(Itv(b * width + 2, b * width + 3));
+            }
+        });
+    }
+
+    for (auto& w: workers) {
+        w.join();
+    }
+
+    TEST_EQUAL(set.to_set(), Set(Itv(0, blocks * width - 1)));
+    TEST_EQUAL(list(set), std::format("[0,{}];", blocks * width - 1));
+
+}
+
+void test_rs_interval_integral_sharded_set_iterate_while_writing() {
+
+    // Iteration works on a snapshot, so a reader sees a consistent,
+    // coalesced set while writers keep changing it
+
+    static constexpr int writers = 3;
+    static constexpr int rounds = 2000;
+    static constexpr int width = 10;
+
+    Sharded set({100, 200, 300});
+    std::vector<std::thread> workers;
+    std::atomic<bool> done = false;
+
+    for (int t = 0; t < writers; ++t) {
+        workers.emplace_back([&set, t] {
+            for (int r = 0; r < rounds; ++r) {
+                int a = (r * 37 + t * 101) % 400;
+                set.insert(Itv(a, a + width));
+                set.erase(Itv(a + 3, a + 4));
+            }
+        });
+    }
+
+    int bad = 0;
+    int scans = 0;
+
+    std::thread reader([&] {
+        while (! done) {
+            Itv prev;
+            bool first = true;
+            for (auto& in: set) {
+                if (in.empty() || (! first && (prev.touches(in) || ! (prev < in)))) {
+                    ++bad;
+                }
+                prev = in;
+                first = false;
+            }
+            ++scans;
+        }
+    });
+
+    for (auto& w: workers) {
+        w.join();
+    }
+
+    done = true;
+    reader.join();
+
+    TEST_EQUAL(bad, 0);
+    TEST(scans > 0);
+
+    // An iterator keeps its snapshot after the set changes
+
+    auto it = set.begin();
+    auto before = set.to_set();
+    TRY(set.clear());
+    TEST(set.to_set().empty());
+    TEST(set.begin() == set.end());
+    TEST(it != set.end());
+    TEST_EQUAL(Set(it, set.end()), before);
+
+}
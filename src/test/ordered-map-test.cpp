@@ -1,8 +1,11 @@
+#include "rs-interval/concurrent-map.hpp"
+#include "rs-interval/flat-map.hpp"
 #include "rs-interval/interval.hpp"
 #include "rs-interval/map.hpp"
 #include "rs-interval/set.hpp"
 #include "rs-interval/types.hpp"
 #include "test/unit-test.hpp"
+#include <concepts>
 #include <format>
 #include <string>
 
@@ -152,3 +155,23 @@ void test_rs_interval_ordered_map() {
     TEST_EQUAL(map["l"], "nil");
 
 }
+
+void test_rs_interval_ordered_map_concurrent() {
+
+    using Concurrent = ConcurrentIntervalMap<std::string, std::string>;
+
+    static_assert(std::same_as<Concurrent::snapshot_type, FlatIntervalMap<std::string, std::string>>);
+
+    Concurrent map;
+    Concurrent::reader reader(map);
+
+    TEST_EQUAL(reader["hello"], "");
+    TRY(map.update([] (Map& m) { m.insert(Itv("a", "m"), "first"); }));
+    TEST_EQUAL(reader["hello"], "first");
+    TEST_EQUAL(map["zebra"], "");
+    TEST_EQUAL(std::format("{}", *map.snapshot()), "{[a,m]:first}");
+    TEST(map.find("hello"));
+    TEST(! map.find("zebra"));
+    TEST_EQUAL(reader.find("cat")->second, "first");
+
+}
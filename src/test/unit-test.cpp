@@ -28,10 +28,25 @@ void test_rs_interval_continuous_boundary_to_interval();
 void test_rs_interval_continuous_boundary_adjacency();
 void test_rs_interval_continuous_boundary_comparison();
 void test_rs_interval_continuous_boundary_multiplication();
+void test_rs_interval_continuous_flat_set_construct_insert_erase();
+void test_rs_interval_continuous_flat_set_operations();
+void test_rs_interval_continuous_flat_set_batch_query();
+void test_rs_interval_continuous_flat_set_measure();
+void test_rs_interval_continuous_flat_set_measure_cancellation();
+void test_rs_interval_continuous_frozen_set_construction();
+void test_rs_interval_continuous_frozen_set_membership();
 void test_rs_interval_continuous_map();
+void test_rs_interval_continuous_segment_tree();
 void test_rs_interval_continuous_set_construct_insert_erase();
 void test_rs_interval_continuous_set_formatting();
 void test_rs_interval_continuous_set_operations();
+void test_rs_interval_continuous_set_bulk_construction();
+void test_rs_interval_continuous_set_bulk_construction_large();
+void test_rs_interval_continuous_set_measure();
+void test_rs_interval_continuous_set_common_gap();
+void test_rs_interval_continuous_set_measure_cancellation();
+void test_rs_interval_integral_allocator_basics();
+void test_rs_interval_integral_allocator_random();
 void test_rs_interval_integral_contains_zero();
 void test_rs_interval_integral_interval_arithmetic();
 void test_rs_interval_integral_interval_basic_properties();
@@ -52,10 +67,67 @@ void test_rs_interval_integral_boundary_to_interval();
 void test_rs_interval_integral_boundary_adjacency();
 void test_rs_interval_integral_boundary_comparison();
 void test_rs_interval_integral_boundary_multiplication();
+void test_rs_interval_integral_concurrent_map_basics();
+void test_rs_interval_integral_concurrent_map_threads();
+void test_rs_interval_integral_counter_basics();
+void test_rs_interval_integral_counter_random();
+void test_rs_interval_integral_flat_map_construct_insert_erase();
+void test_rs_interval_integral_flat_map_conversion();
+void test_rs_interval_integral_flat_map_bulk_construction();
+void test_rs_interval_integral_flat_map_random_updates();
+void test_rs_interval_integral_flat_map_move_insert();
+void test_rs_interval_integral_flat_map_nth_rank();
+void test_rs_interval_integral_flat_set_construct_insert_erase();
+void test_rs_interval_integral_flat_set_conversion();
+void test_rs_interval_integral_flat_set_bulk_construction();
+void test_rs_interval_integral_flat_set_operations();
+void test_rs_interval_integral_flat_set_batch_query();
+void test_rs_interval_integral_flat_set_overlapping();
+void test_rs_interval_integral_flat_set_nth_rank();
+void test_rs_interval_integral_flat_set_cardinality();
+void test_rs_interval_integral_flat_set_parallel_operations();
+void test_rs_interval_integral_frozen_map_construction();
+void test_rs_interval_integral_frozen_map_lookup();
+void test_rs_interval_integral_frozen_set_construction();
+void test_rs_interval_integral_frozen_set_membership();
+void test_rs_interval_integral_frozen_set_kernels();
 void test_rs_interval_integral_map();
+void test_rs_interval_integral_map_bulk_construction();
+void test_rs_interval_integral_map_move_insert();
+void test_rs_interval_integral_map_random_updates();
+void test_rs_interval_integral_map_combine();
+void test_rs_interval_integral_map_combine_random();
+void test_rs_interval_integral_map_overlapping();
+void test_rs_interval_integral_map_nth_rank();
+void test_rs_interval_integral_multi_map_basics();
+void test_rs_interval_integral_multi_map_random();
+void test_rs_interval_integral_multi_map_large();
+void test_rs_interval_integral_persistent_map_basics();
+void test_rs_interval_integral_persistent_map_versions();
+void test_rs_interval_integral_persistent_map_random();
+void test_rs_interval_integral_persistent_set_basics();
+void test_rs_interval_integral_persistent_set_versions();
+void test_rs_interval_integral_persistent_set_random();
+void test_rs_interval_integral_segment_tree_basics();
+void test_rs_interval_integral_segment_tree_from_map();
+void test_rs_interval_integral_segment_tree_random_updates();
+void test_rs_interval_integral_segment_tree_coalescing();
+void test_rs_interval_integral_segment_tree_unsigned_keys();
 void test_rs_interval_integral_set_construct_insert_erase();
 void test_rs_interval_integral_set_formatting();
 void test_rs_interval_integral_set_operations();
+void test_rs_interval_integral_set_bulk_construction();
+void test_rs_interval_integral_set_bulk_construction_large();
+void test_rs_interval_integral_set_batch_query();
+void test_rs_interval_integral_set_overlapping();
+void test_rs_interval_integral_set_nth_rank();
+void test_rs_interval_integral_set_cardinality();
+void test_rs_interval_integral_set_common_gap();
+void test_rs_interval_integral_set_parallel_operations();
+void test_rs_interval_integral_sharded_set_basics();
+void test_rs_interval_integral_sharded_set_random();
+void test_rs_interval_integral_sharded_set_threads();
+void test_rs_interval_integral_sharded_set_iterate_while_writing();
 void test_rs_interval_ordered_interval_basic_properties();
 void test_rs_interval_ordered_interval_construction();
 void test_rs_interval_ordered_interval_to_string();
@@ -69,6 +141,7 @@ void test_rs_interval_ordered_boundary_from_interval();
 void test_rs_interval_ordered_boundary_adjacency();
 void test_rs_interval_ordered_boundary_comparison();
 void test_rs_interval_ordered_map();
+void test_rs_interval_ordered_map_concurrent();
 void test_rs_interval_ordered_set_construct_insert_erase();
 void test_rs_interval_ordered_set_formatting();
 void test_rs_interval_ordered_set_operations();
@@ -121,10 +194,25 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_interval_continuous_boundary_adjacency, "test_rs_interval_continuous_boundary_adjacency");
     call_me_maybe(test_rs_interval_continuous_boundary_comparison, "test_rs_interval_continuous_boundary_comparison");
     call_me_maybe(test_rs_interval_continuous_boundary_multiplication, "test_rs_interval_continuous_boundary_multiplication");
+    call_me_maybe(test_rs_interval_continuous_flat_set_construct_insert_erase, "test_rs_interval_continuous_flat_set_construct_insert_erase");
+    call_me_maybe(test_rs_interval_continuous_flat_set_operations, "test_rs_interval_continuous_flat_set_operations");
+    call_me_maybe(test_rs_interval_continuous_flat_set_batch_query, "test_rs_interval_continuous_flat_set_batch_query");
+    call_me_maybe(test_rs_interval_continuous_flat_set_measure, "test_rs_interval_continuous_flat_set_measure");
+    call_me_maybe(test_rs_interval_continuous_flat_set_measure_cancellation, "test_rs_interval_continuous_flat_set_measure_cancellation");
+    call_me_maybe(test_rs_interval_continuous_frozen_set_construction, "test_rs_interval_continuous_frozen_set_construction");
+    call_me_maybe(test_rs_interval_continuous_frozen_set_membership, "test_rs_interval_continuous_frozen_set_membership");
     call_me_maybe(test_rs_interval_continuous_map, "test_rs_interval_continuous_map");
+    call_me_maybe(test_rs_interval_continuous_segment_tree, "test_rs_interval_continuous_segment_tree");
     call_me_maybe(test_rs_interval_continuous_set_construct_insert_erase, "test_rs_interval_continuous_set_construct_insert_erase");
     call_me_maybe(test_rs_interval_continuous_set_formatting, "test_rs_interval_continuous_set_formatting");
     call_me_maybe(test_rs_interval_continuous_set_operations, "test_rs_interval_continuous_set_operations");
+    call_me_maybe(test_rs_interval_continuous_set_bulk_construction, "test_rs_interval_continuous_set_bulk_construction");
+    call_me_maybe(test_rs_interval_continuous_set_bulk_construction_large, "test_rs_interval_continuous_set_bulk_construction_large");
+    call_me_maybe(test_rs_interval_continuous_set_measure, "test_rs_interval_continuous_set_measure");
+    call_me_maybe(test_rs_interval_continuous_set_common_gap, "test_rs_interval_continuous_set_common_gap");
+    call_me_maybe(test_rs_interval_continuous_set_measure_cancellation, "test_rs_interval_continuous_set_measure_cancellation");
+    call_me_maybe(test_rs_interval_integral_allocator_basics, "test_rs_interval_integral_allocator_basics");
+    call_me_maybe(test_rs_interval_integral_allocator_random, "test_rs_interval_integral_allocator_random");
     call_me_maybe(test_rs_interval_integral_contains_zero, "test_rs_interval_integral_contains_zero");
     call_me_maybe(test_rs_interval_integral_interval_arithmetic, "test_rs_interval_integral_interval_arithmetic");
     call_me_maybe(test_rs_interval_integral_interval_basic_properties, "test_rs_interval_integral_interval_basic_properties");
@@ -145,10 +233,67 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_interval_integral_boundary_adjacency, "test_rs_interval_integral_boundary_adjacency");
     call_me_maybe(test_rs_interval_integral_boundary_comparison, "test_rs_interval_integral_boundary_comparison");
     call_me_maybe(test_rs_interval_integral_boundary_multiplication, "test_rs_interval_integral_boundary_multiplication");
+    call_me_maybe(test_rs_interval_integral_concurrent_map_basics, "test_rs_interval_integral_concurrent_map_basics");
+    call_me_maybe(test_rs_interval_integral_concurrent_map_threads, "test_rs_interval_integral_concurrent_map_threads");
+    call_me_maybe(test_rs_interval_integral_counter_basics, "test_rs_interval_integral_counter_basics");
+    call_me_maybe(test_rs_interval_integral_counter_random, "test_rs_interval_integral_counter_random");
+    call_me_maybe(test_rs_interval_integral_flat_map_construct_insert_erase, "test_rs_interval_integral_flat_map_construct_insert_erase");
+    call_me_maybe(test_rs_interval_integral_flat_map_conversion, "test_rs_interval_integral_flat_map_conversion");
+    call_me_maybe(test_rs_interval_integral_flat_map_bulk_construction, "test_rs_interval_integral_flat_map_bulk_construction");
+    call_me_maybe(test_rs_interval_integral_flat_map_random_updates, "test_rs_interval_integral_flat_map_random_updates");
+    call_me_maybe(test_rs_interval_integral_flat_map_move_insert, "test_rs_interval_integral_flat_map_move_insert");
+    call_me_maybe(test_rs_interval_integral_flat_map_nth_rank, "test_rs_interval_integral_flat_map_nth_rank");
+    call_me_maybe(test_rs_interval_integral_flat_set_construct_insert_erase, "test_rs_interval_integral_flat_set_construct_insert_erase");
+    call_me_maybe(test_rs_interval_integral_flat_set_conversion, "test_rs_interval_integral_flat_set_conversion");
+    call_me_maybe(test_rs_interval_integral_flat_set_bulk_construction, "test_rs_interval_integral_flat_set_bulk_construction");
+    call_me_maybe(test_rs_interval_integral_flat_set_operations, "test_rs_interval_integral_flat_set_operations");
+    call_me_maybe(test_rs_interval_integral_flat_set_batch_query, "test_rs_interval_integral_flat_set_batch_query");
+    call_me_maybe(test_rs_interval_integral_flat_set_overlapping, "test_rs_interval_integral_flat_set_overlapping");
+    call_me_maybe(test_rs_interval_integral_flat_set_nth_rank, "test_rs_interval_integral_flat_set_nth_rank");
+    call_me_maybe(test_rs_interval_integral_flat_set_cardinality, "test_rs_interval_integral_flat_set_cardinality");
+    call_me_maybe(test_rs_interval_integral_flat_set_parallel_operations, "test_rs_interval_integral_flat_set_parallel_operations");
+    call_me_maybe(test_rs_interval_integral_frozen_map_construction, "test_rs_interval_integral_frozen_map_construction");
+    call_me_maybe(test_rs_interval_integral_frozen_map_lookup, "test_rs_interval_integral_frozen_map_lookup");
+    call_me_maybe(test_rs_interval_integral_frozen_set_construction, "test_rs_interval_integral_frozen_set_construction");
+    call_me_maybe(test_rs_interval_integral_frozen_set_membership, "test_rs_interval_integral_frozen_set_membership");
+    call_me_maybe(test_rs_interval_integral_frozen_set_kernels, "test_rs_interval_integral_frozen_set_kernels");
     call_me_maybe(test_rs_interval_integral_map, "test_rs_interval_integral_map");
+    call_me_maybe(test_rs_interval_integral_map_bulk_construction, "test_rs_interval_integral_map_bulk_construction");
+    call_me_maybe(test_rs_interval_integral_map_move_insert, "test_rs_interval_integral_map_move_insert");
+    call_me_maybe(test_rs_interval_integral_map_random_updates, "test_rs_interval_integral_map_random_updates");
+    call_me_maybe(test_rs_interval_integral_map_combine, "test_rs_interval_integral_map_combine");
+    call_me_maybe(test_rs_interval_integral_map_combine_random, "test_rs_interval_integral_map_combine_random");
+    call_me_maybe(test_rs_interval_integral_map_overlapping, "test_rs_interval_integral_map_overlapping");
+    call_me_maybe(test_rs_interval_integral_map_nth_rank, "test_rs_interval_integral_map_nth_rank");
+    call_me_maybe(test_rs_interval_integral_multi_map_basics, "test_rs_interval_integral_multi_map_basics");
+    call_me_maybe(test_rs_interval_integral_multi_map_random, "test_rs_interval_integral_multi_map_random");
+    call_me_maybe(test_rs_interval_integral_multi_map_large, "test_rs_interval_integral_multi_map_large");
+    call_me_maybe(test_rs_interval_integral_persistent_map_basics, "test_rs_interval_integral_persistent_map_basics");
+    call_me_maybe(test_rs_interval_integral_persistent_map_versions, "test_rs_interval_integral_persistent_map_versions");
+    call_me_maybe(test_rs_interval_integral_persistent_map_random, "test_rs_interval_integral_persistent_map_random");
+    call_me_maybe(test_rs_interval_integral_persistent_set_basics, "test_rs_interval_integral_persistent_set_basics");
+    call_me_maybe(test_rs_interval_integral_persistent_set_versions, "test_rs_interval_integral_persistent_set_versions");
+    call_me_maybe(test_rs_interval_integral_persistent_set_random, "test_rs_interval_integral_persistent_set_random");
+    call_me_maybe(test_rs_interval_integral_segment_tree_basics, "test_rs_interval_integral_segment_tree_basics");
+    call_me_maybe(test_rs_interval_integral_segment_tree_from_map, "test_rs_interval_integral_segment_tree_from_map");
+    call_me_maybe(test_rs_interval_integral_segment_tree_random_updates, "test_rs_interval_integral_segment_tree_random_updates");
+    call_me_maybe(test_rs_interval_integral_segment_tree_coalescing, "test_rs_interval_integral_segment_tree_coalescing");
+    call_me_maybe(test_rs_interval_integral_segment_tree_unsigned_keys, "test_rs_interval_integral_segment_tree_unsigned_keys");
     call_me_maybe(test_rs_interval_integral_set_construct_insert_erase, "test_rs_interval_integral_set_construct_insert_erase");
     call_me_maybe(test_rs_interval_integral_set_formatting, "test_rs_interval_integral_set_formatting");
     call_me_maybe(test_rs_interval_integral_set_operations, "test_rs_interval_integral_set_operations");
+    call_me_maybe(test_rs_interval_integral_set_bulk_construction, "test_rs_interval_integral_set_bulk_construction");
+    call_me_maybe(test_rs_interval_integral_set_bulk_construction_large, "test_rs_interval_integral_set_bulk_construction_large");
+    call_me_maybe(test_rs_interval_integral_set_batch_query, "test_rs_interval_integral_set_batch_query");
+    call_me_maybe(test_rs_interval_integral_set_overlapping, "test_rs_interval_integral_set_overlapping");
+    call_me_maybe(test_rs_interval_integral_set_nth_rank, "test_rs_interval_integral_set_nth_rank");
+    call_me_maybe(test_rs_interval_integral_set_cardinality, "test_rs_interval_integral_set_cardinality");
+    call_me_maybe(test_rs_interval_integral_set_common_gap, "test_rs_interval_integral_set_common_gap");
+    call_me_maybe(test_rs_interval_integral_set_parallel_operations, "test_rs_interval_integral_set_parallel_operations");
+    call_me_maybe(test_rs_interval_integral_sharded_set_basics, "test_rs_interval_integral_sharded_set_basics");
+    call_me_maybe(test_rs_interval_integral_sharded_set_random, "test_rs_interval_integral_sharded_set_random");
+    call_me_maybe(test_rs_interval_integral_sharded_set_threads, "test_rs_interval_integral_sharded_set_threads");
+    call_me_maybe(test_rs_interval_integral_sharded_set_iterate_while_writing, "test_rs_interval_integral_sharded_set_iterate_while_writing");
     call_me_maybe(test_rs_interval_ordered_interval_basic_properties, "test_rs_interval_ordered_interval_basic_properties");
     call_me_maybe(test_rs_interval_ordered_interval_construction, "test_rs_interval_ordered_interval_construction");
     call_me_maybe(test_rs_interval_ordered_interval_to_string, "test_rs_interval_ordered_interval_to_string");
@@ -162,6 +307,7 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_interval_ordered_boundary_adjacency, "test_rs_interval_ordered_boundary_adjacency");
     call_me_maybe(test_rs_interval_ordered_boundary_comparison, "test_rs_interval_ordered_boundary_comparison");
     call_me_maybe(test_rs_interval_ordered_map, "test_rs_interval_ordered_map");
+    call_me_maybe(test_rs_interval_ordered_map_concurrent, "test_rs_interval_ordered_map_concurrent");
     call_me_maybe(test_rs_interval_ordered_set_construct_insert_erase, "test_rs_interval_ordered_set_construct_insert_erase");
     call_me_maybe(test_rs_interval_ordered_set_formatting, "test_rs_interval_ordered_set_formatting");
     call_me_maybe(test_rs_interval_ordered_set_operations, "test_rs_interval_ordered_set_operations");